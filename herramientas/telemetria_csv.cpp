@@ -0,0 +1,125 @@
+// Decodificador de la telemetría binaria del robot a CSV (Linux).
+//
+//   g++ -O2 -Iinclude herramientas/telemetria_csv.cpp -o telemetria_csv
+//   ./telemetria_csv /dev/ttyACM0 --baudios 115200 > vuelta.csv
+//   .pio/build/native/program --verbose | ./telemetria_csv > sim.csv
+//
+// Busca el sincronismo, valida la versión y el CRC, y descarta lo demás
+// (el texto de los eventos va intercalado entre tramas). Al terminar
+// imprime por stderr tramas válidas, errores de CRC y huecos de secuencia.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "trama_telemetria.h"
+
+static speed_t velocidadTermios(long baudios) {
+  switch (baudios) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 500000: return B500000;
+    case 1000000: return B1000000;
+    default: return 0;
+  }
+}
+
+// Puerto serie en modo crudo; en un fichero o una tubería no hace nada
+static bool configurarPuerto(int fd, long baudios) {
+  struct termios t;
+  if (tcgetattr(fd, &t) != 0) return true;
+  speed_t v = velocidadTermios(baudios);
+  if (v == 0) {
+    fprintf(stderr, "baudios no soportados: %ld\n", baudios);
+    return false;
+  }
+  cfmakeraw(&t);
+  cfsetispeed(&t, v);
+  cfsetospeed(&t, v);
+  t.c_cc[VMIN] = 1;
+  t.c_cc[VTIME] = 0;
+  return tcsetattr(fd, TCSANOW, &t) == 0;
+}
+
+static void imprimirFila(const TramaTelemetria &t) {
+  printf("%u,%u,%d,%u,%u,%d,%d,%d,%d,%.2f,%u,%u,%u,%u,%u,%u\n",
+         t.tiempoMs, t.secuencia, t.distanciaCm, t.pwmIzq, t.pwmDer,
+         t.velIzqMmS, t.velDerMmS, t.xCm, t.yCm, t.rumboCentigrados / 100.0,
+         t.estado, t.contadorAtasco, t.escaneos, t.recuperaciones, t.descartadas,
+         t.bateriaMv);
+}
+
+int main(int argc, char **argv) {
+  const char *ruta = nullptr;
+  long baudios = 115200;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--baudios") == 0 && i + 1 < argc) {
+      baudios = atol(argv[++i]);
+    } else if (argv[i][0] != '-' && !ruta) {
+      ruta = argv[i];
+    } else {
+      fprintf(stderr, "uso: telemetria_csv [DISPOSITIVO|FICHERO] [--baudios N]\n");
+      return 2;
+    }
+  }
+
+  int fd = ruta ? open(ruta, O_RDONLY | O_NOCTTY) : STDIN_FILENO;
+  if (fd < 0) {
+    perror(ruta);
+    return 1;
+  }
+  if (!configurarPuerto(fd, baudios)) return 1;
+
+  printf("tiempo_ms,secuencia,distancia_cm,pwm_izq,pwm_der,vel_izq_mm_s,vel_der_mm_s,"
+         "x_cm,y_cm,rumbo_grados,estado,atasco,escaneos,recuperaciones,descartadas,bateria_mv\n");
+
+  uint8_t buf[sizeof(TramaTelemetria)];
+  size_t n = 0;
+  unsigned long validas = 0, errores = 0, huecos = 0;
+  int anterior = -1;
+  uint8_t byte;
+
+  while (read(fd, &byte, 1) == 1) {
+    // Sincronismo byte a byte; al fallar se reintenta desde el siguiente
+    if ((n == 0 && byte != TRAMA_SINC_0) || (n == 1 && byte != TRAMA_SINC_1)) {
+      n = byte == TRAMA_SINC_0 ? 1 : 0;
+      if (n) buf[0] = byte;
+      continue;
+    }
+    buf[n++] = byte;
+    if (n < sizeof(buf)) continue;
+    n = 0;
+
+    TramaTelemetria t;
+    memcpy(&t, buf, sizeof(t));
+    if (t.version != TRAMA_VERSION ||
+        t.crc != crc16Ccitt(buf, offsetof(TramaTelemetria, crc))) {
+      errores++;
+      // La trama mala puede contener el inicio de la buena
+      for (size_t i = 1; i < sizeof(buf) - 1; i++) {
+        if (buf[i] == TRAMA_SINC_0 && buf[i + 1] == TRAMA_SINC_1) {
+          n = sizeof(buf) - i;
+          memmove(buf, buf + i, n);
+          break;
+        }
+      }
+      continue;
+    }
+
+    if (anterior >= 0 && t.secuencia != (uint8_t)(anterior + 1)) huecos++;
+    anterior = t.secuencia;
+    validas++;
+    imprimirFila(t);
+  }
+
+  fprintf(stderr, "%lu tramas válidas, %lu con CRC o versión errónea, %lu huecos de secuencia\n",
+          validas, errores, huecos);
+  return 0;
+}
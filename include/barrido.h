@@ -0,0 +1,88 @@
+#ifndef BARRIDO_H
+#define BARRIDO_H
+
+#include <Arduino.h>
+#include "configuracion.h"
+#include "filtro_distancia.h"
+
+// Control del servo del sensor y buffer polar de distancias.
+// Cada lectura del HC-SR04 tomada con el servo ya quieto (según el modelo
+// de servo_sensor.h, que también retiene el disparo hasta entonces) se
+// guarda en un buffer polar (una celda por ángulo con su marca de tiempo), de modo que
+// al encontrar un obstáculo la mejor dirección sale del buffer sin parar
+// a escanear. Cada lectura registrada alimenta también la rejilla de
+// ocupación (rejilla.h); con BARRIDO_LECTURAS_EN_MOVIMIENTO también las
+// tomadas durante los movimientos, con el ángulo estimado del disparo.
+//
+// Modos:
+//   APARCADO - servo al frente, todas las lecturas van al sector de 90°
+//   CONTINUO - barrido lento mientras se avanza; el frente se visita en
+//              uno de cada dos pasos
+//   PARED    - servo fijo a 45° (pared derecha) o 135° (izquierda) para el
+//              seguimiento de pared; cada BARRIDO_PARED_LECTURAS lecturas
+//              laterales echa un vistazo al frente (una lectura a 90°)
+//   ESCANEO  - una pasada por los sectores sin lectura fresca con la mediana
+//              de 3 lecturas por ángulo, en sentido alterno y empezando por
+//              el extremo más cercano; termina antes si un sector no
+//              excluido supera BARRIDO_LIBRE_CLARO_CM con eco. Al terminar
+//              vuelve a APARCADO
+
+#define BARRIDO_SECTORES 5               // 0°, 45°, 90°, 135°, 180°
+#define BARRIDO_PASO_GRADOS 45
+#define BARRIDO_EDAD_MAX_MS 2500         // Datos más viejos obligan a escanear
+#define BARRIDO_DISTANCIA_LIBRE 60       // cm - Por debajo el servo se queda al frente
+#define BARRIDO_LIBRE_CLARO_CM 250       // El escaneo para al encontrar esto
+#define BARRIDO_ESCANEO_LECTURAS 3
+#define BARRIDO_PARED_LECTURAS 3         // Laterales por cada vistazo al frente
+#define BARRIDO_SIN_LIMITE_EDAD 0xFFFFFFFFUL
+
+enum ModoBarrido {
+  BARRIDO_APARCADO,
+  BARRIDO_CONTINUO,
+  BARRIDO_PARED,
+  BARRIDO_ESCANEO
+};
+
+void barridoIniciar();
+
+// Cambia de modo. Pedir ESCANEO arranca una pasada nueva; mientras dura,
+// las peticiones de APARCADO/CONTINUO se ignoran. excluir (si no es -1)
+// es un sector que no puede terminar la pasada antes de tiempo.
+void barridoModo(ModoBarrido modo, int excluir = -1);
+bool barridoEscaneando();
+
+// Modo PARED mirando al lateral dado (45 o 135)
+void barridoSeguirPared(int angulo);
+
+// Llamar periódicamente: registra lecturas nuevas y mueve el servo
+void barridoActualizar();
+
+// Distancia al frente (cm) filtrada: las lecturas a 90° pasan por un
+// FiltroDistancia que se reinicia con barridoInvalidar()
+long barridoFrontal();
+EstimacionDistancia barridoFrontalEstimacion();
+
+// Sin eco (timeout) el sector queda medido pero sin distancia: no es
+// 400 cm libres para nadie, tampoco para la rejilla
+void barridoRegistrar(int angulo, long distCm, bool eco);
+
+// Ángulo con mayor distancia entre los sectores con eco, o -1 si algún
+// sector falta o supera edadMaxMs, o si ninguno tiene eco (distMax queda
+// entonces a -1).
+// excluir (si no es -1) es un ángulo que no se propone aunque sea el mejor.
+int barridoMejorAngulo(unsigned long edadMaxMs, long *distMax, int excluir = -1);
+
+// Distancia registrada en un sector, o -1 si falta, no tuvo eco o supera
+// edadMaxMs
+long barridoDistancia(int angulo, unsigned long edadMaxMs);
+
+// Tras girar el buffer deja de corresponder al entorno
+void barridoInvalidar();
+
+// Pasadas de escaneo completas realizadas (robot parado esperando al servo)
+uint16_t barridoEscaneos();
+
+// Tiempo total con el robot esperando a escaneos (ms)
+uint32_t barridoDuracionEscaneosMs();
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef BATERIA_H
+#define BATERIA_H
+
+#include <Arduino.h>
+#include "configuracion.h"
+
+// Monitor de la tensión de la batería (divisor en BATERIA_PIN, ver
+// configuracion.h). Una muestra con analogRead() (~110 us) cada
+// BATERIA_PERIODO_MS y dos pasos bajos de primer orden: uno con todas las
+// muestras (~0,4 s, para la telemetría) y otro solo con las tomadas con
+// los motores tirando, que es la tensión que ven (con la caída en la
+// resistencia interna) y la que usa la compensación (motores.h). Con
+// todas las muestras, las paradas la subían y los motores quedaban cortos.
+
+#define BATERIA_PERIODO_MS 100
+#define BATERIA_FILTRO_BITS 2           // alfa = 1/4 por muestra
+#define BATERIA_CARGA_BITS 3            // alfa = 1/8 por muestra en carga
+#define BATERIA_MIN_MV 5000             // Por debajo no hay batería (USB): sin compensar
+#define BATERIA_COMPENSACION_MIN_Q8 192 // x0,75
+#define BATERIA_COMPENSACION_MAX_Q8 384 // x1,5
+
+// Primera muestra sin filtrar, también como tensión en carga
+void bateriaIniciar();
+
+// Llamar cada BATERIA_PERIODO_MS; enCarga si algún motor tira (PWM > 0)
+void bateriaActualizar(bool enCarga);
+
+// Tensión filtrada, 0 si no hay batería
+uint16_t bateriaMilivoltios();
+
+// Filtrada solo con las muestras en carga, 0 si no hay batería
+uint16_t bateriaCargaMilivoltios();
+
+// Factor de PWM en Q8 para que los motores vean referenciaMv:
+// referencia / tensión en carga, acotado. 256 sin referencia o sin batería.
+uint16_t bateriaCompensacionQ8(uint16_t referenciaMv);
+
+// mV en la batería para una lectura del ADC (referencia de 5 V)
+inline uint16_t bateriaAdcAMv(int adc) {
+  return (uint16_t)((uint32_t)adc * 5000UL * BATERIA_DIVISOR_X10 / (1023UL * 10));
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef CALIBRACION_H
+#define CALIBRACION_H
+
+#include <Arduino.h>
+#include "motores.h"
+
+// Calibración automática de la asimetría de los motores (orden "cal" de
+// la consola). Con el robot parado frente a una pared a más de
+// CAL_PISTA_MIN_CM, para cada PWM de la curva (motores.h):
+//   1. lee la distancia a la pared parado
+//   2. avanza en lazo abierto con ese PWM en las dos ruedas y, ya
+//      estabilizado, mide la velocidad de cada rueda con los encoders
+//   3. para, vuelve a leer la pared y retrocede lo avanzado
+// La zona muerta de cada rueda se extrapola de los dos puntos más bajos
+// con movimiento. Las curvas sustituyen a FACTOR_MOTOR_* en el lazo
+// abierto y se guardan en EEPROM (versión y CRC, como parametros.h).
+// Por Serial sale una línea por punto con las dos velocidades, la deriva
+// de rumbo que tendría el lazo abierto y el avance hacia la pared según el
+// eco frente al de la odometría (patinaje o diámetro de rueda mal puesto).
+//
+// Las curvas dependen de la tensión: se guarda la de la batería al
+// empezar y motores.h compensa respecto a ella (bateria.h).
+//
+// Imagen en EEPROM desde CALIBRACION_DIRECCION:
+//   versión (1) | CurvaMotor x 2 | batería mV (2) | CRC-16 (2)
+
+#define CALIBRACION_VERSION 2
+#define CALIBRACION_DIRECCION 64  // Tras la imagen de parametros.h
+
+#define CAL_PISTA_MIN_CM 100      // Pared delante necesaria antes de cada ida
+#define CAL_DISTANCIA_MIN_CM 30   // La ida se corta aquí
+#define CAL_PAUSA_MS 500          // Parado antes de leer la pared
+#define CAL_ASENTAMIENTO_MS 300   // Desde que arranca hasta que se mide
+#define CAL_MEDIDA_MS 400
+
+// Curvas guardadas, si hay; devuelve true si se cargaron
+bool calibracionCargar();
+
+// Empieza la calibración (false si ya está en marcha); atiende antes una
+// parada de emergencia pendiente, que bloquearía la ida
+bool calibracionEmpezar();
+bool calibracionActiva();
+
+// Llamar cada MOTORES_PERIODO_CONTROL_MS, tras motoresControlar(), mientras
+// calibracionActiva(). Devuelve true en la llamada en que termina (con
+// éxito o no): los motores quedan parados y la navegación debe reiniciarse.
+bool calibracionPaso();
+
+#endif
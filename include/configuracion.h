@@ -0,0 +1,177 @@
+#ifndef CONFIGURACION_H
+#define CONFIGURACION_H
+
+// Pines del sensor ultrasonico HC-SR04 (Shield V5)
+#define TRIGGER_PIN 12
+#define ECHO_PIN 13
+#define SERVO_PIN 11
+
+// Telémetros (telemetros.h): {tipo, pin A, pin B, ángulo}. El primero es
+// el HC-SR04 del servo; se pueden añadir sensores fijos en el chasis a
+// 0° (derecha), 45°, 90°, 135° o 180° (izquierda), hasta TELEMETROS_MAX:
+//   TELEMETRO_ULTRASONIDO: pin A = Trigger, pin B = Echo (puerto B o D,
+//                          p. ej. 9 o 10; A0-A5 son de los encoders)
+//   TELEMETRO_IR:          pin A = salida analógica del Sharp (A2-A4)
+// Ejemplo con un ultrasónico a la derecha y un IR a la izquierda:
+//   {TELEMETRO_ULTRASONIDO, TRIGGER_PIN, ECHO_PIN, TELEMETRO_EN_SERVO},
+//   {TELEMETRO_ULTRASONIDO, 3, 9, 0}, {TELEMETRO_IR, A2, 0, 180}
+#ifndef TELEMETROS
+#define TELEMETROS {TELEMETRO_ULTRASONIDO, TRIGGER_PIN, ECHO_PIN, TELEMETRO_EN_SERVO}
+#endif
+// Canales de ultrasonido.h: al menos los HC-SR04 de TELEMETROS. Cada uno
+// ocupa 31 bytes de SRAM entre el driver y la parada de emergencia.
+#ifndef ULTRASONIDO_CANALES
+#define ULTRASONIDO_CANALES 1
+#endif
+
+// Pines L298N conectados al Shield V5
+// Motor Izquierdo
+#define MOTOR_IZQ_IN1 8   // Dirección
+#define MOTOR_IZQ_IN2 2   // Dirección (movido a pin 2)
+#define MOTOR_IZQ_ENA 5   // PWM velocidad (Shield pin 5)
+
+// Motor Derecho
+#define MOTOR_DER_IN3 4   // Dirección (movido a pin 4)
+#define MOTOR_DER_IN4 7   // Dirección
+#define MOTOR_DER_ENB 6   // PWM velocidad (Shield pin 6)
+
+// Encoders ópticos de las ruedas (un canal por rueda).
+// Los pines 2 y 3 del ejemplo original ya no están libres (pin 2 = IN2),
+// así que van en A0/A1: ambos en el puerto C, un solo vector PCINT1.
+#define ENCODER_IZQ_PIN A0
+#define ENCODER_DER_PIN A1
+
+// Tensión de la batería (bateria.h) por un divisor: batería - R1 - pin -
+// R2 - GND, con R1 = 20k y R2 = 10k (hasta 15 V con el ADC a 5 V)
+#define BATERIA_PIN A5
+#ifndef BATERIA_DIVISOR_X10
+#define BATERIA_DIVISOR_X10 30  // (R1 + R2) / R2, por 10
+#endif
+
+// Puerto serie: a 9600 baudios una línea de estado ocupaba ~40 ms de UART
+#ifndef SERIAL_BAUDIOS
+#define SERIAL_BAUDIOS 115200
+#endif
+
+// 1 = tramas binarias con CRC cada 150 ms (herramientas/telemetria_csv.cpp)
+// 0 = la línea de texto "📏 Dist: ..." de siempre
+#ifndef TELEMETRIA_BINARIA
+#define TELEMETRIA_BINARIA 1
+#endif
+
+// 1 = temporizadores por etapa e histogramas de periodo (perfil.h)
+#ifndef PERFILADO
+#define PERFILADO 0
+#endif
+
+// 1 = traza de las entradas de los sensores por Serial para reproducirla
+// en el simulador (traza.h)
+#ifndef TRAZA
+#define TRAZA 0
+#endif
+
+// Valores del afinador (robot_sim --afinar) si se deja aquí su cabecera
+#if __has_include("afinado.h")
+#include "afinado.h"
+#endif
+
+// Constantes (se pueden redefinir con -D desde build_flags para comparar en el simulador).
+// Las de aquí a GIRO_DIAGONAL_GRADOS y los FACTOR_MOTOR_*_Q8 son solo los
+// valores por defecto de parametros.h: se cambian en marcha por consola.
+#ifndef DISTANCIA_CRITICA
+#define DISTANCIA_CRITICA 15   // cm - Detención y maniobra de evasión
+#endif
+#ifndef TTC_MINIMO_MS
+#define TTC_MINIMO_MS 600      // Tiempo hasta DISTANCIA_CRITICA que mantiene el gobernador
+#endif
+#ifndef VELOCIDAD_MINIMA
+#define VELOCIDAD_MINIMA 100   // Velocidad inicial
+#endif
+#ifndef VELOCIDAD_MAXIMA
+#define VELOCIDAD_MAXIMA 160   // Velocidad máxima (espacio abierto)
+#endif
+#ifndef VELOCIDAD_RETROCESO
+#define VELOCIDAD_RETROCESO 160
+#endif
+#ifndef VELOCIDAD_GIRO
+#define VELOCIDAD_GIRO 120     // Velocidad de giro
+#endif
+
+// Duty del freno del L298N al parar (0 = rueda libre, como antes)
+#ifndef FRENO_PWM
+#define FRENO_PWM 160
+#endif
+
+// Eco al frente por debajo del que el ISR frena sin esperar a loop()
+// (emergencia.h); por debajo de DISTANCIA_CRITICA, 0 = desactivada
+#ifndef EMERGENCIA_CM
+#define EMERGENCIA_CM 12
+#endif
+
+// Tensión a la que se ajustaron las VELOCIDAD_*: el PWM se escala por
+// nominal / medida para que los motores vean siempre la misma (0 = sin compensar)
+#ifndef BATERIA_NOMINAL_MV
+#define BATERIA_NOMINAL_MV 9000
+#endif
+
+#ifndef PERIODO_MEDIR_MS
+#define PERIODO_MEDIR_MS 150   // Medición y decisiones de navegación
+#endif
+
+// Detección de atascos (navegacion.cpp)
+#ifndef BLOQUEO_MS
+#define BLOQUEO_MS 2000        // Avanzando sin cambio de distancia: bloqueo físico
+#endif
+#ifndef ATASCO_LECTURAS
+#define ATASCO_LECTURAS 3      // Más lecturas seguidas a menos de 5 cm: sensor tapado
+#endif
+#ifndef ATASCO_VENTANA_MS
+#define ATASCO_VENTANA_MS 10000  // Ventana del atasco por tiempo (pocos cambios en ella)
+#endif
+
+// Velocidad del servo del sensor (servo_sensor.h). SG90: 0,1 s / 60° a
+// 4,8 V sin carga (600 °/s); con margen para el sensor y la caída de 5 V.
+// Mejor de menos: un valor alto da lecturas con el servo aún moviéndose.
+#ifndef SERVO_GRADOS_POR_S
+#define SERVO_GRADOS_POR_S 500
+#endif
+
+// Las lecturas tomadas con el servo en movimiento van a la rejilla con el
+// ángulo estimado (fuera del escaneo); con 0 se tiran y el disparo espera
+#ifndef BARRIDO_LECTURAS_EN_MOVIMIENTO
+#define BARRIDO_LECTURAS_EN_MOVIMIENTO 0
+#endif
+
+// Giro hacia los sectores de 45° y 135° (los de 0° y 180° giran 90°).
+// Los giros se cierran con los encoders, ya no por tiempo.
+#ifndef GIRO_DIAGONAL_GRADOS
+#define GIRO_DIAGONAL_GRADOS 60
+#endif
+
+// Geometría para odometría y control de velocidad
+#ifndef RANURAS_POR_VUELTA
+#define RANURAS_POR_VUELTA 20      // Ranuras del disco encoder
+#endif
+#ifndef DIAMETRO_RUEDA_MM
+#define DIAMETRO_RUEDA_MM 65
+#endif
+#ifndef DISTANCIA_ENTRE_RUEDAS_MM
+#define DISTANCIA_ENTRE_RUEDAS_MM 130
+#endif
+
+// Factores de corrección en lazo abierto (motor izquierdo más rápido);
+// con encoders son solo el punto de partida del lazo de velocidad
+#ifndef FACTOR_MOTOR_IZQ
+#define FACTOR_MOTOR_IZQ 0.90  // Reducido porque es más rápido
+#endif
+#ifndef FACTOR_MOTOR_DER
+#define FACTOR_MOTOR_DER 1.0   // Motor derecho normal
+#endif
+
+// Los mismos factores en Q8 (256 = 1.0). Se calculan al compilar: el
+// firmware no multiplica en coma flotante al mandar los motores.
+#define FACTOR_UNIDAD_Q8 256
+#define FACTOR_MOTOR_IZQ_Q8 ((uint16_t)(FACTOR_MOTOR_IZQ * FACTOR_UNIDAD_Q8 + 0.5))
+#define FACTOR_MOTOR_DER_Q8 ((uint16_t)(FACTOR_MOTOR_DER * FACTOR_UNIDAD_Q8 + 0.5))
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef CONSOLA_H
+#define CONSOLA_H
+
+#include <Arduino.h>
+
+// Consola de parámetros (parametros.h) por Serial, una orden por línea
+// (termina en '\n'; '\r' se ignora):
+//   list               todos, con valor y rango
+//   get NOMBRE         valor actual
+//   set NOMBRE VALOR   cambia el valor en RAM si está en rango y cumple
+//                      las parejas de parametros.h
+//   save               guarda en EEPROM; responde al terminar
+//   cal                calibra los motores frente a una pared (calibracion.h)
+//   perfil [borrar]    tiempos por etapa y periodos (perfil.h), o ponerlos a 0
+//   emerg              paradas de emergencia y peor latencia del eco al puente
+// consolaActualizar() no espera nunca: lee lo que ya haya llegado, escribe
+// una línea de respuesta solo si cabe en el buffer de la UART y, mientras
+// tiene una respuesta pendiente, deja la entrada en el buffer de recepción.
+
+#define CONSOLA_LINEA 40               // Caracteres por orden
+#define CONSOLA_HUECO_RESPUESTA 48     // Libres en la UART para escribir una línea
+
+void consolaIniciar();
+
+// Llamar periódicamente (tarea de 10-20 ms); también avanza el guardado
+void consolaActualizar();
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef EMERGENCIA_H
+#define EMERGENCIA_H
+
+#include <Arduino.h>
+
+// Parada de emergencia que no pasa por loop(). El ISR del eco
+// (ultrasonido.h) llama a emergenciaEco() en el flanco de bajada, antes de
+// publicar la medición: si el robot avanza (motores.h la arma con las dos
+// ruedas hacia delante), el disparo era de un sensor que mira al frente y
+// el eco queda por debajo de emergencia_cm, frena las dos ruedas a fondo
+// desde el propio ISR y bloquea el avance en el puente (puente_l298n.h).
+// El fallo queda pendiente hasta que la navegación lo atiende con
+// emergenciaAtender(), ya con otra orden dada.
+//
+// Los disparos siguen saliendo de loop() (tarea del eco, cada 5 ms): un
+// loop() atascado retrasa el disparo siguiente, no el freno por el eco que
+// ya está en vuelo. La latencia que se mide va del flanco de bajada del eco
+// a la orden de freno escrita en el puente.
+
+// Cota de esa latencia. En el UNO son unos pocos us (entrada al ISR y unas
+// escrituras de registro); el simulador entrega cada flanco en su instante,
+// así que un flanco retrasado hasta el final del paso de física (1 ms) la
+// pasa
+#define EMERGENCIA_LATENCIA_MAX_US 100UL
+
+// Inicia sin fallo ni latencias; conserva los sensores vigilados
+void emergenciaIniciar();
+
+// Desde motores.h en cada orden: true avanzando, false en cualquier otra
+void emergenciaArmar(bool avanzando);
+
+// El canal de ultrasonido.h mira al frente para los disparos desde desdeMs
+// (millis(); el servo, cuando se asiente a 90°)
+void emergenciaVigilar(uint8_t canal, bool frente, unsigned long desdeMs);
+
+// Cuerpo del ISR: un eco cerrado del canal, con el millis() de su disparo
+// y el micros() de su flanco de bajada
+void emergenciaEco(uint8_t canal, unsigned long anchoUs, unsigned long disparoMs,
+                   unsigned long flancoUs);
+
+// Frenada sin atender (el puente no acepta avanzar)
+bool emergenciaPendiente();
+
+// Quita el fallo y desbloquea el avance
+void emergenciaAtender();
+
+// Eco (cm) y latencia (us) de la última parada, peor latencia y paradas
+// desde el arranque
+uint16_t emergenciaDistanciaCm();
+unsigned long emergenciaLatenciaUs();
+unsigned long emergenciaLatenciaMaxUs();
+uint16_t emergenciaParadas();
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef ENCODERS_H
+#define ENCODERS_H
+
+#include <Arduino.h>
+#include "configuracion.h"
+
+// Encoders de rueda por interrupción de cambio de pin.
+// El ISR solo cuenta flancos de subida y guarda el periodo entre los dos
+// últimos (enteros, sin floats); la velocidad se calcula fuera del ISR.
+
+#define ENCODER_IZQ 0
+#define ENCODER_DER 1
+
+// Avance por pulso en micrómetros (pi * diámetro / ranuras)
+#define ENCODER_UM_POR_PULSO ((uint32_t)(3141.59f * DIAMETRO_RUEDA_MM / RANURAS_POR_VUELTA))
+
+// Sin pulsos durante este tiempo la rueda se considera parada
+#define ENCODER_PARADO_US 150000UL
+
+void encodersIniciar();
+
+// Pulsos acumulados (sin signo: el encoder de un canal no ve el sentido)
+uint32_t encoderPulsos(uint8_t rueda);
+
+// Velocidad en mm/s a partir del último periodo (o del tiempo desde el
+// último pulso si es mayor, para ver enseguida una rueda que frena)
+int16_t encoderVelocidadMmS(uint8_t rueda);
+
+// Avance en micrómetros: pulsos enteros más la fracción del siguiente,
+// interpolada con el último periodo (sin llegar nunca al pulso siguiente)
+uint32_t encoderAvanceUm(uint8_t rueda);
+
+// Cuerpo del ISR: flanco de subida de una rueda con su marca de tiempo
+void encoderPulso(uint8_t rueda, unsigned long us);
+
+#endif
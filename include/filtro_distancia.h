@@ -0,0 +1,51 @@
+#ifndef FILTRO_DISTANCIA_H
+#define FILTRO_DISTANCIA_H
+
+#include <Arduino.h>
+
+// Filtro de distancia por sensor, memoria fija por muestra:
+//  1. Sin eco (timeout) es "sin eco", no 400 cm: no entra en el filtro.
+//  2. Mediana móvil de las 3 últimas lecturas con eco (quita picos sueltos).
+//  3. Kalman de velocidad constante: rango y velocidad de acercamiento,
+//     en coma fija (enteros de 32 bits, como el PI de motores.cpp).
+// Si el eco se pierde con un objetivo cerca (obstáculo blando u oblicuo)
+// la estimación sigue acercándose por predicción, así que el robot frena
+// igual. Lejos, o pasado FILTRO_SIN_ECO_MAX_MS, se suelta el objetivo y
+// se publica FILTRO_SIN_ECO_CM.
+
+#define FILTRO_SIN_ECO_CM 400             // Sin objetivo seguido
+#define FILTRO_SALTO_CM 40                // Innovación mayor = objetivo nuevo
+#define FILTRO_ALCANCE_SEGUIMIENTO_CM 150 // Más lejos, perder el eco = libre
+#define FILTRO_SIN_ECO_MAX_MS 1000        // Predicción a ciegas como máximo
+
+struct EstimacionDistancia {
+  long distanciaCm;    // Rango estimado ahora (FILTRO_SIN_ECO_CM sin objetivo)
+  int velocidadCmS;    // Derivada del rango: negativa = acercándose
+  bool eco;            // La última lectura tuvo eco
+  bool siguiendo;      // Hay objetivo (medido o predicho)
+  uint8_t sinEco;      // Lecturas seguidas sin eco
+};
+
+struct FiltroDistancia {
+  int16_t ventana[3];      // Últimas lecturas con eco (cm)
+  uint8_t llenas;
+  uint8_t indice;
+  int32_t rangoQ8;         // Estado del Kalman (cm, cm/s) en Q8
+  int32_t velocidadQ8;
+  int32_t p00Q4, p01Q4, p11Q4;  // Covarianza (cm², cm²/s, cm²/s²) en Q4
+  unsigned long ultimoMs;  // Instante del estado
+  unsigned long ultimoEcoMs;
+  bool siguiendo;
+  bool eco;
+  uint8_t sinEco;
+};
+
+void filtroDistanciaIniciar(FiltroDistancia &f);
+
+// Nueva lectura: ancho del eco (0 = sin eco) y millis() del disparo
+void filtroDistanciaMedida(FiltroDistancia &f, unsigned long anchoUs, unsigned long tiempoMs);
+
+// Estimación proyectada a ahoraMs
+EstimacionDistancia filtroDistanciaEstimar(const FiltroDistancia &f, unsigned long ahoraMs);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef FRENADA_H
+#define FRENADA_H
+
+#include <Arduino.h>
+
+// Distancia de frenada frente a velocidad, medida en marcha. Cada vez que
+// motores.h para las ruedas (avance, retroceso o final de un giro) se
+// anota su velocidad media y lo que recorren hasta parar (encoders); si
+// llega otra orden antes, vale si ya iban por debajo de
+// MOTORES_PARADA_MM_S. La tabla tiene un punto cada FRENADA_PASO_MM_S con
+// la media móvil de las medidas cercanas, escaladas a su velocidad; los
+// puntos sin medidas toman el tiempo de frenada (distancia / velocidad)
+// del punto medido más cercano. Sin ninguna medida vale velocidad * tau,
+// entre FRENADA_TAU_FRENO_MS (freno_pwm a 255) y FRENADA_TAU_LIBRE_MS (a 0).
+//
+// El gobernador la invierte: la mayor velocidad que, tras la latencia de
+// medida a velocidad constante, para dentro del hueco al obstáculo.
+
+#define FRENADA_PUNTOS 6
+#define FRENADA_PASO_MM_S 100       // Puntos a 100, 200, ..., 600 mm/s
+#define FRENADA_VEL_MIN_MM_S 80     // Más despacio no se anota
+#define FRENADA_TAU_FRENO_MS 80     // Constante mecánica del motor en corto
+#define FRENADA_TAU_LIBRE_MS 250    // Solo el rozamiento
+#define FRENADA_PESO 4              // Media móvil: 1/4 para cada medida nueva
+#define FRENADA_QUIETO_MS 400       // Sin pulsos: la frenada ha terminado
+
+void frenadaIniciar();
+
+// Avisos de motores.h: el robot empieza a frenar o recibe otra orden
+void frenadaEmpezar();
+void frenadaTerminar();
+
+// Cierra la medida cuando las ruedas paran (con motoresControlar())
+void frenadaActualizar();
+
+// Distancia de frenada prevista a esa velocidad
+int16_t frenadaDistanciaMm(int16_t velocidadMmS);
+
+// Mayor velocidad con v * latenciaMs + frenada(v) <= huecoMm
+int16_t frenadaVelocidadMaxMmS(int32_t huecoMm, uint16_t latenciaMs);
+
+// Frenadas anotadas desde el arranque
+uint16_t frenadaMedidas();
+
+#endif
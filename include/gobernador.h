@@ -0,0 +1,37 @@
+#ifndef GOBERNADOR_H
+#define GOBERNADOR_H
+
+#include <Arduino.h>
+#include "filtro_distancia.h"
+
+// Velocidad de avance continua según el tiempo hasta el choque.
+// Con la estimación filtrada al frente y el hueco g = distancia -
+// DISTANCIA_CRITICA, la velocidad segura es la menor de:
+//   - la que para dentro del hueco: v * latencia de medida + distancia de
+//     frenada(v) <= g, con la frenada medida en marcha (frenada.h)
+//   - la que mantiene g / velocidad de cierre >= TTC_MINIMO_MS (si el
+//     obstáculo también se acerca, su parte se descuenta)
+// acotada a [VELOCIDAD_MINIMA, VELOCIDAD_MAXIMA]: el mínimo evita una
+// aproximación asintótica que nunca llega a DISTANCIA_CRITICA. La velocidad
+// pedida sigue a ese límite con rampas de aceleración y de frenado.
+// Con TTC_MINIMO_MS 600 manda siempre el TTC: la frenada aprendida solo
+// limita por debajo de unos 300 ms, y bajar el TTC para acercarse más
+// choca más en el banco (README, "Freno y frenada").
+
+#define GOBERNADOR_LATENCIA_MS 200     // Periodo de medición + filtro
+#define GOBERNADOR_ACEL_PWM_S 400
+#define GOBERNADOR_DECEL_PWM_S 2000
+
+// Reinicia la rampa en VELOCIDAD_MINIMA (al empezar a avanzar)
+void gobernadorIniciar();
+
+// Velocidad segura ahora (escala PWM), sin rampa
+int gobernadorLimite(const EstimacionDistancia &frente);
+
+// Siguiente velocidad pedida con rampas (llamar en cada paso de avance)
+int gobernadorPaso(const EstimacionDistancia &frente);
+
+// Velocidad de cierre usada (cm/s, positiva = acercándose)
+int gobernadorCierreCmS(const EstimacionDistancia &frente);
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef MOTORES_H
+#define MOTORES_H
+
+#include <Arduino.h>
+
+// Control del L298N (ver pines en configuracion.h).
+// Cada orden fija sentido y velocidad pedida por rueda; con los encoders,
+// motoresControlar() cierra un lazo PI de velocidad en punto fijo que
+// corrige el PWM de lazo abierto para que las dos ruedas vayan a la misma
+// velocidad real aunque baje la batería. El PWM de lazo abierto sale de la
+// curva medida de cada rueda (calibracion.h) o, sin ella, de velocidad *
+// FACTOR_MOTOR_*, y se escala por la tensión medida (bateria.h) para que
+// el PI parta siempre de cerca.
+// Parar es frenar: detener() pone el L298N en freno (freno_pwm; 0 = rueda
+// libre) y un cambio de sentido con la rueda girando frena primero y
+// arranca con rampa. Cada frenada se mide para el modelo de frenada.h.
+// Avanzando queda armada la parada de emergencia del ISR (emergencia.h).
+
+#define MOTOR_IZQ 0
+#define MOTOR_DER 1
+
+// Velocidad pedida (mm/s) por unidad de la escala PWM que usa la
+// navegación, en Q8: 160 -> 320 mm/s
+#define MM_S_POR_PWM_Q8 512
+
+// Curva PWM -> velocidad de una rueda: velocidadMmS[i] es la medida con
+// PWM CURVA_PWM_MIN + i * CURVA_PWM_PASO; por debajo de zonaMuerta la
+// rueda no arranca. 13 bytes por rueda.
+#define CURVA_PUNTOS 6
+#define CURVA_PWM_MIN 80
+#define CURVA_PWM_PASO 35   // 80, 115, ..., 255
+
+struct CurvaMotor {
+  uint8_t zonaMuerta;
+  int16_t velocidadMmS[CURVA_PUNTOS];
+};
+
+void motoresIniciar();
+
+// Usa estas curvas (una por rueda) para el lazo abierto; nullptr vuelve a
+// los factores. referenciaMv es la batería con la que se midieron (0 =
+// BATERIA_NOMINAL_MV).
+void motoresFijarCurvas(const CurvaMotor *curvas, uint16_t referenciaMv);
+const CurvaMotor *motoresCurvas();
+
+// PWM de lazo abierto que da mmS (>= 0) según la curva
+int16_t motoresPwmCurva(const CurvaMotor &curva, int16_t mmS);
+
+// PWM fijo por rueda sin lazo PI (signo = sentido), para calibrar
+void motoresLazoAbierto(int pwmIzq, int pwmDer);
+void avanzarConVelocidad(int velocidad);
+
+// Avance en curva: la rueda izquierda va a velocidad - diferencia y la
+// derecha a velocidad + diferencia (positiva = hacia la izquierda)
+void avanzarCurvando(int velocidad, int diferencia);
+void retroceder();
+void girarDerecha();
+void girarIzquierda();
+void detener();
+
+// Las dos ruedas por debajo de MOTORES_PARADA_MM_S: se puede invertir sin
+// frenar más
+#define MOTORES_PARADA_MM_S 100
+bool motoresParados();
+
+// Alguna rueda frena para cambiar de sentido (la orden aún no se aplica)
+bool motoresInvirtiendo();
+
+// Giro sobre el eje por ángulo (positivo = izquierda, negativo = derecha).
+// No bloquea: motoresControlar() sigue el arco con los encoders y frena
+// con una rampa; motoresGirando() pasa a false al terminar. Cualquier
+// otra orden cancela el giro.
+void girarGrados(int grados);
+bool motoresGirando();
+
+// Lazo de velocidad (llamar cada MOTORES_PERIODO_CONTROL_MS)
+#define MOTORES_PERIODO_CONTROL_MS 20
+void motoresControlar();
+
+// Sentido en que gira cada rueda: +1 adelante, -1 atrás. Tras detener() o
+// durante un cambio de sentido es el anterior (la rueda aún gira).
+int8_t motoresSentido(uint8_t motor);
+
+// Velocidad pedida en mm/s (con signo) y PWM aplicado
+int16_t motoresObjetivoMmS(uint8_t motor);
+int16_t motoresPwm(uint8_t motor);
+
+#endif
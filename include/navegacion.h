@@ -0,0 +1,62 @@
+#ifndef NAVEGACION_H
+#define NAVEGACION_H
+
+#include <Arduino.h>
+#include "filtro_distancia.h"
+
+// Máquina de estados de navegación.
+// Una sola secuencia de evasión (retroceso -> escaneo -> giro) compartida
+// por el obstáculo normal y por las tres detecciones de atasco; la
+// duración del retroceso y, si hay bucle, un giro sin escaneo los decide
+// recuperacion.h según los eventos recientes en el mismo sitio. Ningún
+// estado bloquea: cada uno decide su transición según el tiempo
+// transcurrido desde que se entró en él.
+//
+// Seguimiento de pared: avanzando con una pared lateral cerca (lecturas del
+// barrido continuo a 0°/180° y 45°/135°) y el frente despejado, el servo se
+// fija a 45° o 135° y un PD sobre esa distancia mantiene la consigna
+// curvando el avance. Se vuelve al avance libre al perder la pared o con
+// un obstáculo al frente (los vistazos del barrido siguen alimentando el
+// filtro frontal). La estrategia de salida de recuperacion.h termina aquí.
+
+enum EstadoNav {
+  NAV_CRUCERO,       // Camino libre, acelerando hasta VELOCIDAD_MAXIMA
+  NAV_LENTO,         // Obstáculo delante: el gobernador (TTC) limita la velocidad
+  NAV_RETROCESO,     // Parar, retroceder y parar
+  NAV_ESCANEO,       // Elegir dirección (buffer del barrido o escaneo completo)
+  NAV_GIRO,          // Girar según el ángulo elegido
+  NAV_RECUPERACION,  // Entrada común de las detecciones de atasco
+  NAV_PARED,         // Avance siguiendo una pared lateral (PD sobre la distancia)
+  NAV_ESTADOS
+};
+
+enum CausaRecuperacion {
+  REC_BLOQUEO_FISICO,  // Avanza pero la distancia no cambia en 2 s
+  REC_ATASCO,          // Sensor bloqueado (distancia < 5) repetidamente
+  REC_TIEMPO,          // 10 s avanzando casi sin cambios
+  REC_CAUSAS
+};
+
+extern int velocidadActual;
+
+// Arranca en NAV_ESCANEO para orientarse hacia donde hay más espacio
+void navegacionIniciar();
+
+// Nueva estimación al frente (cada 150 ms): detecciones y cambios de estado.
+// Las detecciones de atasco solo cuentan lecturas con eco.
+void navegacionMedicion(const EstimacionDistancia &frente);
+
+// Paso rápido (cada 10 ms): acciones y transiciones temporizadas del
+// estado; atiende antes la parada de emergencia del ISR (emergencia.h)
+void navegacionPaso();
+
+EstadoNav navegacionEstado();
+// Nombre en flash, para Serial.print()
+const __FlashStringHelper *navegacionNombreEstado(EstadoNav estado);
+int navegacionContadorAtasco();
+uint16_t navegacionRecuperaciones(CausaRecuperacion causa);
+
+// Detenciones por obstáculo a DISTANCIA_CRITICA
+uint16_t navegacionParadas();
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef ODOMETRIA_H
+#define ODOMETRIA_H
+
+#include <Arduino.h>
+
+// Estima a ciegas (dead reckoning) con los pulsos de los encoders.
+// El sentido de cada rueda se toma de la orden de motores, porque el
+// encoder de un canal no lo distingue. Origen en la pose de arranque,
+// rumbo 0 = hacia delante, positivo hacia la izquierda.
+
+struct PoseOdometria {
+  float xMm;
+  float yMm;
+  float rumbo;  // Radianes en (-pi, pi]
+};
+
+void odometriaIniciar();
+
+// Integra los pulsos nuevos (llamar junto al lazo de velocidad)
+void odometriaActualizar();
+
+PoseOdometria odometriaPose();
+
+// Distancia recorrida por el centro del eje (valor absoluto)
+float odometriaRecorridoMm();
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef PARAMETROS_H
+#define PARAMETROS_H
+
+#include <Arduino.h>
+
+// Parámetros de ajuste modificables en marcha (consola.h) y guardados en
+// EEPROM. Los #define de configuracion.h son los valores por defecto; el
+// firmware lee siempre parametros[PARAM_*].
+//
+// Imagen en EEPROM desde la dirección 0:
+//   versión (1) | cantidad (1) | valores (int16 x cantidad) | CRC-16 (2)
+// Con otra versión, otra cantidad, CRC incorrecto, algún valor fuera de
+// rango o alguna pareja incumplida se arranca con los valores por defecto.
+//
+// Guardar no bloquea: parametrosActualizar() escribe como mucho un byte
+// que haya cambiado por llamada (~3,3 ms de escritura de la EEPROM del
+// AVR que transcurren entre llamadas).
+
+#define PARAMETROS_VERSION 2   // 2: 17 valores y parejas comprobadas
+#define PARAMETROS_DIRECCION 0
+
+enum IdParametro {
+  PARAM_DISTANCIA_CRITICA,
+  PARAM_TTC_MINIMO_MS,
+  PARAM_VELOCIDAD_MINIMA,
+  PARAM_VELOCIDAD_MAXIMA,
+  PARAM_VELOCIDAD_RETROCESO,
+  PARAM_VELOCIDAD_GIRO,
+  PARAM_GIRO_DIAGONAL_GRADOS,
+  PARAM_FACTOR_MOTOR_IZQ_Q8,
+  PARAM_FACTOR_MOTOR_DER_Q8,
+  PARAM_PERIODO_MEDIR_MS,
+  PARAM_BATERIA_NOMINAL_MV,
+  PARAM_SERVO_GRADOS_S,
+  PARAM_FRENO_PWM,
+  PARAM_BLOQUEO_MS,
+  PARAM_ATASCO_LECTURAS,
+  PARAM_ATASCO_VENTANA_MS,
+  PARAM_EMERGENCIA_CM,
+  PARAMETROS
+};
+
+extern int16_t parametros[PARAMETROS];
+
+// Relaciones entre valores que se cumplen siempre (un menor de 0 las
+// cumple: velocidad mínima 0, parada de emergencia desactivada):
+//   velocidad_minima <= velocidad_maxima
+//   emergencia_cm < distancia_critica (configuracion.h)
+struct ParejaParametros {
+  uint8_t menor;
+  uint8_t mayor;
+  bool estricta;   // menor < mayor; si no, menor <= mayor
+};
+
+#define PARAMETROS_PAREJAS 2
+ParejaParametros parametrosPareja(uint8_t i);
+
+// Primera pareja que se incumpliría con valores[id] = valor, o -1
+int8_t parametrosParejaIncumplida(const int16_t *valores, uint8_t id, int16_t valor);
+
+// Valores por defecto y, si la imagen de EEPROM es válida, los guardados.
+// Devuelve true si se cargaron de la EEPROM.
+bool parametrosIniciar();
+
+// Id por nombre ("velocidad_maxima"), o -1
+int8_t parametroBuscar(const char *nombre);
+
+// Nombre del parámetro (en flash)
+const __FlashStringHelper *parametroNombre(uint8_t id);
+int16_t parametroMinimo(uint8_t id);
+int16_t parametroMaximo(uint8_t id);
+
+// Cambia un valor si está en rango y cumple las parejas con los demás
+// (para subir velocidad_minima por encima de la máxima, antes la máxima)
+bool parametroFijar(uint8_t id, int16_t valor);
+
+// Empieza a guardar los valores actuales; avanza con parametrosActualizar()
+void parametrosGuardar();
+bool parametrosGuardando();
+
+// Llamar periódicamente (cada 10 ms o más): escribe el siguiente byte
+// pendiente. Devuelve true en la llamada en que termina de guardar.
+bool parametrosActualizar();
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <Arduino.h>
+#include "configuracion.h"
+
+// Perfilado de la ruta caliente. Por serie (etapa o periodo de tarea):
+// mínimo, media y máximo, histograma logarítmico y veces que se pasa de
+// su límite, todo en memoria estática. Se vuelca con la orden "perfil"
+// de la consola.
+//
+//   PERFIL_ETAPA(ETAPA_DECISION);    // Mide hasta el final del bloque
+//   PERFIL_PERIODO(SERIE_PERIODO_NAV, 10000);  // Error frente al nominal (us)
+//
+// Con PERFILADO a 0 (por defecto en el UNO: ~390 bytes de RAM) las macros
+// no generan código. Las etapas se miden con micros() (resolución de 4 us
+// en el UNO; el Timer1 es del Servo); en el simulador micros() es el reloj
+// virtual, así que ahí se usa el reloj del PC en nanosegundos.
+
+#if PERFILADO
+
+#ifndef PERFIL_CUBETAS
+#define PERFIL_CUBETAS 16  // Cubeta 0: valor 0; i: [2^(i-1), 2^i); la última, el resto
+#endif
+
+enum SeriePerfil {
+  ETAPA_MEDICION,      // Estimación frontal y rejilla (tarea medir)
+  ETAPA_ATASCO,        // Detecciones de bloqueo y atasco
+  ETAPA_DECISION,      // Exploración, pared, gobernador, parada
+  ETAPA_PASO_NAV,      // Paso temporizado de la máquina de estados
+  ETAPA_MOTORES,       // Lazo PI y odometría
+  ETAPA_TELEMETRIA,
+  SERIE_PERIODO_MEDIR, // |periodo real - PERIODO_MEDIR_MS| en us
+  SERIE_PERIODO_NAV,   // |periodo real - 10 ms| en us
+  SERIES_PERFIL
+};
+
+struct SerieEstadistica {
+  uint32_t minimo;
+  uint32_t maximo;
+  uint32_t suma;
+  uint16_t muestras;   // Se deja de sumar al saturar (la media sigue valiendo)
+  uint16_t excedidas;  // Por encima del límite de la serie
+  uint16_t cubetas[PERFIL_CUBETAS];
+};
+
+// Reloj de las etapas (unidades de perfilUnidad())
+uint32_t perfilReloj();
+const __FlashStringHelper *perfilUnidad(uint8_t serie);
+
+void perfilIniciar();
+void perfilRegistrar(uint8_t serie, uint32_t valor);
+
+// Periodo entre dos llamadas de la misma serie frente al nominal
+void perfilPeriodo(uint8_t serie, uint32_t nominalUs);
+
+const SerieEstadistica &perfilSerie(uint8_t serie);
+
+// Volcado por Serial: la parte 0 es la línea de estadísticas y la 1 la del
+// histograma (de la primera a la última cubeta no vacía)
+void perfilImprimir(uint8_t serie, uint8_t parte);
+
+class TemporizadorPerfil {
+ public:
+  explicit TemporizadorPerfil(uint8_t serie) : serie(serie), inicio(perfilReloj()) {}
+  ~TemporizadorPerfil() { perfilRegistrar(serie, perfilReloj() - inicio); }
+
+ private:
+  uint8_t serie;
+  uint32_t inicio;
+};
+
+#define PERFIL_CONCATENAR_(a, b) a##b
+#define PERFIL_CONCATENAR(a, b) PERFIL_CONCATENAR_(a, b)
+#define PERFIL_ETAPA(serie) TemporizadorPerfil PERFIL_CONCATENAR(temporizador, __LINE__)(serie)
+#define PERFIL_PERIODO(serie, nominalUs) perfilPeriodo(serie, nominalUs)
+
+#else
+
+#define PERFIL_ETAPA(serie) do {} while (0)
+#define PERFIL_PERIODO(serie, nominalUs) do {} while (0)
+
+#endif
+
+#endif
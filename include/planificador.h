@@ -0,0 +1,55 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+#include <Arduino.h>
+
+// Planificador cooperativo de milisegundos.
+// Tabla estática de tareas (sin memoria dinámica): cada tarea es periódica
+// o de una sola vez, tiene un plazo relativo a su activación y acumula
+// métricas de jitter (retraso de arranque) y de plazos incumplidos.
+// loop() solo llama a planificadorEjecutar().
+
+// Justo las que registra setup(): cada hueco de más son 27 bytes de SRAM
+#if TRAZA
+#define PLANIFICADOR_MAX_TAREAS 10
+#else
+#define PLANIFICADOR_MAX_TAREAS 9
+#endif
+
+typedef void (*FuncionTarea)();
+
+struct MetricasTarea {
+  uint16_t ejecuciones;
+  uint16_t vencidas;          // Terminó después de su plazo
+  uint16_t perdidas;          // Activaciones saltadas por ir más de un periodo tarde
+  uint16_t jitterMaxUs;       // Mayor retraso entre activación prevista y arranque
+  unsigned long jitterSumaUs; // Para el promedio (se reinicia con las métricas)
+  uint16_t duracionMaxUs;     // Los máximos se saturan en 65535 us
+};
+
+// Vacía la tabla (setup() la vuelve a llenar)
+void planificadorIniciar();
+
+// Registra una tarea y devuelve su id (-1 si la tabla está llena).
+// periodoMs = 0 crea una tarea de una sola vez, inactiva hasta programarla.
+// El nombre va en flash: F("nombre").
+int8_t planificadorAgregar(const __FlashStringHelper *nombre, FuncionTarea funcion,
+                           uint16_t periodoMs, uint16_t plazoMs);
+
+// Arma (o re-arma) una tarea para dentro de retardoMs
+void planificadorProgramar(int8_t id, uint16_t retardoMs);
+void planificadorDetener(int8_t id);
+
+// Cambia el periodo de una tarea periódica a partir de su próxima activación
+void planificadorPeriodo(int8_t id, uint16_t periodoMs);
+
+// Una pasada: ejecuta por orden de tabla las tareas cuya activación llegó
+void planificadorEjecutar();
+
+const MetricasTarea &planificadorMetricas(int8_t id);
+void planificadorReiniciarMetricas();
+
+// Imprime las métricas de cada tarea por Serial
+void planificadorReporte();
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef PUENTE_L298N_H
+#define PUENTE_L298N_H
+
+#include <Arduino.h>
+#include "configuracion.h"
+
+// Capa de salida del L298N: sentido y duty de las dos ruedas en una sola
+// actualización. En el AVR los pines se resuelven al compilar a puerto y
+// bit, y el duty va directo a OCR0A/OCR0B (pines 6 y 5, Timer0), así que
+// una orden son unas pocas escrituras de registro con interrupciones
+// deshabilitadas, en vez de 4 digitalWrite + 2 analogWrite.
+// Con -D PUENTE_API_ARDUINO (o fuera del AVR) usa digitalWrite/analogWrite.
+//
+// Freno: con las dos entradas altas y EN activo el L298N cortocircuita el
+// motor por los transistores de arriba y la fuerza contraelectromotriz lo
+// frena; el duty de EN reparte el tiempo entre freno y rueda libre.
+
+#define PUENTE_FRENO 2  // Sentido: IN1 = IN2 alto, el duty fija la fuerza
+
+struct OrdenPuente {
+  int8_t sentidoIzq;  // +1 adelante, -1 atrás, 0 suelto o PUENTE_FRENO
+  int8_t sentidoDer;
+  uint8_t pwmIzq;
+  uint8_t pwmDer;
+};
+
+// ---- Mapa de pines del UNO, resuelto al compilar ----
+
+enum PuertoAvr : uint8_t { PUERTO_B, PUERTO_C, PUERTO_D };
+
+constexpr PuertoAvr puertoDePin(uint8_t pin) {
+  return pin < 8 ? PUERTO_D : (pin < 14 ? PUERTO_B : PUERTO_C);
+}
+
+constexpr uint8_t bitDePin(uint8_t pin) {
+  return pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14);
+}
+
+// Máscara del pin si está en ese puerto, 0 si no
+constexpr uint8_t mascaraEnPuerto(PuertoAvr puerto, uint8_t pin) {
+  return puertoDePin(pin) == puerto ? (uint8_t)(1 << bitDePin(pin)) : 0;
+}
+
+// Todos los pines del puente que caen en un puerto
+constexpr uint8_t mascaraPuente(PuertoAvr puerto) {
+  return mascaraEnPuerto(puerto, MOTOR_IZQ_IN1) | mascaraEnPuerto(puerto, MOTOR_IZQ_IN2) |
+         mascaraEnPuerto(puerto, MOTOR_IZQ_ENA) | mascaraEnPuerto(puerto, MOTOR_DER_IN3) |
+         mascaraEnPuerto(puerto, MOTOR_DER_IN4) | mascaraEnPuerto(puerto, MOTOR_DER_ENB);
+}
+
+// Canal de comparación de Timer0 de cada pin PWM. Solo existen para 5 y 6:
+// mover ENA/ENB a otro pin no compila en la ruta directa.
+template <uint8_t PIN> struct CanalPwm;
+template <> struct CanalPwm<6> { static constexpr uint8_t canal = 0; };  // OC0A
+template <> struct CanalPwm<5> { static constexpr uint8_t canal = 1; };  // OC0B
+
+void puenteIniciar();
+
+// Aplica sentido y duty de las dos ruedas a la vez
+void puenteAplicar(const OrdenPuente &orden);
+
+// Se puede llamar desde un ISR
+void puenteBloquearAvance(uint8_t freno);
+void puenteDesbloquearAvance();
+bool puenteAvanceBloqueado();
+
+#endif
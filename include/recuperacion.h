@@ -0,0 +1,53 @@
+#ifndef RECUPERACION_H
+#define RECUPERACION_H
+
+#include <Arduino.h>
+#include "odometria.h"
+
+// Política de recuperación común a la parada por obstáculo y a las tres
+// detecciones de atasco. Guarda los últimos eventos con la pose de
+// odometría y, si se repiten en el mismo sitio en poco tiempo (un rincón
+// donde el robot oscila entre maniobras), escala la estrategia:
+//   0-1 eventos cerca: retroceso según el tipo y escaneo
+//   2: retroceso largo y escaneo
+//   3: retroceso largo y media vuelta respecto al rumbo medio del bucle
+//   4+: retroceso largo y salir siguiendo la pared por el lado con más sitio
+// Tras SALIR_PARED el historial se vacía y la escalera vuelve a empezar.
+
+#define RECUPERACION_HISTORIAL 8
+#define RECUPERACION_VENTANA_MS 20000UL  // Eventos más viejos no cuentan
+#define RECUPERACION_RADIO_CM 50         // "Mismo sitio"
+
+enum EventoRecuperacion {
+  EVENTO_OBSTACULO,  // Parada a DISTANCIA_CRITICA
+  EVENTO_BLOQUEO,
+  EVENTO_ATASCO,
+  EVENTO_TIEMPO,
+  EVENTOS
+};
+
+enum EstrategiaRecuperacion {
+  ESTRATEGIA_NORMAL,
+  ESTRATEGIA_RETROCESO_LARGO,
+  ESTRATEGIA_MEDIA_VUELTA,
+  ESTRATEGIA_SALIR_PARED,
+  ESTRATEGIAS
+};
+
+struct PlanRecuperacion {
+  uint8_t estrategia;
+  unsigned long retrocesoMs;
+  int giroGrados;  // Positivo = izquierda; 0 = escanear y elegir
+};
+
+void recuperacionIniciar();
+
+// Registra el evento en la pose dada y devuelve qué hacer. Para un bloqueo
+// físico conviene la última pose con avance confirmado: empujando la pared
+// las ruedas patinan y la odometría sigue sumando.
+PlanRecuperacion recuperacionEvento(uint8_t tipo, const PoseOdometria &pose);
+
+// Veces que se eligió cada estrategia
+uint16_t recuperacionEstrategias(EstrategiaRecuperacion estrategia);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef REJILLA_H
+#define REJILLA_H
+
+#include <Arduino.h>
+
+// Mapa de ocupación a bordo: 2 bits por celda en una rejilla fija
+// centrada en la pose de arranque (origen de la odometría). 24x24 celdas de
+// 25 cm = 6x6 m en 144 bytes de SRAM.
+// Cada lectura del barrido traza un rayo desde la pose de odometría en la
+// dirección del servo: las celdas recorridas quedan libres y la del eco,
+// ocupada. La celda bajo el robot se marca visitada.
+// rejillaPuntuacion() valora una dirección por lo que queda por descubrir
+// en ella (celdas desconocidas) frente a lo ya recorrido (visitadas), para
+// elegir giros hacia la frontera en vez de volver a los mismos rincones.
+
+#ifndef REJILLA_LADO
+#define REJILLA_LADO 24
+#endif
+#ifndef REJILLA_CELDA_CM
+#define REJILLA_CELDA_CM 25
+#endif
+#define REJILLA_RAYO_MAX_CM 150  // Más lejos el haz es ancho y la odometría deriva
+
+enum EstadoCelda {
+  CELDA_DESCONOCIDA = 0,
+  CELDA_LIBRE = 1,
+  CELDA_VISITADA = 2,
+  CELDA_OCUPADA = 3
+};
+
+void rejillaIniciar();
+
+// Marca visitada la celda del robot (llamar tras odometriaActualizar)
+void rejillaVisitar();
+
+// Lectura con eco del sensor con el servo en anguloServo (90 = frente).
+// Sin eco no hay observación: quien llama no la pasa.
+void rejillaObservar(int anguloServo, long distCm);
+
+// Puntuación de exploración de la dirección anguloServo con distCm libres
+// por delante: más alta cuanto más desconocido y menos visitado
+int rejillaPuntuacion(int anguloServo, long distCm);
+
+// Estado de la celda (x, y) en cm del marco de la odometría
+uint8_t rejillaCelda(float xCm, float yCm);
+
+// Celdas conocidas (libres, visitadas u ocupadas)
+uint16_t rejillaConocidas();
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SERVO_SENSOR_H
+#define SERVO_SENSOR_H
+
+#include <Arduino.h>
+#include "configuracion.h"
+
+// Servo del HC-SR04 (SG90 en SERVO_PIN) con un modelo de su movimiento:
+// el SG90 no dice dónde está, así que la posición se estima desde la
+// última orden. La orden sale con el siguiente pulso (hasta
+// SERVO_RETARDO_MS), el eje gira a velocidad constante (parámetro
+// servo_grados_s) y al llegar oscila SERVO_ASENTAMIENTO_MS. Con eso se
+// sabe cuándo estará quieto (servoAsentadoMs()) en vez de esperar un
+// tiempo fijo, y qué ángulo tenía en cada disparo aunque se moviera.
+//
+// Timer1: la librería Servo del UNO lo usa entero para generar los pulsos
+// (tramas de 20 ms, el pulso por interrupción en cualquier pin), y con él
+// analogWrite() deja de funcionar en los pines 9 y 10. El PWM de los
+// motores va por Timer0 (pines 5 y 6, puente_l298n.h) y millis()/micros()
+// también, así que no hay conflicto; el 11 (Timer2) tampoco se usa como
+// PWM. Este módulo es el único dueño del Servo: nada más debe tocar el
+// Timer1 mientras esté conectado (el banco de ciclos de motores lo usa
+// porque no conecta el servo).
+
+#define SERVO_RETARDO_MS 20       // Una trama de la librería Servo
+#define SERVO_ASENTAMIENTO_MS 15  // Oscilación del brazo al llegar
+
+// Conecta el servo y lo manda a angulo. La posición de partida es
+// desconocida: se cuenta un recorrido completo hasta darlo por asentado.
+void servoIniciar(int angulo);
+
+void servoMover(int angulo);
+int servoAnguloPedido();
+
+// Ángulo estimado ahora o en un instante reciente (millis()), como mucho
+// desde la orden anterior a la última
+int servoAnguloEstimado();
+int servoAnguloEn(unsigned long ms);
+
+// Quieto en el ángulo pedido según el modelo
+bool servoAsentado();
+unsigned long servoAsentadoMs();  // millis() en que lo estará
+unsigned long servoEtaMs();       // Lo que falta, 0 si ya lo está
+
+#endif
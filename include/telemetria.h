@@ -0,0 +1,27 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <Arduino.h>
+#include "trama_telemetria.h"
+
+// Telemetría binaria por Serial.
+// Las tramas se encolan en un anillo propio; si está lleno se descarta la
+// más vieja. telemetriaEnviar() solo escribe tramas enteras que quepan en
+// el buffer de la UART, así que nunca bloquea y el texto de los eventos
+// no se mete en medio de una trama.
+
+#ifndef TELEMETRIA_COLA
+#define TELEMETRIA_COLA 2  // Tramas en espera (2 x 34 bytes de SRAM)
+#endif
+
+void telemetriaIniciar();
+
+// Completa sincronismo, versión, secuencia y CRC, y encola
+void telemetriaPublicar(TramaTelemetria &trama);
+
+// Pasa a la UART las tramas que quepan sin esperar
+void telemetriaEnviar();
+
+uint16_t telemetriaDescartadas();
+
+#endif
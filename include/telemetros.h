@@ -0,0 +1,56 @@
+#ifndef TELEMETROS_H
+#define TELEMETROS_H
+
+#include <Arduino.h>
+
+// Gestor de telémetros: el HC-SR04 del servo más los sensores fijos en el
+// chasis de la tabla TELEMETROS (configuracion.h).
+// Los ultrasónicos son canales del driver de ultrasonido.h, que los
+// dispara por turnos y espaciados; los IR (Sharp GP2Y0A21, analógicos) no
+// se interfieren y se leen cada TELEMETRO_IR_PERIODO_MS. Cada lectura de
+// un sensor fijo se registra en el buffer polar de barrido.h (sector de su
+// ángulo, con marca de tiempo), así que con sensores laterales esos
+// sectores están frescos sin mover el servo ni parar a escanear. Las del
+// sensor del servo las sigue registrando barrido.h.
+
+enum TipoTelemetro {
+  TELEMETRO_ULTRASONIDO,
+  TELEMETRO_IR
+};
+
+#define TELEMETRO_EN_SERVO -1        // Ángulo del sensor montado en el servo
+#define TELEMETROS_MAX 4
+#define TELEMETRO_IR_PERIODO_MS 40   // El GP2Y0A21 da una medida cada ~38 ms
+#define TELEMETRO_IR_MIN_CM 10       // Rango útil del GP2Y0A21
+#define TELEMETRO_IR_MAX_CM 80
+
+struct Telemetro {
+  uint8_t tipo;     // TipoTelemetro
+  uint8_t pinA;     // Trigger, o salida analógica del IR
+  uint8_t pinB;     // Echo (sin uso en el IR)
+  int16_t angulo;   // 0 = derecha, 90 = frente, 180 = izquierda
+};
+
+// Configura los pines; sustituye a ultrasonidoIniciar()
+void telemetrosIniciar();
+
+// Llamar cada pocos ms: dispara por turnos, lee los IR y registra las
+// lecturas nuevas de los sensores fijos
+void telemetrosActualizar();
+
+uint8_t telemetrosCantidad();
+const Telemetro &telemetro(uint8_t i);
+
+// Ángulo del sensor de un canal de ultrasonido.h (TELEMETRO_EN_SERVO = el del servo)
+int telemetrosAnguloCanal(uint8_t canal);
+
+// Curva del GP2Y0A21 (ADC de 10 bits a 5 V): cm = 4800 / (adc - 20).
+// Más lejos que TELEMETRO_IR_MAX_CM es 400 y se registra sin eco; por
+// debajo de TELEMETRO_IR_MIN_CM la curva se dobla y se da el mínimo.
+inline long telemetroIrACm(int adc) {
+  if (adc <= 20 + 4800 / TELEMETRO_IR_MAX_CM) return 400;
+  long cm = 4800L / (adc - 20);
+  return cm < TELEMETRO_IR_MIN_CM ? TELEMETRO_IR_MIN_CM : cm;
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef TRAMA_TELEMETRIA_H
+#define TRAMA_TELEMETRIA_H
+
+// Formato binario de la telemetría, compartido por el firmware y por el
+// decodificador de Linux (herramientas/telemetria_csv.cpp). Sin
+// dependencias de Arduino. Little-endian en los dos lados (AVR y x86).
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TRAMA_SINC_0 0xA5
+#define TRAMA_SINC_1 0x5A
+#define TRAMA_VERSION 2
+
+struct __attribute__((packed)) TramaTelemetria {
+  uint8_t sinc[2];             // TRAMA_SINC_0, TRAMA_SINC_1
+  uint8_t version;
+  uint8_t secuencia;           // Huecos = tramas perdidas
+  uint32_t tiempoMs;
+  int16_t distanciaCm;
+  uint8_t pwmIzq;
+  uint8_t pwmDer;
+  int16_t velIzqMmS;           // Medida por los encoders, con signo
+  int16_t velDerMmS;
+  int16_t xCm;                 // Odometría
+  int16_t yCm;
+  int16_t rumboCentigrados;
+  uint8_t estado;              // EstadoNav
+  uint8_t contadorAtasco;
+  uint16_t escaneos;
+  uint16_t recuperaciones;     // Suma de todas las causas
+  uint16_t descartadas;        // Tramas tiradas por cola llena en el robot
+  uint16_t bateriaMv;          // Filtrada; 0 = sin batería
+  uint16_t crc;                // CRC-16/CCITT de todo lo anterior
+};
+
+static_assert(sizeof(TramaTelemetria) == 34, "la trama de telemetría debe ocupar 34 bytes");
+
+// CRC-16/CCITT-FALSE (polinomio 0x1021, inicial 0xFFFF)
+inline uint16_t crc16Ccitt(const uint8_t *datos, size_t n) {
+  uint16_t crc = 0xFFFF;
+  while (n--) {
+    crc ^= (uint16_t)(*datos++) << 8;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = crc & 0x8000 ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef TRAMA_TRAZA_H
+#define TRAMA_TRAZA_H
+
+// Formato binario de las trazas de sensores (traza.h), compartido por el
+// firmware y por el reproductor del simulador (src/sim/reproduccion.cpp).
+// Sin dependencias de Arduino.
+//
+// Trama: sinc (2) | versión | secuencia | longitud | carga | CRC-16 (2)
+// La carga empieza con el instante base (uint32 en us, little-endian) y
+// sigue con eventos; cada trama se decodifica sola aunque se pierdan otras.
+// Evento: varint((Δt << 3) | tipo) y los datos del tipo. Δt es en us
+// desde el evento anterior (o desde la base) y tiene que caber en 29 bits
+// (~9 min; los ecos llegan cada 50 ms). Varint: 7 bits por byte, primero
+// los bajos, el bit alto indica que sigue otro byte.
+
+#include <stdint.h>
+#include <stddef.h>
+#include "trama_telemetria.h"
+
+#define TRAZA_SINC_0 0xA5
+#define TRAZA_SINC_1 0x5C          // La telemetría usa 0xA5 0x5A
+#define TRAZA_VERSION 1
+#define TRAZA_CABECERA 5
+#define TRAZA_CARGA_MAX 48
+#define TRAZA_TRAMA_MAX (TRAZA_CABECERA + TRAZA_CARGA_MAX + 2)
+#define TRAZA_EVENTO_MAX 11        // Bytes del evento más largo
+
+enum TipoEventoTraza {
+  TRAZA_PULSO_IZQ,   // varint: retraso de la entrega frente a la marca del flanco (us)
+  TRAZA_PULSO_DER,
+  TRAZA_ECO,         // canal (1) | varint: ancho del eco (us, 0 = timeout)
+  TRAZA_ANALOGICA,   // pin (1) | varint: lectura del ADC (IR, batería)
+  TRAZA_ESTADO,      // estado (1): transición de la navegación
+  TRAZA_PARAMETRO,   // id (1) | int16: cambio de parametros[] (y valores al arrancar)
+  TRAZA_PERDIDOS,    // varint: eventos tirados por cola llena antes de este
+  TRAZA_TIPOS
+};
+
+struct EventoTraza {
+  uint32_t us;       // Instante de entrega (micros())
+  uint8_t tipo;
+  uint8_t canal;     // Canal del eco, pin analógico o id del parámetro
+  uint32_t dato;
+};
+
+inline uint8_t trazaEscribirVarint(uint8_t *p, uint32_t v) {
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    p[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  p[n++] = (uint8_t)v;
+  return n;
+}
+
+// Bytes leídos, o 0 si se sale de la carga
+inline uint8_t trazaLeerVarint(const uint8_t *p, const uint8_t *fin, uint32_t &v) {
+  v = 0;
+  for (uint8_t n = 0; n < 5 && p + n < fin; n++) {
+    v |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+    if (!(p[n] & 0x80)) return n + 1;
+  }
+  return 0;
+}
+
+// Escribe el evento (como mucho TRAZA_EVENTO_MAX bytes) y devuelve su tamaño
+inline uint8_t trazaCodificar(uint8_t *p, uint32_t deltaUs, const EventoTraza &e) {
+  uint8_t n = trazaEscribirVarint(p, (deltaUs << 3) | e.tipo);
+  switch (e.tipo) {
+    case TRAZA_ECO:
+    case TRAZA_ANALOGICA:
+      p[n++] = e.canal;
+      n += trazaEscribirVarint(p + n, e.dato);
+      break;
+    case TRAZA_ESTADO:
+      p[n++] = (uint8_t)e.dato;
+      break;
+    case TRAZA_PARAMETRO:
+      p[n++] = e.canal;
+      p[n++] = (uint8_t)e.dato;
+      p[n++] = (uint8_t)(e.dato >> 8);
+      break;
+    default:
+      n += trazaEscribirVarint(p + n, e.dato);
+  }
+  return n;
+}
+
+// Lee un evento; tiempoUs avanza al del evento. Devuelve los bytes leídos,
+// o 0 si el evento está cortado o es de un tipo desconocido.
+inline uint8_t trazaDecodificar(const uint8_t *p, const uint8_t *fin, uint32_t &tiempoUs,
+                                EventoTraza &e) {
+  uint32_t cabecera;
+  uint8_t n = trazaLeerVarint(p, fin, cabecera);
+  if (n == 0) return 0;
+  e.tipo = cabecera & 0x07;
+  e.canal = 0;
+  e.dato = 0;
+  uint8_t m = 0;
+  switch (e.tipo) {
+    case TRAZA_ECO:
+    case TRAZA_ANALOGICA:
+      if (p + n >= fin) return 0;
+      e.canal = p[n++];
+      m = trazaLeerVarint(p + n, fin, e.dato);
+      if (m == 0) return 0;
+      break;
+    case TRAZA_ESTADO:
+      if (p + n >= fin) return 0;
+      e.dato = p[n++];
+      break;
+    case TRAZA_PARAMETRO:
+      if (p + n + 3 > fin) return 0;
+      e.canal = p[n];
+      e.dato = (uint16_t)(p[n + 1] | (p[n + 2] << 8));
+      n += 3;
+      break;
+    case TRAZA_PULSO_IZQ:
+    case TRAZA_PULSO_DER:
+    case TRAZA_PERDIDOS:
+      m = trazaLeerVarint(p + n, fin, e.dato);
+      if (m == 0) return 0;
+      break;
+    default:
+      return 0;
+  }
+  tiempoUs += cabecera >> 3;
+  e.us = tiempoUs;
+  return n + m;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <Arduino.h>
+#include "configuracion.h"
+
+// Captura de las entradas del robot para reproducirlas en el simulador
+// (robot_sim --reproducir, ver el README). Se apuntan, con su micros():
+// cada pulso de encoder y cada eco publicado (desde los ISR), las lecturas
+// analógicas (IR y batería), los cambios de parametros[] (y sus valores
+// al arrancar) y, para comparar, cada transición de la navegación.
+//
+// Los eventos van a una cola en RAM y trazaEnviar() los codifica en
+// tramas (trama_traza.h) que solo escribe si caben en el buffer de la
+// UART; con la cola llena se tiran y se anota cuántos. Unos 650 bytes/s
+// de media en el simulador (el 6 % de la UART a 115200).
+//
+// Con TRAZA a 0 (por defecto en el UNO) las macros no generan código.
+
+#if TRAZA
+
+#include "trama_traza.h"
+
+#define TRAZA_COLA 12  // Eventos (10 bytes de SRAM cada uno); el simulador no pasa de 7
+
+// Llamar al principio de setup(), tras parametrosIniciar()
+void trazaIniciar();
+
+// Desde el ISR o con las interrupciones deshabilitadas
+void trazaPulso(uint8_t rueda, unsigned long marcaUs);
+void trazaEco(uint8_t canal, unsigned long anchoUs);
+
+void trazaAnalogica(uint8_t pin, int valor);
+void trazaEstado(uint8_t estado);
+void trazaParametro(uint8_t id, int16_t valor);
+
+// Pasa a la UART las tramas que quepan sin esperar
+void trazaEnviar();
+
+#define TRAZA_PULSO(rueda, us) trazaPulso(rueda, us)
+#define TRAZA_ECO(canal, anchoUs) trazaEco(canal, anchoUs)
+#define TRAZA_ANALOGICA(pin, valor) trazaAnalogica(pin, valor)
+#define TRAZA_ESTADO(estado) trazaEstado(estado)
+#define TRAZA_PARAMETRO(id, valor) trazaParametro(id, valor)
+
+#else
+
+#define TRAZA_PULSO(rueda, us) do {} while (0)
+#define TRAZA_ECO(canal, anchoUs) do {} while (0)
+#define TRAZA_ANALOGICA(pin, valor) do {} while (0)
+#define TRAZA_ESTADO(estado) do {} while (0)
+#define TRAZA_PARAMETRO(id, valor) do {} while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef ULTRASONIDO_H
+#define ULTRASONIDO_H
+
+#include <Arduino.h>
+#include "configuracion.h"  // ULTRASONIDO_CANALES
+
+// Driver no bloqueante del HC-SR04, para uno o varios sensores (canales).
+// El disparo se hace desde ultrasonidoActualizar() y los flancos del pin Echo
+// se marcan con micros() desde una interrupción de cambio de pin, así que
+// loop() solo lee la última medición publicada y nunca espera al eco.
+// En el flanco de bajada el ISR pasa el eco a la parada de emergencia
+// (emergencia.h) antes de publicarlo.
+//
+// Con varios canales solo hay un disparo en vuelo: se dispara por turnos,
+// el canal 0 (el del servo) uno de cada dos, y entre dos disparos de
+// canales distintos pasa al menos ULTRASONIDO_SEPARACION_US para que el
+// eco tardío de uno no lo recoja el siguiente (diafonía). Con la
+// separación de 25 ms el canal 0 mantiene su periodo de 50 ms y cada
+// sensor fijo se lee cada 100 ms (con dos fijos, cada 200 ms).
+//
+// Un canal se puede aplazar (el del servo mientras se mueve, ver
+// barrido.h): no gasta el disparo en una lectura que se tiraría y dispara
+// en cuanto se puede. Mientras, si hay margen, se adelanta un fijo.
+//
+// Echo en el puerto B (pines 8-13, PCINT0) o D (0-7, PCINT2); el puerto C
+// (A0-A5, PCINT1) es de los encoders.
+
+#define ULTRASONIDO_PERIODO_US  50000UL  // Separación mínima entre disparos de un canal
+#define ULTRASONIDO_SEPARACION_US 25000UL  // Entre disparos de canales distintos
+#define ULTRASONIDO_TIMEOUT_US  25000UL  // Igual que el antiguo pulseIn(..., 25000)
+
+struct LecturaUltrasonido {
+  unsigned long anchoUs;   // Ancho del pulso de eco (0 = sin eco / timeout)
+  unsigned long disparoMs; // millis() del disparo que originó la medición
+  unsigned long tiempoMs;  // millis() en que se publicó
+  uint16_t secuencia;      // Se incrementa con cada medición publicada
+};
+
+// Deja un único canal (el 0) con estos pines
+void ultrasonidoIniciar(uint8_t pinTrigger, uint8_t pinEco);
+
+// Añade un canal; devuelve su número o -1 si no caben más
+int8_t ultrasonidoAgregar(uint8_t pinTrigger, uint8_t pinEco);
+uint8_t ultrasonidoCanales();
+
+// El canal no dispara antes de desdeUs (micros()); se anula al pasar
+void ultrasonidoAplazar(uint8_t canal, unsigned long desdeUs);
+
+// Avanza la máquina de estados: dispara si toca y cierra por timeout.
+void ultrasonidoActualizar();
+void ultrasonidoPaso(unsigned long ahoraUs);
+
+// Copia atómica de la última medición publicada del canal
+LecturaUltrasonido ultrasonidoUltima(uint8_t canal = 0);
+bool ultrasonidoOcupado();
+
+// Cuerpo del ISR del pin Echo (nivel leído y marca de tiempo del flanco).
+// El flanco es del canal disparado.
+void ultrasonidoFlancoEco(bool nivel, unsigned long us);
+
+// Convierte el ancho de eco a cm (0.034 cm/us ida y vuelta)
+inline long ultrasonidoACm(unsigned long anchoUs) {
+  return (long)((anchoUs * 17UL) / 1000UL);
+}
+
+// Eco dentro del alcance (el timeout publica anchoUs = 0)
+inline bool ultrasonidoConEco(const LecturaUltrasonido &lectura) {
+  long dist = ultrasonidoACm(lectura.anchoUs);
+  return dist > 0 && dist <= 400;
+}
+
+// Distancia en cm con el criterio histórico: sin eco o fuera de rango = 400
+inline long ultrasonidoDistanciaCm(const LecturaUltrasonido &lectura) {
+  long dist = ultrasonidoACm(lectura.anchoUs);
+  if (dist == 0 || dist > 400) dist = 400;  // Límite máximo
+  return dist;
+}
+
+#ifndef __AVR__
+// Mock de host: devuelve el ancho del eco (us) para cada disparo del canal,
+// 0 = sin eco. Los flancos se sintetizan con marcas de tiempo exactas en
+// ultrasonidoMockFlancos(): el simulador parte el paso de física en el
+// instante de cada uno y lo entrega con micros() en ese instante, como el
+// ISR aunque loop() no corra (ultrasonidoPaso() también lo llama).
+extern unsigned long (*ultrasonidoMockEco)(uint8_t canal);
+void ultrasonidoMockFlancos(unsigned long ahoraUs);
+
+// micros() del próximo flanco simulado; false sin eco en vuelo
+bool ultrasonidoMockProximoFlanco(unsigned long *us);
+#define ULTRASONIDO_MOCK_RETARDO_US 450UL  // Ráfaga de 8 ciclos a 40 kHz + margen
+#endif
+
+#endif
@@ -0,0 +1,258 @@
+#include "barrido.h"
+#include "servo_sensor.h"
+#include "ultrasonido.h"
+#include "filtro_distancia.h"
+#include "rejilla.h"
+#include "emergencia.h"
+
+struct Sector {
+  long distCm;
+  unsigned long tiempoMs;
+  bool valido;
+  bool eco;       // Sin eco el sector está medido pero no da distancia
+};
+
+// Recorrido lento alternando con el frente: 90 45 90 135 90 0 90 180
+static const uint8_t SECUENCIA[] = {90, 45, 90, 135, 90, 0, 90, 180};
+#define PASOS_SECUENCIA (sizeof(SECUENCIA) / sizeof(SECUENCIA[0]))
+
+static Sector sectores[BARRIDO_SECTORES];
+static uint8_t modo = BARRIDO_APARCADO;
+static uint8_t paso = 0;
+static int anguloActual = 90;          // Pedido al servo
+static uint16_t ultimaSecuencia = 0;
+static bool lecturaTomada = false;     // Ya hay lectura en la posición actual
+static FiltroDistancia filtroFrontal; // Todas las lecturas con el servo a 90°
+static int anguloPared = 45;
+static uint8_t lecturasPared = 0;      // Laterales desde el último vistazo
+
+// Escaneo completo en curso: recorre los sectores en un sentido que se
+// alterna entre pasadas, empezando por el extremo más cercano al servo
+static int8_t indiceEscaneo = 0;       // Sector (0..BARRIDO_SECTORES-1)
+static int8_t sentidoEscaneo = -1;     // +1 de 0° a 180°, -1 al revés
+static uint8_t lecturasEscaneo = 0;
+static uint8_t ecosEscaneo = 0;        // De las lecturas de la posición
+static int excluidoEscaneo = -1;       // Sector que no termina el escaneo
+static long lecturas[BARRIDO_ESCANEO_LECTURAS];
+static uint16_t escaneos = 0;
+static unsigned long inicioEscaneoMs = 0;
+static uint32_t duracionEscaneosMs = 0;
+
+// El disparo del HC-SR04 del servo espera a que se asiente, salvo que
+// las lecturas en movimiento sirvan (a la rejilla, fuera del escaneo)
+static void mover(int angulo) {
+  servoMover(angulo);
+  anguloActual = angulo;
+  lecturaTomada = false;
+  // Al frente, la parada de emergencia vale para lo disparado ya asentado
+  emergenciaVigilar(0, angulo == 90, servoAsentadoMs());
+  if (modo == BARRIDO_ESCANEO || !BARRIDO_LECTURAS_EN_MOVIMIENTO) {
+    ultrasonidoAplazar(0, micros() + servoEtaMs() * 1000UL);
+  }
+}
+
+void barridoIniciar() {
+  barridoInvalidar();
+  modo = BARRIDO_APARCADO;
+  paso = 0;
+  escaneos = 0;
+  duracionEscaneosMs = 0;
+  ultimaSecuencia = ultrasonidoUltima().secuencia;
+  anguloActual = 90;
+  mover(90);
+}
+
+static bool sectorFresco(int8_t i) {
+  const Sector &s = sectores[i];
+  return s.valido && millis() - s.tiempoMs <= BARRIDO_EDAD_MAX_MS;
+}
+
+static void terminarEscaneo() {
+  modo = BARRIDO_APARCADO;
+  duracionEscaneosMs += millis() - inicioEscaneoMs;
+  mover(90);
+}
+
+// Siguiente sector sin lectura fresca en el sentido de la pasada; el
+// asentamiento solo cubre el salto desde la posición actual
+static void siguienteSector() {
+  while (indiceEscaneo >= 0 && indiceEscaneo < BARRIDO_SECTORES && sectorFresco(indiceEscaneo)) {
+    indiceEscaneo += sentidoEscaneo;
+  }
+  if (indiceEscaneo < 0 || indiceEscaneo >= BARRIDO_SECTORES) {
+    terminarEscaneo();
+    return;
+  }
+  lecturasEscaneo = 0;
+  ecosEscaneo = 0;
+  mover(indiceEscaneo * BARRIDO_PASO_GRADOS);
+}
+
+void barridoModo(ModoBarrido nuevo, int excluir) {
+  if (nuevo == BARRIDO_ESCANEO) {
+    modo = BARRIDO_ESCANEO;
+    excluidoEscaneo = excluir;
+    escaneos++;
+    inicioEscaneoMs = millis();
+    if (anguloActual != 90) {
+      sentidoEscaneo = anguloActual < 90 ? 1 : -1;
+    } else {
+      sentidoEscaneo = -sentidoEscaneo;
+    }
+    indiceEscaneo = sentidoEscaneo > 0 ? 0 : BARRIDO_SECTORES - 1;
+    Serial.println(F("🔍 Escaneando..."));
+    siguienteSector();
+  } else if (modo != BARRIDO_ESCANEO) {
+    modo = nuevo;
+  }
+}
+
+void barridoSeguirPared(int angulo) {
+  if (modo == BARRIDO_ESCANEO) return;
+  if (modo != BARRIDO_PARED || angulo != anguloPared) lecturasPared = 0;
+  modo = BARRIDO_PARED;
+  anguloPared = angulo;
+}
+
+bool barridoEscaneando() {
+  return modo == BARRIDO_ESCANEO;
+}
+
+// Mediana de 3: un eco perdido o un rebote sueltos no mueven el sector
+static long mediana3(const long *v) {
+  return max(min(v[0], v[1]), min(max(v[0], v[1]), v[2]));
+}
+
+// Una lectura válida más en la posición del escaneo completo
+static void lecturaEscaneo(long dist, bool conEco) {
+  lecturas[lecturasEscaneo] = dist;
+  if (conEco) ecosEscaneo++;
+  if (++lecturasEscaneo < BARRIDO_ESCANEO_LECTURAS) return;
+
+  // Con dos ecos de tres la mediana es uno de ellos
+  long mediana = mediana3(lecturas);
+  bool eco = ecosEscaneo >= 2;
+  barridoRegistrar(anguloActual, mediana, eco);
+  Serial.print(F("  "));
+  Serial.print(anguloActual);
+  Serial.print(F("°: "));
+  if (eco) {
+    Serial.print(mediana);
+    Serial.println(F(" cm"));
+  } else {
+    Serial.println(F("sin eco"));
+  }
+
+  // Una salida claramente abierta basta para decidir
+  if (eco && mediana >= BARRIDO_LIBRE_CLARO_CM && anguloActual != excluidoEscaneo) {
+    terminarEscaneo();
+    return;
+  }
+  indiceEscaneo += sentidoEscaneo;
+  siguienteSector();
+}
+
+void barridoActualizar() {
+  LecturaUltrasonido lectura = ultrasonidoUltima();
+  if (lectura.secuencia != ultimaSecuencia) {
+    ultimaSecuencia = lectura.secuencia;
+    // Al buffer polar solo con el servo ya quieto
+    if ((long)(lectura.disparoMs - servoAsentadoMs()) >= 0) {
+      long dist = ultrasonidoDistanciaCm(lectura);
+      bool eco = ultrasonidoConEco(lectura);
+      if (anguloActual == 90) {
+        // Al frente vale lo que sigue el filtro, medido o predicho
+        filtroDistanciaMedida(filtroFrontal, lectura.anchoUs, lectura.disparoMs);
+        EstimacionDistancia frente = barridoFrontalEstimacion();
+        dist = frente.distanciaCm;
+        eco = frente.siguiendo;
+      }
+      if (modo == BARRIDO_ESCANEO) {
+        lecturaEscaneo(dist, eco);
+        return;
+      }
+      barridoRegistrar(anguloActual, dist, eco);
+      lecturaTomada = true;
+    } else if (BARRIDO_LECTURAS_EN_MOVIMIENTO && modo != BARRIDO_ESCANEO &&
+               ultrasonidoConEco(lectura)) {
+      rejillaObservar(servoAnguloEn(lectura.disparoMs), ultrasonidoDistanciaCm(lectura));
+    }
+  }
+
+  if (modo == BARRIDO_APARCADO) {
+    if (anguloActual != 90) mover(90);
+  } else if (modo == BARRIDO_CONTINUO && lecturaTomada) {
+    paso = (paso + 1) % PASOS_SECUENCIA;
+    mover(SECUENCIA[paso]);
+  } else if (modo == BARRIDO_PARED) {
+    if (anguloActual == 90 && lecturaTomada) {
+      lecturasPared = 0;
+      mover(anguloPared);
+    } else if (anguloActual != 90 && anguloActual != anguloPared) {
+      mover(anguloPared);
+    } else if (anguloActual == anguloPared && lecturaTomada) {
+      lecturaTomada = false;
+      if (++lecturasPared >= BARRIDO_PARED_LECTURAS) mover(90);
+    }
+  }
+}
+
+long barridoFrontal() {
+  return barridoFrontalEstimacion().distanciaCm;
+}
+
+EstimacionDistancia barridoFrontalEstimacion() {
+  return filtroDistanciaEstimar(filtroFrontal, millis());
+}
+
+void barridoRegistrar(int angulo, long distCm, bool eco) {
+  Sector &s = sectores[angulo / BARRIDO_PASO_GRADOS];
+  s.distCm = distCm;
+  s.tiempoMs = millis();
+  s.valido = true;
+  s.eco = eco;
+  if (eco) rejillaObservar(angulo, distCm);
+}
+
+int barridoMejorAngulo(unsigned long edadMaxMs, long *distMax, int excluir) {
+  unsigned long ahora = millis();
+  int mejorAngulo = -1;
+  long maxDist = -1;
+
+  for (uint8_t i = 0; i < BARRIDO_SECTORES; i++) {
+    const Sector &s = sectores[i];
+    if (!s.valido || ahora - s.tiempoMs > edadMaxMs) {
+      if (distMax) *distMax = -1;
+      return -1;
+    }
+    if (i * BARRIDO_PASO_GRADOS == excluir || !s.eco) continue;
+    if (s.distCm > maxDist) {
+      maxDist = s.distCm;
+      mejorAngulo = i * BARRIDO_PASO_GRADOS;
+    }
+  }
+
+  if (distMax) *distMax = maxDist;
+  return mejorAngulo;
+}
+
+long barridoDistancia(int angulo, unsigned long edadMaxMs) {
+  const Sector &s = sectores[angulo / BARRIDO_PASO_GRADOS];
+  if (!s.valido || !s.eco || millis() - s.tiempoMs > edadMaxMs) return -1;
+  return s.distCm;
+}
+
+void barridoInvalidar() {
+  for (uint8_t i = 0; i < BARRIDO_SECTORES; i++) {
+    sectores[i].valido = false;
+  }
+  filtroDistanciaIniciar(filtroFrontal);
+}
+
+uint16_t barridoEscaneos() {
+  return escaneos;
+}
+
+uint32_t barridoDuracionEscaneosMs() {
+  return duracionEscaneosMs;
+}
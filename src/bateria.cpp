@@ -0,0 +1,44 @@
+#include "bateria.h"
+#include "configuracion.h"
+#include "traza.h"
+
+static uint32_t filtradoMv = 0;  // Con BATERIA_FILTRO_BITS bits de fracción
+static uint32_t cargaMv = 0;     // Con BATERIA_CARGA_BITS
+
+static uint16_t muestra() {
+  int adc = analogRead(BATERIA_PIN);
+  TRAZA_ANALOGICA(BATERIA_PIN, adc);
+  return bateriaAdcAMv(adc);
+}
+
+void bateriaIniciar() {
+  uint16_t mv = muestra();
+  filtradoMv = (uint32_t)mv << BATERIA_FILTRO_BITS;
+  cargaMv = (uint32_t)mv << BATERIA_CARGA_BITS;
+}
+
+void bateriaActualizar(bool enCarga) {
+  uint16_t mv = muestra();
+  filtradoMv = filtradoMv - (filtradoMv >> BATERIA_FILTRO_BITS) + mv;
+  if (enCarga) cargaMv = cargaMv - (cargaMv >> BATERIA_CARGA_BITS) + mv;
+}
+
+static uint16_t milivoltios(uint32_t filtrado, uint8_t bits) {
+  uint16_t mv = (uint16_t)((filtrado + (1UL << (bits - 1))) >> bits);
+  return mv < BATERIA_MIN_MV ? 0 : mv;
+}
+
+uint16_t bateriaMilivoltios() {
+  return milivoltios(filtradoMv, BATERIA_FILTRO_BITS);
+}
+
+uint16_t bateriaCargaMilivoltios() {
+  return milivoltios(cargaMv, BATERIA_CARGA_BITS);
+}
+
+uint16_t bateriaCompensacionQ8(uint16_t referenciaMv) {
+  uint16_t mv = bateriaCargaMilivoltios();
+  if (referenciaMv == 0 || mv == 0) return FACTOR_UNIDAD_Q8;
+  uint32_t k = ((uint32_t)referenciaMv * FACTOR_UNIDAD_Q8 + mv / 2) / mv;
+  return (uint16_t)constrain(k, (uint32_t)BATERIA_COMPENSACION_MIN_Q8, (uint32_t)BATERIA_COMPENSACION_MAX_Q8);
+}
@@ -0,0 +1,86 @@
+// Banco de ciclos de la ruta de mando de motores ([env:bench_motores]).
+// Sin Servo, Timer1 queda libre y se usa como contador de ciclos a 16 MHz.
+// Compara la ruta anterior (4 digitalWrite + 2 analogWrite y factor en
+// double) con puenteAplicar() y con avanzarConVelocidad() completo.
+//
+//   pio run -e bench_motores -t upload && pio device monitor
+
+#include <Arduino.h>
+#include "configuracion.h"
+#include "motores.h"
+#include "puente_l298n.h"
+#include "parametros.h"
+
+#define REPETICIONES 200
+
+static volatile int velocidadBanco = VELOCIDAD_MAXIMA;
+
+// Copia de avanzarConVelocidad() antes de la capa puente_l298n
+static void avanzarDigitalWrite(int velocidad) {
+  int velIzq = velocidad * FACTOR_MOTOR_IZQ;
+  int velDer = velocidad * FACTOR_MOTOR_DER;
+
+  digitalWrite(MOTOR_IZQ_IN1, HIGH);
+  digitalWrite(MOTOR_IZQ_IN2, LOW);
+  analogWrite(MOTOR_IZQ_ENA, velIzq);
+
+  digitalWrite(MOTOR_DER_IN3, HIGH);
+  digitalWrite(MOTOR_DER_IN4, LOW);
+  analogWrite(MOTOR_DER_ENB, velDer);
+}
+
+static void puenteBanco(int velocidad) {
+  OrdenPuente orden = {1, 1, (uint8_t)velocidad, (uint8_t)velocidad};
+  puenteAplicar(orden);
+}
+
+static void vacio(int) {}
+
+// Ciclos de una llamada: mínimo y media sobre REPETICIONES
+static void medir(const __FlashStringHelper *nombre, void (*funcion)(int), uint16_t base) {
+  uint16_t minimo = 0xFFFF;
+  uint32_t suma = 0;
+  for (uint16_t i = 0; i < REPETICIONES; i++) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t t0 = TCNT1;
+    funcion(velocidadBanco);
+    uint16_t ciclos = TCNT1 - t0 - base;
+    SREG = sreg;
+    if (ciclos < minimo) minimo = ciclos;
+    suma += ciclos;
+  }
+  Serial.print(nombre);
+  Serial.print(F(": min "));
+  Serial.print(minimo);
+  Serial.print(F(" ciclos, media "));
+  Serial.println(suma / REPETICIONES);
+}
+
+void setup() {
+  Serial.begin(9600);
+  parametrosIniciar();  // Factores y velocidades de motores.cpp
+  motoresIniciar();
+
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);  // Sin prescaler: 1 tic = 1 ciclo
+
+  // Coste de la propia medición (llamada indirecta a una función vacía)
+  uint16_t base = 0xFFFF;
+  for (uint8_t i = 0; i < 50; i++) {
+    cli();
+    uint16_t t0 = TCNT1;
+    vacio(velocidadBanco);
+    uint16_t c = TCNT1 - t0;
+    sei();
+    if (c < base) base = c;
+  }
+
+  Serial.println(F("⏱️ Ciclos por orden de motores (16 MHz)"));
+  medir(F("  digitalWrite/analogWrite"), avanzarDigitalWrite, base);
+  medir(F("  puenteAplicar"), puenteBanco, base);
+  medir(F("  avanzarConVelocidad"), avanzarConVelocidad, base);
+  detener();
+}
+
+void loop() {}
@@ -0,0 +1,284 @@
+#include "calibracion.h"
+#include "configuracion.h"
+#include "encoders.h"
+#include "barrido.h"
+#include "odometria.h"
+#include "bateria.h"
+#include "trama_telemetria.h"
+#include "emergencia.h"
+#include <EEPROM.h>
+
+#define CAL_VUELTA_MAX_MS 3000  // Rueda bloqueada: la vuelta se da por hecha
+#define CAL_LECTURA_MAX_MS 100  // Lectura de la pared tomada ya parado
+
+enum FaseCalibracion {
+  CAL_INACTIVA,
+  CAL_PAUSA,      // Parado; al final lee la pared
+  CAL_IDA,
+  CAL_VUELTA,
+  CAL_GUARDANDO
+};
+
+// Imagen tal como va a la EEPROM
+struct ImagenCalibracion {
+  uint8_t version;
+  CurvaMotor curvas[2];
+  uint16_t bateriaMv;  // Tensión durante la medida (0 = sin batería)
+  uint16_t crc;
+};
+
+static uint8_t fase = CAL_INACTIVA;
+static bool trasIda = false;         // La pausa en curso sigue a una ida
+static uint8_t punto = 0;
+static unsigned long inicioFaseMs;
+static unsigned long inicioMedidaMs; // 0 = aún estabilizando
+static float rumboPared;             // Rumbo de partida, de cara a la pared
+static float paredAntesMm;
+static PoseOdometria poseIda;
+static uint32_t inicioUm[2];         // Avance al empezar la ida o la vuelta
+static uint32_t medidaUm[2];         // Avance al empezar a medir
+static uint32_t motorIdaUm;          // Avanzado en la ida con motor
+static uint32_t idaUm;               // Avanzado en la ida con la inercia
+static long ecoMm, odometriaMm;      // Avance total hacia la pared según cada uno
+static ImagenCalibracion imagen;
+static int16_t pendiente = -1;       // Próximo byte a escribir
+
+static uint16_t crcImagen(const ImagenCalibracion &img) {
+  return crc16Ccitt((const uint8_t *)&img, offsetof(ImagenCalibracion, crc));
+}
+
+static bool curvaValida(const CurvaMotor &c) {
+  return c.velocidadMmS[CURVA_PUNTOS - 1] > 0 &&
+         c.zonaMuerta <= CURVA_PWM_MIN + (CURVA_PUNTOS - 1) * CURVA_PWM_PASO;
+}
+
+bool calibracionCargar() {
+  ImagenCalibracion leida;
+  EEPROM.get(CALIBRACION_DIRECCION, leida);
+  if (leida.version != CALIBRACION_VERSION || leida.crc != crcImagen(leida)) return false;
+  if (!curvaValida(leida.curvas[MOTOR_IZQ]) || !curvaValida(leida.curvas[MOTOR_DER])) return false;
+  motoresFijarCurvas(leida.curvas, leida.bateriaMv);
+  return true;
+}
+
+static int pwmPunto(uint8_t i) {
+  return CURVA_PWM_MIN + i * CURVA_PWM_PASO;
+}
+
+static void cambiarFase(uint8_t f) {
+  fase = f;
+  inicioFaseMs = millis();
+}
+
+static void guardarAvance(uint32_t destino[2]) {
+  destino[MOTOR_IZQ] = encoderAvanceUm(ENCODER_IZQ);
+  destino[MOTOR_DER] = encoderAvanceUm(ENCODER_DER);
+}
+
+static uint32_t avanceMedioUm(const uint32_t desde[2]) {
+  return ((encoderAvanceUm(ENCODER_IZQ) - desde[MOTOR_IZQ]) +
+          (encoderAvanceUm(ENCODER_DER) - desde[MOTOR_DER])) / 2;
+}
+
+bool calibracionEmpezar() {
+  if (fase != CAL_INACTIVA) return false;
+  // Una parada de emergencia sin atender deja el avance bloqueado en el
+  // puente y la ida en lazo abierto no arrancaría: se quita aquí, que la
+  // ida ya comprueba la pared antes de cada tramo
+  if (emergenciaPendiente()) {
+    emergenciaAtender();
+    Serial.println(F("cal: parada de emergencia atendida"));
+  }
+  motoresLazoAbierto(0, 0);
+  barridoModo(BARRIDO_APARCADO);
+  punto = 0;
+  trasIda = false;
+  ecoMm = 0;
+  odometriaMm = 0;
+  rumboPared = odometriaPose().rumbo;
+  Serial.println(F("cal: empezando (pared delante)"));
+  cambiarFase(CAL_PAUSA);
+  return true;
+}
+
+bool calibracionActiva() {
+  return fase != CAL_INACTIVA;
+}
+
+static bool abortar(const __FlashStringHelper *motivo) {
+  detener();
+  Serial.print(F("error: cal: "));
+  Serial.println(motivo);
+  fase = CAL_INACTIVA;
+  return true;
+}
+
+// Distancia a la pared en perpendicular: la ida en lazo abierto se curva y
+// el eco llega oblicuo
+static float paredPerpendicularMm(long lecturaCm, const PoseOdometria &pose) {
+  return lecturaCm * 10.0f * cos(pose.rumbo - rumboPared);
+}
+
+// Avance entre dos poses en la dirección de la pared
+static long avanceHaciaParedMm(const PoseOdometria &desde, const PoseOdometria &hasta) {
+  return (long)((hasta.xMm - desde.xMm) * cos(rumboPared) + (hasta.yMm - desde.yMm) * sin(rumboPared));
+}
+
+// Velocidades del punto medido, deriva de rumbo en lazo abierto (°/m,
+// positiva = hacia la izquierda) y avance de la ida hacia la pared según
+// el eco y según la odometría
+static void informarPunto(long ecoIdaMm, long odometriaIdaMm) {
+  int16_t vIzq = imagen.curvas[MOTOR_IZQ].velocidadMmS[punto];
+  int16_t vDer = imagen.curvas[MOTOR_DER].velocidadMmS[punto];
+  long media = ((long)vIzq + vDer) / 2;
+  Serial.print(F("cal: pwm "));
+  Serial.print(pwmPunto(punto));
+  Serial.print(F(" izq "));
+  Serial.print(vIzq);
+  Serial.print(F(" der "));
+  Serial.print(vDer);
+  Serial.print(F(" mm/s deriva "));
+  Serial.print(media > 0 ? (vDer - vIzq) * 57296L / (DISTANCIA_ENTRE_RUEDAS_MM * media) : 0);
+  Serial.print(F(" °/m avance eco "));
+  Serial.print(ecoIdaMm);
+  Serial.print(F(" odometría "));
+  Serial.print(odometriaIdaMm);
+  Serial.println(F(" mm"));
+}
+
+// Zona muerta: corte con v = 0 de la recta por los dos puntos más bajos en
+// los que la rueda se mueve (y sube)
+static bool extrapolarZonaMuerta(CurvaMotor &c) {
+  for (uint8_t i = 0; i + 1 < CURVA_PUNTOS; i++) {
+    int16_t v0 = c.velocidadMmS[i];
+    int16_t v1 = c.velocidadMmS[i + 1];
+    if (v0 <= 0 || v1 <= v0) continue;
+    long zona = pwmPunto(i) - (long)v0 * CURVA_PWM_PASO / (v1 - v0);
+    c.zonaMuerta = (uint8_t)constrain(zona, 0L, (long)pwmPunto(i));
+    return true;
+  }
+  return false;
+}
+
+static bool terminar() {
+  if (!extrapolarZonaMuerta(imagen.curvas[MOTOR_IZQ])) return abortar(F("rueda izquierda sin curva"));
+  if (!extrapolarZonaMuerta(imagen.curvas[MOTOR_DER])) return abortar(F("rueda derecha sin curva"));
+
+  Serial.print(F("cal: zona muerta izq "));
+  Serial.print(imagen.curvas[MOTOR_IZQ].zonaMuerta);
+  Serial.print(F(" der "));
+  Serial.print(imagen.curvas[MOTOR_DER].zonaMuerta);
+  Serial.print(F(", eco/odometría "));
+  Serial.println(odometriaMm > 0 ? (float)ecoMm / odometriaMm : 0.0f, 2);
+
+  // La de las idas con los motores tirando, que es con la que se compara
+  imagen.bateriaMv = bateriaCargaMilivoltios();
+  motoresFijarCurvas(imagen.curvas, imagen.bateriaMv);
+  imagen.version = CALIBRACION_VERSION;
+  imagen.crc = crcImagen(imagen);
+  pendiente = 0;
+  cambiarFase(CAL_GUARDANDO);
+  return false;
+}
+
+// Un byte cambiado por llamada, como parametrosActualizar()
+static bool guardar() {
+  const uint8_t *datos = (const uint8_t *)&imagen;
+  while (pendiente < (int16_t)sizeof(imagen)) {
+    int direccion = CALIBRACION_DIRECCION + pendiente;
+    uint8_t b = datos[pendiente++];
+    if (EEPROM.read(direccion) != b) {
+      EEPROM.write(direccion, b);
+      return false;
+    }
+  }
+  pendiente = -1;
+  Serial.println(F("ok: cal guardada en EEPROM"));
+  fase = CAL_INACTIVA;
+  return true;
+}
+
+// La pared se lee con las ruedas paradas y una lectura a 90° posterior
+// (sin el filtro frontal, que aún arrastra la velocidad de la ida)
+static bool pasoPausa() {
+  if (millis() - inicioFaseMs < CAL_PAUSA_MS || barridoEscaneando()) return false;
+  if (encoderVelocidadMmS(ENCODER_IZQ) != 0 || encoderVelocidadMmS(ENCODER_DER) != 0) return false;
+  long pared = barridoDistancia(90, CAL_LECTURA_MAX_MS);
+  if (pared < 0) return false;
+  PoseOdometria pose = odometriaPose();
+  float paredMm = paredPerpendicularMm(pared, pose);
+
+  if (trasIda) {
+    idaUm = avanceMedioUm(inicioUm);
+    long ecoIdaMm = (long)(paredAntesMm - paredMm);
+    long odometriaIdaMm = avanceHaciaParedMm(poseIda, pose);
+    ecoMm += ecoIdaMm;
+    odometriaMm += odometriaIdaMm;
+    informarPunto(ecoIdaMm, odometriaIdaMm);
+    trasIda = false;
+    guardarAvance(inicioUm);
+    motoresLazoAbierto(-pwmPunto(punto), -pwmPunto(punto));
+    cambiarFase(CAL_VUELTA);
+    return false;
+  }
+
+  if (punto >= CURVA_PUNTOS) return terminar();
+  if (pared < CAL_PISTA_MIN_CM) return abortar(F("sin pista (pared a menos de 100 cm)"));
+  paredAntesMm = paredMm;
+  poseIda = pose;
+  guardarAvance(inicioUm);
+  inicioMedidaMs = 0;
+  motoresLazoAbierto(pwmPunto(punto), pwmPunto(punto));
+  cambiarFase(CAL_IDA);
+  return false;
+}
+
+static bool pasoIda() {
+  unsigned long ahora = millis();
+  if (barridoFrontal() < CAL_DISTANCIA_MIN_CM) return abortar(F("pared demasiado cerca"));
+
+  if (inicioMedidaMs == 0) {
+    if (ahora - inicioFaseMs < CAL_ASENTAMIENTO_MS) return false;
+    inicioMedidaMs = ahora;
+    guardarAvance(medidaUm);
+    return false;
+  }
+  unsigned long medidaMs = ahora - inicioMedidaMs;
+  if (medidaMs < CAL_MEDIDA_MS) return false;
+
+  for (uint8_t m = MOTOR_IZQ; m <= MOTOR_DER; m++) {
+    uint32_t um = encoderAvanceUm(m == MOTOR_IZQ ? ENCODER_IZQ : ENCODER_DER) - medidaUm[m];
+    imagen.curvas[m].velocidadMmS[punto] = (int16_t)(um / medidaMs);  // µm/ms = mm/s
+  }
+  motorIdaUm = avanceMedioUm(inicioUm);
+  motoresLazoAbierto(0, 0);
+  trasIda = true;
+  cambiarFase(CAL_PAUSA);
+  return false;
+}
+
+// Se corta antes lo mismo que siguió la ida por inercia
+static bool pasoVuelta() {
+  uint32_t inercia = idaUm > motorIdaUm ? idaUm - motorIdaUm : 0;
+  if (avanceMedioUm(inicioUm) + inercia < idaUm && millis() - inicioFaseMs < CAL_VUELTA_MAX_MS) {
+    return false;
+  }
+  motoresLazoAbierto(0, 0);
+  punto++;
+  cambiarFase(CAL_PAUSA);
+  return false;
+}
+
+bool calibracionPaso() {
+  switch (fase) {
+    case CAL_PAUSA:
+      return pasoPausa();
+    case CAL_IDA:
+      return pasoIda();
+    case CAL_VUELTA:
+      return pasoVuelta();
+    case CAL_GUARDANDO:
+      return guardar();
+  }
+  return false;
+}
@@ -0,0 +1,226 @@
+#include "consola.h"
+#include "parametros.h"
+#include "calibracion.h"
+#include "perfil.h"
+#include "emergencia.h"
+
+enum Respuesta {
+  RESP_NINGUNA,
+  RESP_VALOR,        // nombre=valor del parámetro
+  RESP_RANGO,        // Valor fuera de rango o no numérico
+  RESP_PAREJA,       // En rango, pero incumple una pareja (parametros.h)
+  RESP_DESCONOCIDO,
+  RESP_ORDEN,        // Orden no reconocida o línea demasiado larga
+  RESP_GUARDANDO,    // save con un guardado en curso
+  RESP_CALIBRANDO,   // cal con la calibración en marcha
+  RESP_SIN_PERFIL,   // perfil compilado sin PERFILADO
+  RESP_PERFIL_BORRADO,
+  RESP_EMERGENCIA,   // Paradas de emergencia y peor latencia
+  RESP_GUARDADO
+};
+
+static char linea[CONSOLA_LINEA + 1];
+static uint8_t largo = 0;
+static bool desbordada = false;
+static uint8_t respuesta = RESP_NINGUNA;
+static uint8_t idRespuesta = 0;
+static int8_t listando = -1;           // Próximo parámetro del listado
+static int8_t perfilando = -1;         // Próxima línea del volcado (serie * 2 + parte)
+
+void consolaIniciar() {
+  largo = 0;
+  desbordada = false;
+  respuesta = RESP_NINGUNA;
+  listando = -1;
+  perfilando = -1;
+}
+
+static void responder(uint8_t r, uint8_t id = 0) {
+  respuesta = r;
+  idRespuesta = id;
+}
+
+// Interpreta la línea completa y deja preparada la respuesta
+static void ejecutar() {
+  linea[largo] = '\0';
+  char *orden = strtok(linea, " ");
+  char *nombre = strtok(nullptr, " ");
+  char *valor = strtok(nullptr, " ");
+
+  if (orden == nullptr) return;  // Línea vacía
+  if (strcmp_P(orden, PSTR("list")) == 0) {
+    listando = 0;
+    return;
+  }
+  if (strcmp_P(orden, PSTR("perfil")) == 0) {
+#if PERFILADO
+    if (nombre != nullptr && strcmp_P(nombre, PSTR("borrar")) == 0) {
+      perfilIniciar();
+      responder(RESP_PERFIL_BORRADO);
+    } else {
+      perfilando = 0;
+    }
+#else
+    responder(RESP_SIN_PERFIL);
+#endif
+    return;
+  }
+  if (strcmp_P(orden, PSTR("emerg")) == 0) {
+    responder(RESP_EMERGENCIA);
+    return;
+  }
+  if (strcmp_P(orden, PSTR("cal")) == 0) {
+    if (!calibracionEmpezar()) responder(RESP_CALIBRANDO);
+    return;
+  }
+  if (strcmp_P(orden, PSTR("save")) == 0) {
+    if (parametrosGuardando()) {
+      responder(RESP_GUARDANDO);
+    } else {
+      parametrosGuardar();
+    }
+    return;
+  }
+
+  bool get = strcmp_P(orden, PSTR("get")) == 0 && nombre != nullptr;
+  bool set = strcmp_P(orden, PSTR("set")) == 0 && nombre != nullptr && valor != nullptr;
+  if (!get && !set) {
+    responder(RESP_ORDEN);
+    return;
+  }
+  int8_t id = parametroBuscar(nombre);
+  if (id < 0) {
+    responder(RESP_DESCONOCIDO);
+    return;
+  }
+  if (set) {
+    char *fin;
+    long v = strtol(valor, &fin, 10);
+    if (*fin != '\0' || v < INT16_MIN || v > INT16_MAX) {
+      responder(RESP_RANGO, id);
+      return;
+    }
+    if (!parametroFijar(id, (int16_t)v)) {
+      int8_t pareja = parametrosParejaIncumplida(parametros, id, (int16_t)v);
+      if (pareja >= 0) {
+        responder(RESP_PAREJA, pareja);
+      } else {
+        responder(RESP_RANGO, id);
+      }
+      return;
+    }
+  }
+  responder(RESP_VALOR, id);
+}
+
+static void imprimirValor(uint8_t id) {
+  Serial.print(parametroNombre(id));
+  Serial.print('=');
+  Serial.print(parametros[id]);
+}
+
+static void imprimirRango(uint8_t id) {
+  Serial.print(F(" ["));
+  Serial.print(parametroMinimo(id));
+  Serial.print(F(".."));
+  Serial.print(parametroMaximo(id));
+  Serial.print(']');
+}
+
+// Cada línea, con el \r\n, cabe en CONSOLA_HUECO_RESPUESTA: más larga,
+// println() esperaría a que se vacíe la UART
+static void escribirRespuesta() {
+  switch (respuesta) {
+    case RESP_VALOR:
+      imprimirValor(idRespuesta);
+      Serial.println();
+      break;
+    case RESP_RANGO:
+      Serial.print(F("error: "));
+      Serial.print(parametroNombre(idRespuesta));
+      imprimirRango(idRespuesta);
+      Serial.println();
+      break;
+    case RESP_PAREJA: {
+      // "error: emergencia_cm >= distancia_critica": lo que no puede ser
+      ParejaParametros p = parametrosPareja(idRespuesta);
+      Serial.print(F("error: "));
+      Serial.print(parametroNombre(p.menor));
+      Serial.print(p.estricta ? F(" >= ") : F(" > "));
+      Serial.println(parametroNombre(p.mayor));
+      break;
+    }
+    case RESP_DESCONOCIDO:
+      Serial.println(F("error: parámetro desconocido (list)"));
+      break;
+    case RESP_ORDEN:
+      Serial.println(F("error: usa list get set save cal perfil emerg"));
+      break;
+    case RESP_GUARDANDO:
+      Serial.println(F("error: ya se está guardando"));
+      break;
+    case RESP_CALIBRANDO:
+      Serial.println(F("error: cal en marcha"));
+      break;
+    case RESP_SIN_PERFIL:
+      Serial.println(F("error: compilado sin PERFILADO"));
+      break;
+    case RESP_PERFIL_BORRADO:
+      Serial.println(F("ok: perfil borrado"));
+      break;
+    case RESP_EMERGENCIA:
+      Serial.print(F("emerg: "));
+      Serial.print(emergenciaParadas());
+      Serial.print(F(" paradas, peor "));
+      Serial.print(emergenciaLatenciaMaxUs());
+      Serial.println(F(" us"));
+      break;
+    case RESP_GUARDADO:
+      Serial.println(F("ok: guardado en EEPROM"));
+      break;
+  }
+  respuesta = RESP_NINGUNA;
+}
+
+void consolaActualizar() {
+  if (parametrosActualizar()) responder(RESP_GUARDADO);
+
+  // Primero lo pendiente de escribir, si cabe
+  if (respuesta != RESP_NINGUNA || listando >= 0 || perfilando >= 0) {
+    if (Serial.availableForWrite() < CONSOLA_HUECO_RESPUESTA) return;
+    if (respuesta != RESP_NINGUNA) {
+      escribirRespuesta();
+    } else if (listando >= 0) {
+      imprimirValor(listando);
+      imprimirRango(listando);
+      Serial.println();
+      if (++listando >= PARAMETROS) listando = -1;
+    } else {
+#if PERFILADO
+      perfilImprimir(perfilando / 2, perfilando % 2);
+      if (++perfilando >= SERIES_PERFIL * 2) perfilando = -1;
+#endif
+    }
+    return;
+  }
+
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    if (c == '\r') continue;
+    if (c == '\n') {
+      if (desbordada) {
+        responder(RESP_ORDEN);
+      } else {
+        ejecutar();
+      }
+      largo = 0;
+      desbordada = false;
+      return;  // Una orden por llamada
+    }
+    if (largo < CONSOLA_LINEA) {
+      linea[largo++] = c;
+    } else {
+      desbordada = true;
+    }
+  }
+}
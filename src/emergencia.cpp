@@ -0,0 +1,103 @@
+#include "emergencia.h"
+#include "ultrasonido.h"
+#include "puente_l298n.h"
+#include "parametros.h"
+
+static volatile bool armada = false;
+static volatile uint16_t umbralUs = 0;      // emergencia_cm en ancho de eco
+static volatile uint8_t vigilados = 0;      // Un bit por canal
+static volatile unsigned long vigiladoDesdeMs[ULTRASONIDO_CANALES];
+
+static volatile bool pendiente = false;
+static volatile uint16_t distanciaCm = 0;
+static volatile unsigned long latenciaUs = 0;
+static volatile unsigned long latenciaMaxUs = 0;
+static volatile uint16_t paradas = 0;
+
+void emergenciaIniciar() {
+  noInterrupts();
+  armada = false;
+  pendiente = false;
+  distanciaCm = 0;
+  latenciaUs = 0;
+  latenciaMaxUs = 0;
+  paradas = 0;
+  interrupts();
+}
+
+// El umbral se recalcula en cada orden: un cambio por consola vale para
+// la siguiente
+void emergenciaArmar(bool avanzando) {
+  // Inversa de ultrasonidoACm(): 17 cm por ms de eco
+  uint16_t umbral = (uint16_t)(((uint32_t)parametros[PARAM_EMERGENCIA_CM] * 1000UL + 16) / 17);
+  noInterrupts();
+  umbralUs = umbral;
+  armada = avanzando && umbral > 0;
+  interrupts();
+}
+
+void emergenciaVigilar(uint8_t canal, bool frente, unsigned long desdeMs) {
+  if (canal >= ULTRASONIDO_CANALES) return;
+  noInterrupts();
+  if (frente) {
+    vigilados |= 1 << canal;
+  } else {
+    vigilados &= ~(1 << canal);
+  }
+  vigiladoDesdeMs[canal] = desdeMs;
+  interrupts();
+}
+
+// En el ISR: lo primero es el puente; las cuentas, después
+void emergenciaEco(uint8_t canal, unsigned long anchoUs, unsigned long disparoMs,
+                   unsigned long flancoUs) {
+  if (!armada || pendiente || anchoUs == 0 || anchoUs >= umbralUs) return;
+  if (!(vigilados & (1 << canal)) || (long)(disparoMs - vigiladoDesdeMs[canal]) < 0) return;
+
+  puenteBloquearAvance(255);
+  unsigned long latencia = micros() - flancoUs;
+  pendiente = true;
+  distanciaCm = (uint16_t)ultrasonidoACm(anchoUs);
+  latenciaUs = latencia;
+  if (latencia > latenciaMaxUs) latenciaMaxUs = latencia;
+  paradas = paradas + 1;
+}
+
+bool emergenciaPendiente() {
+  return pendiente;
+}
+
+void emergenciaAtender() {
+  noInterrupts();
+  pendiente = false;
+  puenteDesbloquearAvance();
+  interrupts();
+}
+
+uint16_t emergenciaDistanciaCm() {
+  noInterrupts();
+  uint16_t cm = distanciaCm;
+  interrupts();
+  return cm;
+}
+
+unsigned long emergenciaLatenciaUs() {
+  noInterrupts();
+  unsigned long us = latenciaUs;
+  interrupts();
+  return us;
+}
+
+unsigned long emergenciaLatenciaMaxUs() {
+  noInterrupts();
+  unsigned long us = latenciaMaxUs;
+  interrupts();
+  return us;
+}
+
+uint16_t emergenciaParadas() {
+  noInterrupts();
+  uint16_t n = paradas;
+  interrupts();
+  return n;
+}
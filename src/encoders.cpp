@@ -0,0 +1,97 @@
+#include "encoders.h"
+#include "traza.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+struct EstadoEncoder {
+  uint32_t pulsos;
+  unsigned long ultimoUs;
+  unsigned long periodoUs;  // Entre los dos últimos flancos (0 = aún no hay)
+};
+
+static volatile EstadoEncoder encoders[2];
+
+#if defined(__AVR__)
+static volatile uint8_t *registroEnc;
+static uint8_t mascaras[2];
+static uint8_t anterior;
+
+// A0 y A1 están en el puerto C: vector PCINT1.
+// Si se mueven los encoders a otro puerto hay que cambiar el vector.
+ISR(PCINT1_vect) {
+  unsigned long us = micros();
+  uint8_t nivel = *registroEnc;
+  uint8_t subidas = nivel & ~anterior;
+  anterior = nivel;
+  if (subidas & mascaras[ENCODER_IZQ]) encoderPulso(ENCODER_IZQ, us);
+  if (subidas & mascaras[ENCODER_DER]) encoderPulso(ENCODER_DER, us);
+}
+#endif
+
+void encodersIniciar() {
+  pinMode(ENCODER_IZQ_PIN, INPUT_PULLUP);
+  pinMode(ENCODER_DER_PIN, INPUT_PULLUP);
+
+  noInterrupts();
+  for (uint8_t i = 0; i < 2; i++) {
+    encoders[i].pulsos = 0;
+    encoders[i].ultimoUs = 0;
+    encoders[i].periodoUs = 0;
+  }
+  interrupts();
+
+#if defined(__AVR__)
+  registroEnc = portInputRegister(digitalPinToPort(ENCODER_IZQ_PIN));
+  mascaras[ENCODER_IZQ] = digitalPinToBitMask(ENCODER_IZQ_PIN);
+  mascaras[ENCODER_DER] = digitalPinToBitMask(ENCODER_DER_PIN);
+  anterior = *registroEnc;
+  *digitalPinToPCMSK(ENCODER_IZQ_PIN) |= _BV(digitalPinToPCMSKbit(ENCODER_IZQ_PIN));
+  *digitalPinToPCMSK(ENCODER_DER_PIN) |= _BV(digitalPinToPCMSKbit(ENCODER_DER_PIN));
+  *digitalPinToPCICR(ENCODER_IZQ_PIN) |= _BV(digitalPinToPCICRbit(ENCODER_IZQ_PIN));
+#endif
+}
+
+void encoderPulso(uint8_t rueda, unsigned long us) {
+  volatile EstadoEncoder &e = encoders[rueda];
+  // Tras una parada el primer periodo no es válido
+  e.periodoUs = e.pulsos > 0 && us - e.ultimoUs < ENCODER_PARADO_US ? us - e.ultimoUs : 0;
+  e.ultimoUs = us;
+  e.pulsos = e.pulsos + 1;
+  TRAZA_PULSO(rueda, us);
+}
+
+uint32_t encoderPulsos(uint8_t rueda) {
+  noInterrupts();
+  uint32_t n = encoders[rueda].pulsos;
+  interrupts();
+  return n;
+}
+
+int16_t encoderVelocidadMmS(uint8_t rueda) {
+  noInterrupts();
+  unsigned long ultimo = encoders[rueda].ultimoUs;
+  unsigned long periodo = encoders[rueda].periodoUs;
+  interrupts();
+
+  unsigned long desdeUltimo = micros() - ultimo;
+  if (periodo == 0 || desdeUltimo > ENCODER_PARADO_US) return 0;
+  if (desdeUltimo > periodo) periodo = desdeUltimo;
+  return (int16_t)(ENCODER_UM_POR_PULSO * 1000UL / periodo);
+}
+
+uint32_t encoderAvanceUm(uint8_t rueda) {
+  noInterrupts();
+  uint32_t pulsos = encoders[rueda].pulsos;
+  unsigned long ultimo = encoders[rueda].ultimoUs;
+  unsigned long periodo = encoders[rueda].periodoUs;
+  interrupts();
+
+  uint32_t avance = pulsos * ENCODER_UM_POR_PULSO;
+  unsigned long desdeUltimo = micros() - ultimo;
+  if (periodo == 0 || desdeUltimo > ENCODER_PARADO_US) return avance;
+  // Fracción en 1/256 de pulso, como máximo 7/8
+  uint32_t fraccion = min((uint32_t)(desdeUltimo * 256UL / periodo), 224UL);
+  return avance + (ENCODER_UM_POR_PULSO * fraccion >> 8);
+}
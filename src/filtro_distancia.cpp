@@ -0,0 +1,138 @@
+#include "filtro_distancia.h"
+#include "ultrasonido.h"
+
+// Ruido del modelo: aceleración relativa (robot + obstáculo) y medida
+#define FILTRO_ACEL_CM_S2 150L
+#define FILTRO_RUIDO_MEDIDA_Q4 (4L * 16)
+#define FILTRO_P_RANGO_INICIAL_Q4 (16L * 16)
+#define FILTRO_P_VEL_INICIAL_Q4 (2500L * 16)  // (50 cm/s)^2: la velocidad no se conoce
+#define FILTRO_VEL_MAX_Q8 (300L * 256)
+
+// Topes que dejan todos los productos en 32 bits. Cubren 4 s sin medida
+// (un escaneo largo); más allá la ganancia es la de 4 s, ya casi saturada
+#define FILTRO_DT_MAX_MS 4000UL
+#define FILTRO_P_RANGO_MAX_Q4 ((int32_t)30000000)
+#define FILTRO_P_CRUZADA_MAX_Q4 ((int32_t)16000000)
+#define FILTRO_P_VEL_MAX_Q4 ((int32_t)8000000)
+#define FILTRO_K1_MAX_Q8 ((int32_t)65535)  // Defensivo: con P definida no se llega
+
+// x * ms / 1000 sin desbordar (ms hasta unos 2000 s)
+static int32_t porMs(int32_t x, uint32_t ms) {
+  return x / 1000 * (int32_t)ms + x % 1000 * (int32_t)ms / 1000;
+}
+
+void filtroDistanciaIniciar(FiltroDistancia &f) {
+  f.llenas = 0;
+  f.indice = 0;
+  f.rangoQ8 = (int32_t)FILTRO_SIN_ECO_CM << 8;
+  f.velocidadQ8 = 0;
+  f.p00Q4 = FILTRO_P_RANGO_INICIAL_Q4;
+  f.p01Q4 = 0;
+  f.p11Q4 = FILTRO_P_VEL_INICIAL_Q4;
+  f.ultimoMs = 0;
+  f.ultimoEcoMs = 0;
+  f.siguiendo = false;
+  f.eco = false;
+  f.sinEco = 0;
+}
+
+// Con menos de 3 lecturas se toma la menor (lo prudente para frenar)
+static int16_t mediana(const FiltroDistancia &f) {
+  const int16_t *v = f.ventana;
+  if (f.llenas == 1) return v[(f.indice + 2) % 3];
+  if (f.llenas == 2) return min(v[(f.indice + 1) % 3], v[(f.indice + 2) % 3]);
+  return max(min(v[0], v[1]), min(max(v[0], v[1]), v[2]));
+}
+
+static void predecir(FiltroDistancia &f, unsigned long tiempoMs) {
+  unsigned long dt = (long)(tiempoMs - f.ultimoMs) > 0 ? tiempoMs - f.ultimoMs : 0;
+  f.ultimoMs = tiempoMs;
+  if (dt == 0) return;
+
+  f.rangoQ8 += porMs(f.velocidadQ8, dt);
+  if (f.rangoQ8 < 0) f.rangoQ8 = 0;
+
+  // P = F P F' + Q con aceleración blanca (q dt^n encadenando dt)
+  if (dt > FILTRO_DT_MAX_MS) dt = FILTRO_DT_MAX_MS;
+  int32_t qDt2 = porMs(porMs((int32_t)(FILTRO_ACEL_CM_S2 * FILTRO_ACEL_CM_S2 * 16), dt), dt);
+  int32_t qDt3 = porMs(qDt2, dt);
+  int32_t qDt4 = porMs(qDt3, dt);
+  int32_t p11Dt = porMs(f.p11Q4, dt);
+  f.p00Q4 = min(f.p00Q4 + porMs(2 * f.p01Q4 + p11Dt, dt) + qDt4 / 4, FILTRO_P_RANGO_MAX_Q4);
+  f.p01Q4 = constrain(f.p01Q4 + p11Dt + qDt3 / 2, -FILTRO_P_CRUZADA_MAX_Q4, FILTRO_P_CRUZADA_MAX_Q4);
+  f.p11Q4 = min(f.p11Q4 + qDt2, FILTRO_P_VEL_MAX_Q4);
+}
+
+static void nuevoObjetivo(FiltroDistancia &f, int16_t z) {
+  f.rangoQ8 = (int32_t)z << 8;
+  f.velocidadQ8 = 0;
+  f.p00Q4 = FILTRO_P_RANGO_INICIAL_Q4;
+  f.p01Q4 = 0;
+  f.p11Q4 = FILTRO_P_VEL_INICIAL_Q4;
+  f.siguiendo = true;
+}
+
+static void soltarObjetivo(FiltroDistancia &f) {
+  f.siguiendo = false;
+  f.llenas = 0;
+}
+
+void filtroDistanciaMedida(FiltroDistancia &f, unsigned long anchoUs, unsigned long tiempoMs) {
+  long cm = ultrasonidoACm(anchoUs);
+  f.eco = cm > 0 && cm <= FILTRO_SIN_ECO_CM;
+
+  if (f.siguiendo) predecir(f, tiempoMs);
+  f.ultimoMs = tiempoMs;
+
+  if (!f.eco) {
+    if (f.sinEco < 255) f.sinEco++;
+    if (f.siguiendo && (f.rangoQ8 > (int32_t)FILTRO_ALCANCE_SEGUIMIENTO_CM << 8 ||
+                        tiempoMs - f.ultimoEcoMs > FILTRO_SIN_ECO_MAX_MS)) {
+      soltarObjetivo(f);
+    }
+    return;
+  }
+
+  f.sinEco = 0;
+  f.ultimoEcoMs = tiempoMs;
+  f.ventana[f.indice] = (int16_t)cm;
+  f.indice = (f.indice + 1) % 3;
+  if (f.llenas < 3) f.llenas++;
+  int16_t z = mediana(f);
+  int32_t y = ((int32_t)z << 8) - f.rangoQ8;
+
+  if (!f.siguiendo || abs(y) > (int32_t)FILTRO_SALTO_CM << 8) {
+    nuevoObjetivo(f, z);
+    return;
+  }
+
+  // Actualización con la mediana: k0 = p00 / s = 1 - R / s, k1 = p01 / s
+  int32_t s = f.p00Q4 + FILTRO_RUIDO_MEDIDA_Q4;
+  int32_t k0Q12 = 4096 - (FILTRO_RUIDO_MEDIDA_Q4 << 12) / s;
+  int32_t k1Q8 = s < 0x10000 ? f.p01Q4 * 256 / s : f.p01Q4 / (s >> 8);
+  k1Q8 = constrain(k1Q8, -FILTRO_K1_MAX_Q8, FILTRO_K1_MAX_Q8);
+  f.rangoQ8 += k0Q12 * y >> 12;
+  f.velocidadQ8 = constrain(f.velocidadQ8 + (k1Q8 * y >> 8), -FILTRO_VEL_MAX_Q8, FILTRO_VEL_MAX_Q8);
+  // p11 - p01²/s es resta de dos valores casi iguales tras un hueco largo:
+  // con k1 en Q8 se perdería, así que va con un producto de 64 bits
+  f.p11Q4 -= (int32_t)((int64_t)f.p01Q4 * f.p01Q4 / s);
+  f.p01Q4 = f.p01Q4 * FILTRO_RUIDO_MEDIDA_Q4 / s;
+  f.p00Q4 = f.p00Q4 * FILTRO_RUIDO_MEDIDA_Q4 / s;
+}
+
+EstimacionDistancia filtroDistanciaEstimar(const FiltroDistancia &f, unsigned long ahoraMs) {
+  EstimacionDistancia e;
+  e.eco = f.eco;
+  e.siguiendo = f.siguiendo;
+  e.sinEco = f.sinEco;
+  if (!f.siguiendo) {
+    e.distanciaCm = FILTRO_SIN_ECO_CM;
+    e.velocidadCmS = 0;
+    return e;
+  }
+  unsigned long dt = (long)(ahoraMs - f.ultimoMs) > 0 ? ahoraMs - f.ultimoMs : 0;
+  int32_t rangoQ8 = f.rangoQ8 + porMs(f.velocidadQ8, dt);
+  e.distanciaCm = rangoQ8 > 0 ? (rangoQ8 + 128) >> 8 : 0;
+  e.velocidadCmS = (int)(f.velocidadQ8 / 256);
+  return e;
+}
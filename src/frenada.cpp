@@ -0,0 +1,136 @@
+#include "frenada.h"
+#include "motores.h"
+#include "encoders.h"
+#include "parametros.h"
+
+static int16_t distanciaQ4[FRENADA_PUNTOS];  // mm * 16 en cada punto
+static uint8_t medidasPunto[FRENADA_PUNTOS];
+static uint16_t medidas = 0;
+
+// Frenada en curso
+static bool midiendo = false;
+static int16_t velocidadInicioMmS;
+static uint32_t pulsosInicio;
+static uint32_t pulsosUltimos;
+static unsigned long ultimoPulsoMs;
+
+static int16_t velocidadPunto(uint8_t i) {
+  return (i + 1) * FRENADA_PASO_MM_S;
+}
+
+// Pulsos enteros: encoderAvanceUm() interpola en marcha pero no al parar,
+// y la diferencia saldría corta en casi medio pulso
+static uint32_t pulsosAmbas() {
+  return encoderPulsos(ENCODER_IZQ) + encoderPulsos(ENCODER_DER);
+}
+
+void frenadaIniciar() {
+  // El corto a duty d frena d/tau_freno más que el rozamiento solo
+  int32_t duty = parametros[PARAM_FRENO_PWM];
+  int32_t tauMs = 255L * FRENADA_TAU_FRENO_MS * FRENADA_TAU_LIBRE_MS /
+                  (duty * FRENADA_TAU_LIBRE_MS + (255 - duty) * FRENADA_TAU_FRENO_MS);
+  for (uint8_t i = 0; i < FRENADA_PUNTOS; i++) {
+    distanciaQ4[i] = (int16_t)(velocidadPunto(i) * tauMs * 16 / 1000);
+    medidasPunto[i] = 0;
+  }
+  medidas = 0;
+  midiendo = false;
+}
+
+// Los puntos sin medidas, con el tiempo de frenada del medido más cercano
+static void rellenar() {
+  for (uint8_t j = 0; j < FRENADA_PUNTOS; j++) {
+    if (medidasPunto[j] > 0) continue;
+    int8_t cercano = -1;
+    for (uint8_t k = 0; k < FRENADA_PUNTOS; k++) {
+      if (medidasPunto[k] > 0 && (cercano < 0 || abs(k - j) < abs(cercano - j))) cercano = k;
+    }
+    if (cercano < 0) return;
+    distanciaQ4[j] = (int16_t)((int32_t)distanciaQ4[cercano] * velocidadPunto(j) / velocidadPunto(cercano));
+  }
+}
+
+// La medida va al punto más cercano, escalada a su velocidad
+static void anotar(int16_t velocidadMmS, int32_t distanciaMm) {
+  uint8_t i = (uint8_t)constrain((velocidadMmS + FRENADA_PASO_MM_S / 2) / FRENADA_PASO_MM_S, 1,
+                                 FRENADA_PUNTOS) - 1;
+  int32_t escaladaQ4 = distanciaMm * 16 * velocidadPunto(i) / velocidadMmS;
+  if (medidasPunto[i] == 0) {
+    distanciaQ4[i] = (int16_t)constrain(escaladaQ4, 0L, 32767L);
+  } else {
+    distanciaQ4[i] += (int16_t)((escaladaQ4 - distanciaQ4[i]) / FRENADA_PESO);
+  }
+  if (medidasPunto[i] < 255) medidasPunto[i]++;
+  medidas++;
+  rellenar();
+}
+
+void frenadaEmpezar() {
+  if (midiendo) return;
+  int16_t izq = encoderVelocidadMmS(ENCODER_IZQ);
+  int16_t der = encoderVelocidadMmS(ENCODER_DER);
+  if (min(izq, der) < FRENADA_VEL_MIN_MM_S) return;
+  midiendo = true;
+  velocidadInicioMmS = (izq + der) / 2;
+  pulsosInicio = pulsosAmbas();
+  pulsosUltimos = pulsosInicio;
+  ultimoPulsoMs = millis();
+}
+
+void frenadaTerminar() {
+  if (!midiendo) return;
+  midiendo = false;
+  // Otra orden con las ruedas aún rápidas: la frenada no llegó a acabar
+  if (!motoresParados()) return;
+  anotar(velocidadInicioMmS, (int32_t)((pulsosAmbas() - pulsosInicio) * ENCODER_UM_POR_PULSO / 2000));
+}
+
+// Con velocidad 0 en los encoders aún puede llegar algún pulso suelto (la
+// cola en rueda libre es larga): se espera a que no llegue ninguno
+void frenadaActualizar() {
+  if (!midiendo) return;
+  uint32_t pulsos = pulsosAmbas();
+  if (pulsos != pulsosUltimos) {
+    pulsosUltimos = pulsos;
+    ultimoPulsoMs = millis();
+  } else if (millis() - ultimoPulsoMs >= FRENADA_QUIETO_MS) {
+    frenadaTerminar();
+  }
+}
+
+int16_t frenadaDistanciaMm(int16_t velocidadMmS) {
+  if (velocidadMmS <= 0) return 0;
+  int32_t vAnterior = 0, dAnterior = 0;
+  for (uint8_t i = 0; i < FRENADA_PUNTOS; i++) {
+    int32_t v = velocidadPunto(i), d = distanciaQ4[i];
+    if (velocidadMmS <= v) {
+      return (int16_t)((dAnterior + (d - dAnterior) * (velocidadMmS - vAnterior) / (v - vAnterior)) / 16);
+    }
+    vAnterior = v;
+    dAnterior = d;
+  }
+  // Más allá del último punto, proporcional a la velocidad
+  return (int16_t)(dAnterior * velocidadMmS / vAnterior / 16);
+}
+
+// f(v) = v * latencia + frenada(v) es lineal entre puntos: se busca el
+// tramo que cruza el hueco (el primero, si las medidas no son monótonas)
+int16_t frenadaVelocidadMaxMmS(int32_t huecoMm, uint16_t latenciaMs) {
+  if (huecoMm <= 0) return 0;
+  int32_t huecoQ4 = huecoMm * 16;
+  int32_t vAnterior = 0, fAnterior = 0;
+  for (uint8_t i = 0; i < FRENADA_PUNTOS; i++) {
+    int32_t v = velocidadPunto(i);
+    int32_t f = v * latenciaMs * 16 / 1000 + distanciaQ4[i];
+    if (f >= huecoQ4) {
+      return (int16_t)(vAnterior + (v - vAnterior) * (huecoQ4 - fAnterior) / (f - fAnterior));
+    }
+    vAnterior = v;
+    fAnterior = f;
+  }
+  return (int16_t)min(vAnterior * huecoQ4 / fAnterior, 32767L);
+}
+
+uint16_t frenadaMedidas() {
+  return medidas;
+}
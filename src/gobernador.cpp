@@ -0,0 +1,60 @@
+#include "gobernador.h"
+#include "configuracion.h"
+#include "motores.h"
+#include "parametros.h"
+#include "encoders.h"
+#include "frenada.h"
+
+static int velocidad = VELOCIDAD_MINIMA;
+static unsigned long ultimoMs = 0;
+
+void gobernadorIniciar() {
+  velocidad = parametros[PARAM_VELOCIDAD_MINIMA];
+  ultimoMs = millis();
+}
+
+// Avance medido por los encoders (cm/s, con signo)
+static int velocidadPropiaCmS() {
+  int izq = encoderVelocidadMmS(ENCODER_IZQ) * motoresSentido(MOTOR_IZQ);
+  int der = encoderVelocidadMmS(ENCODER_DER) * motoresSentido(MOTOR_DER);
+  return (izq + der) / 20;
+}
+
+int gobernadorCierreCmS(const EstimacionDistancia &frente) {
+  // Sin objetivo seguido el filtro no tiene velocidad: vale la propia
+  int propia = velocidadPropiaCmS();
+  return frente.siguiendo ? max(-frente.velocidadCmS, propia) : propia;
+}
+
+int gobernadorLimite(const EstimacionDistancia &frente) {
+  long hueco = frente.distanciaCm - parametros[PARAM_DISTANCIA_CRITICA];
+  if (hueco <= 0) return parametros[PARAM_VELOCIDAD_MINIMA];
+
+  // Parte de la velocidad de cierre que no es del robot
+  int obstaculo = max(gobernadorCierreCmS(frente) - velocidadPropiaCmS(), 0);
+
+  long frenadaCmS = frenadaVelocidadMaxMmS(hueco * 10, GOBERNADOR_LATENCIA_MS) / 10;
+  long ttcCmS = hueco * 1000L / parametros[PARAM_TTC_MINIMO_MS] - obstaculo;
+  long seguraCmS = min(frenadaCmS, ttcCmS);
+
+  // cm/s -> escala PWM
+  long pwm = seguraCmS * 10L * 256L / MM_S_POR_PWM_Q8;
+  return (int)constrain(pwm, (long)parametros[PARAM_VELOCIDAD_MINIMA],
+                        (long)parametros[PARAM_VELOCIDAD_MAXIMA]);
+}
+
+int gobernadorPaso(const EstimacionDistancia &frente) {
+  unsigned long ahora = millis();
+  unsigned long dt = min(ahora - ultimoMs, 50UL);
+  ultimoMs = ahora;
+
+  int limite = gobernadorLimite(frente);
+  int subida = max((int)(GOBERNADOR_ACEL_PWM_S * dt / 1000), 1);
+  int bajada = max((int)(GOBERNADOR_DECEL_PWM_S * dt / 1000), 1);
+  if (velocidad < limite) {
+    velocidad = min(velocidad + subida, limite);
+  } else {
+    velocidad = max(velocidad - bajada, limite);
+  }
+  return velocidad;
+}
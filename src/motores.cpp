@@ -0,0 +1,315 @@
+#include "motores.h"
+#include "configuracion.h"
+#include "encoders.h"
+#include "puente_l298n.h"
+#include "parametros.h"
+#include "bateria.h"
+#include "frenada.h"
+#include "emergencia.h"
+
+// Ganancias del PI en Q8 (PWM por mm/s de error; la integral por periodo)
+#define KP_Q8 64
+#define KI_Q8 16
+#define CORRECCION_MAX_PWM 80  // La corrección no puede pasar de aquí (antiwindup)
+
+// Giro por ángulo: rampa de frenado según el arco que falta; se corta
+// antes lo que recorre la rueda al frenar (frenada.h)
+#define GIRO_DECEL_POR_MM 4       // Velocidad pedida por mm restante
+#define GIRO_VELOCIDAD_FINAL 70   // Mínimo de la rampa (escala PWM)
+#define GIRO_TIMEOUT_MS 3000      // Rueda bloqueada: se abandona el giro
+
+// Cambio de sentido con la rueda girando: freno hasta que baje de
+// MOTORES_PARADA_MM_S y el PWM nuevo sube en rampa, sin el PI, desde
+// RAMPA_INICIO_PWM (~100 ms hasta 255). Invertir a plena marcha pide casi
+// el doble de la corriente de arranque.
+#define RAMPA_INICIO_PWM 60
+#define RAMPA_PWM_POR_PERIODO 40
+
+struct Rueda {
+  uint8_t encoder;
+  int8_t sentido;         // +1 adelante, -1 atrás, 0 parada
+  int8_t ultimoSentido;   // En el que gira (el anterior mientras frena)
+  int16_t pwmBase;        // Lazo abierto (con el factor de calibración Q8)
+  int16_t objetivoMmS;
+  int16_t correccion;     // Última salida del PI
+  int16_t pwm;            // Aplicado
+  int32_t integralQ8;
+  bool invirtiendo;       // Frenando antes de cambiar de sentido
+  int16_t rampaPwm;       // Tope del PWM tras un cambio de sentido
+};
+
+static Rueda ruedas[2] = {
+  {ENCODER_IZQ, 0, 1, 0, 0, 0, 0, 0, false, 255},
+  {ENCODER_DER, 0, 1, 0, 0, 0, 0, 0, false, 255},
+};
+
+static CurvaMotor curvas[2];
+static bool conCurvas = false;
+static uint16_t curvasMv = 0;     // Batería con la que se midieron las curvas
+static bool lazoAbierto = false;
+
+// Giro en curso
+static bool girando = false;
+static int8_t sentidoGiro = 1;    // +1 izquierda (antihorario), -1 derecha
+static uint32_t avanceInicioUm[2];
+static uint16_t arcoGiroMm;       // Lo que debe recorrer cada rueda
+static unsigned long inicioGiroMs;
+
+// Una sola actualización del puente para las dos ruedas. El lazo abierto
+// se escala a la tensión con la que se ajustó (la de las curvas o
+// BATERIA_NOMINAL_MV); el PI corrige lo que quede. Las ruedas paradas o
+// invirtiendo frenan con freno_pwm (0 = rueda libre); en lazo abierto
+// quedan sueltas.
+static void aplicar() {
+  OrdenPuente orden;
+  uint16_t referenciaMv = conCurvas && curvasMv != 0 ? curvasMv : parametros[PARAM_BATERIA_NOMINAL_MV];
+  uint16_t compensacionQ8 = lazoAbierto ? FACTOR_UNIDAD_Q8 : bateriaCompensacionQ8(referenciaMv);
+  uint8_t freno = lazoAbierto ? 0 : (uint8_t)parametros[PARAM_FRENO_PWM];
+  int8_t sentido[2];
+  uint8_t pwm[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    Rueda &r = ruedas[i];
+    if (r.sentido == 0 || r.invirtiendo) {
+      r.pwm = 0;
+      sentido[i] = freno ? PUENTE_FRENO : 0;
+      pwm[i] = freno;
+    } else {
+      int16_t base = (int16_t)(((int32_t)r.pwmBase * compensacionQ8 + 128) >> 8);
+      r.pwm = min(constrain(base + r.correccion, 0, 255), r.rampaPwm);
+      sentido[i] = r.sentido;
+      pwm[i] = (uint8_t)r.pwm;
+    }
+  }
+  orden.sentidoIzq = sentido[MOTOR_IZQ];
+  orden.sentidoDer = sentido[MOTOR_DER];
+  orden.pwmIzq = pwm[MOTOR_IZQ];
+  orden.pwmDer = pwm[MOTOR_DER];
+  // La parada de emergencia vigila el avance, recto o en curva
+  emergenciaArmar(!lazoAbierto && sentido[MOTOR_IZQ] == 1 && sentido[MOTOR_DER] == 1);
+  puenteAplicar(orden);
+}
+
+int16_t motoresPwmCurva(const CurvaMotor &curva, int16_t mmS) {
+  if (mmS <= 0) return 0;
+  // Interpolación inversa por tramos desde (zonaMuerta, 0); los puntos que
+  // no superan al anterior (rueda parada, ruido) se saltan
+  int16_t pwmAnterior = curva.zonaMuerta;
+  int16_t vAnterior = 0;
+  for (uint8_t i = 0; i < CURVA_PUNTOS; i++) {
+    int16_t pwm = CURVA_PWM_MIN + i * CURVA_PWM_PASO;
+    int16_t v = curva.velocidadMmS[i];
+    if (v <= vAnterior || pwm <= pwmAnterior) continue;
+    if (v >= mmS) {
+      return pwmAnterior + (int16_t)((int32_t)(mmS - vAnterior) * (pwm - pwmAnterior) / (v - vAnterior));
+    }
+    pwmAnterior = pwm;
+    vAnterior = v;
+  }
+  return 255;
+}
+
+// El objetivo sale de la velocidad sin calibrar, igual para las dos ruedas;
+// el PWM de partida, de la curva de la rueda o del factor
+static void fijar(Rueda &r, int8_t sentido, int velocidad, uint16_t factorQ8) {
+  if (sentido != r.sentido) {
+    if (sentido != 0) frenadaTerminar();
+    r.integralQ8 = 0;
+    r.correccion = 0;
+    r.invirtiendo = false;
+    if (sentido == -r.ultimoSentido && encoderVelocidadMmS(r.encoder) > 0) {
+      r.invirtiendo = encoderVelocidadMmS(r.encoder) > MOTORES_PARADA_MM_S;
+      r.rampaPwm = RAMPA_INICIO_PWM;
+    }
+  }
+  r.sentido = sentido;
+  if (sentido != 0 && !r.invirtiendo) r.ultimoSentido = sentido;
+  r.objetivoMmS = (int16_t)(((int32_t)velocidad * MM_S_POR_PWM_Q8) >> 8);
+  if (sentido == 0) {
+    r.pwmBase = 0;
+  } else if (conCurvas) {
+    r.pwmBase = motoresPwmCurva(curvas[&r - ruedas], r.objetivoMmS);
+  } else {
+    r.pwmBase = (int16_t)(((int32_t)velocidad * factorQ8) >> 8);
+  }
+}
+
+static void mandar(int8_t sentidoIzq, int8_t sentidoDer, int velocidad,
+                   uint16_t factorIzqQ8, uint16_t factorDerQ8) {
+  lazoAbierto = false;
+  fijar(ruedas[MOTOR_IZQ], sentidoIzq, velocidad, factorIzqQ8);
+  fijar(ruedas[MOTOR_DER], sentidoDer, velocidad, factorDerQ8);
+  aplicar();
+}
+
+void motoresIniciar() {
+  puenteIniciar();
+  emergenciaIniciar();
+  conCurvas = false;  // calibracionCargar() las fija si hay
+  frenadaIniciar();
+  for (Rueda &r : ruedas) {
+    r.sentido = 0;
+    r.ultimoSentido = 1;
+    r.invirtiendo = false;
+    r.rampaPwm = 255;
+  }
+  detener();
+}
+
+static void pararRuedas() {
+  frenadaEmpezar();
+  mandar(0, 0, 0, 0, 0);
+}
+
+static void mandarGiro(int velocidad) {
+  mandar(-sentidoGiro, sentidoGiro, velocidad, FACTOR_UNIDAD_Q8, FACTOR_UNIDAD_Q8);
+}
+
+// Avance medio de las dos ruedas desde el inicio del giro con la rampa de
+// frenado; corta cuando lo que falta cabe en la frenada de las ruedas
+static void actualizarGiro() {
+  uint32_t avanceUm = (encoderAvanceUm(ENCODER_IZQ) - avanceInicioUm[ENCODER_IZQ]) +
+                      (encoderAvanceUm(ENCODER_DER) - avanceInicioUm[ENCODER_DER]);
+  int32_t restanteMm = (int32_t)arcoGiroMm - (int32_t)(avanceUm / 2000UL);
+  int16_t velMmS = (encoderVelocidadMmS(ENCODER_IZQ) + encoderVelocidadMmS(ENCODER_DER)) / 2;
+
+  if (restanteMm <= frenadaDistanciaMm(velMmS) || millis() - inicioGiroMs > GIRO_TIMEOUT_MS) {
+    girando = false;
+    pararRuedas();
+    return;
+  }
+  mandarGiro(constrain(restanteMm * GIRO_DECEL_POR_MM, GIRO_VELOCIDAD_FINAL,
+                       parametros[PARAM_VELOCIDAD_GIRO]));
+}
+
+// Funciones de control de motores
+void avanzarConVelocidad(int velocidad) {
+  girando = false;
+  mandar(1, 1, velocidad, parametros[PARAM_FACTOR_MOTOR_IZQ_Q8], parametros[PARAM_FACTOR_MOTOR_DER_Q8]);
+}
+
+void avanzarCurvando(int velocidad, int diferencia) {
+  girando = false;
+  lazoAbierto = false;
+  fijar(ruedas[MOTOR_IZQ], 1, max(velocidad - diferencia, 0), parametros[PARAM_FACTOR_MOTOR_IZQ_Q8]);
+  fijar(ruedas[MOTOR_DER], 1, max(velocidad + diferencia, 0), parametros[PARAM_FACTOR_MOTOR_DER_Q8]);
+  aplicar();
+}
+
+void retroceder() {
+  girando = false;
+  mandar(-1, -1, parametros[PARAM_VELOCIDAD_RETROCESO], parametros[PARAM_FACTOR_MOTOR_IZQ_Q8],
+         parametros[PARAM_FACTOR_MOTOR_DER_Q8]);
+}
+
+void girarDerecha() {
+  girando = false;
+  // Motor izq avanza, motor der retrocede
+  mandar(1, -1, parametros[PARAM_VELOCIDAD_GIRO], FACTOR_UNIDAD_Q8, FACTOR_UNIDAD_Q8);
+}
+
+void girarIzquierda() {
+  girando = false;
+  // Motor izq retrocede, motor der avanza
+  mandar(-1, 1, parametros[PARAM_VELOCIDAD_GIRO], FACTOR_UNIDAD_Q8, FACTOR_UNIDAD_Q8);
+}
+
+void detener() {
+  girando = false;
+  pararRuedas();
+}
+
+void girarGrados(int grados) {
+  girando = grados != 0;
+  if (!girando) return;
+  sentidoGiro = grados > 0 ? 1 : -1;
+  arcoGiroMm = (uint16_t)((uint32_t)abs(grados) * DISTANCIA_ENTRE_RUEDAS_MM * 31416UL / 3600000UL);
+  avanceInicioUm[ENCODER_IZQ] = encoderAvanceUm(ENCODER_IZQ);
+  avanceInicioUm[ENCODER_DER] = encoderAvanceUm(ENCODER_DER);
+  inicioGiroMs = millis();
+  mandarGiro(parametros[PARAM_VELOCIDAD_GIRO]);
+}
+
+void motoresFijarCurvas(const CurvaMotor *c, uint16_t referenciaMv) {
+  conCurvas = c != nullptr;
+  curvasMv = referenciaMv;
+  if (conCurvas) memcpy(curvas, c, sizeof(curvas));
+}
+
+const CurvaMotor *motoresCurvas() {
+  return conCurvas ? curvas : nullptr;
+}
+
+void motoresLazoAbierto(int pwmIzq, int pwmDer) {
+  girando = false;
+  lazoAbierto = true;
+  frenadaTerminar();
+  int pwm[2] = {pwmIzq, pwmDer};
+  for (uint8_t i = 0; i < 2; i++) {
+    Rueda &r = ruedas[i];
+    r.sentido = pwm[i] > 0 ? 1 : (pwm[i] < 0 ? -1 : 0);
+    if (r.sentido != 0) r.ultimoSentido = r.sentido;
+    r.pwmBase = (int16_t)min(abs(pwm[i]), 255);
+    r.objetivoMmS = 0;
+    r.integralQ8 = 0;
+    r.correccion = 0;
+    r.invirtiendo = false;
+    r.rampaPwm = 255;
+  }
+  aplicar();
+}
+
+bool motoresGirando() {
+  return girando;
+}
+
+// PI por rueda en enteros: pwm = base + (KP * e + integral) / 256. Sin PI
+// mientras una rueda invierte o sube la rampa.
+void motoresControlar() {
+  if (lazoAbierto) return;
+  frenadaActualizar();
+  if (girando) actualizarGiro();
+
+  for (Rueda &r : ruedas) {
+    if (r.invirtiendo && encoderVelocidadMmS(r.encoder) <= MOTORES_PARADA_MM_S) {
+      r.invirtiendo = false;
+      r.ultimoSentido = r.sentido;
+    } else if (!r.invirtiendo && r.rampaPwm < 255) {
+      r.rampaPwm = min(r.rampaPwm + RAMPA_PWM_POR_PERIODO, 255);
+    }
+    if (r.sentido == 0 || r.invirtiendo || r.rampaPwm < 255) continue;
+
+    // Sin periodo válido (arranque o rueda bloqueada) se mantiene la última
+    // corrección: sin medida el lazo solo empujaría a ciegas
+    int16_t medida = encoderVelocidadMmS(r.encoder);
+    if (medida == 0) continue;
+
+    int16_t error = r.objetivoMmS - medida;
+    const int32_t limite = (int32_t)CORRECCION_MAX_PWM << 8;
+    r.integralQ8 = constrain(r.integralQ8 + (int32_t)KI_Q8 * error, -limite, limite);
+
+    int32_t correccion = ((int32_t)KP_Q8 * error + r.integralQ8) >> 8;
+    r.correccion = (int16_t)constrain(correccion, -CORRECCION_MAX_PWM, CORRECCION_MAX_PWM);
+  }
+  aplicar();
+}
+
+int8_t motoresSentido(uint8_t motor) {
+  return ruedas[motor].ultimoSentido;
+}
+
+bool motoresParados() {
+  return encoderVelocidadMmS(ENCODER_IZQ) <= MOTORES_PARADA_MM_S &&
+         encoderVelocidadMmS(ENCODER_DER) <= MOTORES_PARADA_MM_S;
+}
+
+bool motoresInvirtiendo() {
+  return ruedas[MOTOR_IZQ].invirtiendo || ruedas[MOTOR_DER].invirtiendo;
+}
+
+int16_t motoresObjetivoMmS(uint8_t motor) {
+  return ruedas[motor].sentido * ruedas[motor].objetivoMmS;
+}
+
+int16_t motoresPwm(uint8_t motor) {
+  return ruedas[motor].pwm;
+}
@@ -0,0 +1,596 @@
+#include "navegacion.h"
+#include "configuracion.h"
+#include "motores.h"
+#include "barrido.h"
+#include "gobernador.h"
+#include "rejilla.h"
+#include "recuperacion.h"
+#include "emergencia.h"
+#include "odometria.h"
+#include "parametros.h"
+#include "perfil.h"
+#include "traza.h"
+
+#define PAUSA_DETENCION_MS 200  // Máximo frenando antes de retroceder
+#define PAUSA_TRAS_RETROCESO_MS 300  // Máximos: acaban antes si las ruedas ya paran
+#define PAUSA_TRAS_GIRO_MS 200
+
+#define CICLOS_SIN_ECO_BLOQUEO 13  // ~2 s de mediciones seguidas sin eco
+#define CICLOS_SIN_ECO_PARED 53    // ~8 s: la pared lateral confirma el avance
+#define DISTANCIA_SALIDA_CM 50  // Un sector con menos no se considera salida
+#define EXPLORAR_TRAS_MS 3000  // Avance mínimo antes de buscar frontera
+#define PUNTOS_FRONTERA 6       // Dos celdas desconocidas en un lateral
+#define ECOS_VENTANA_Q10 3      // Décimas de las mediciones de la ventana de REC_TIEMPO con eco
+
+// Seguimiento de pared. La consigna es lateral; a 45° el sensor la ve a
+// consigna * sqrt(2) (181/128)
+#define PARED_ENTRADA_CM 50      // Lateral a 0°/180° para empezar a seguirla
+#define PARED_CONSIGNA_CM 30
+#define PARED_RANGO_CM (PARED_CONSIGNA_CM * 181 / 128)
+#define PARED_FRENTE_MIN_CM 80   // Con menos al frente, avance normal
+#define PARED_FRESCA_MS 160      // Lectura nueva desde la última medición
+#define PARED_EDAD_MAX_MS 600    // Cubre un vistazo al frente
+#define PARED_PERDIDA_CICLOS 3   // Mediciones seguidas sin pared para dejarla
+#define PARED_ESPERA_MS 2000     // Tras dejar una pared, antes de tomar otra
+#define PARED_KP_Q4 32           // PWM por cm de error (16 = 1)
+#define PARED_KD_Q4 128          // PWM por cm de cambio entre lecturas
+#define PARED_DIFERENCIA_MAX 50
+#define PARED_SIN_ERROR 0x7FFF
+
+int velocidadActual = VELOCIDAD_MINIMA;
+
+static uint8_t estado = NAV_ESCANEO;
+static unsigned long entradaMs = 0;      // Marca de tiempo de la última transición
+static unsigned long duracionRetroceso = 0;
+static bool frenandoRetroceso = false;  // RETROCESO: parando antes de la marcha atrás
+static unsigned long inicioMarchaAtrasMs = 0;  // Tiempo en el estado al arrancarla
+static int gradosGiro = 0;              // Positivo = izquierda
+static int giroForzado = 0;             // Giro del plan de recuperación (0 = escanear)
+static unsigned long finGiroMs = 0;
+static bool frenteBloqueado = false;    // Tras un bloqueo físico el frente no es salida
+static bool reescaneado = false;        // Ya se repitió el escaneo sin salida
+
+// Detecciones de atasco
+static unsigned long tiempoAvanzando = 0;
+static unsigned long tiempoSinCambios = 0;
+static int contadorAtasco = 0;
+static long distanciaAnterior = 400;
+static int cambiosDistancia = 0;
+static int ciclosSinCambio = 0;
+static int lecturasConEco = 0;          // En la ventana de REC_TIEMPO
+static int ciclosSinEco = 0;
+static uint16_t recuperaciones[REC_CAUSAS];
+static uint16_t paradas = 0;            // Detenciones por obstáculo al frente
+static unsigned long entradaAvanceMs = 0;
+static PoseOdometria poseAvance;        // Al último cambio de distancia con eco
+
+// Seguimiento de pared
+static int anguloPared = 45;            // Servo: 45 = pared derecha, 135 = izquierda
+static int errorPared = PARED_SIN_ERROR;
+static int correccionPared = 0;         // Diferencia entre ruedas (positiva = izquierda)
+static uint8_t ciclosSinPared = 0;
+static unsigned long finParedMs = 0;
+static bool paredTrasGiro = false;      // La salida de recuperación sigue la pared
+
+// ---- Acciones de cada estado ----
+
+static bool esAvance(uint8_t e) {
+  return e == NAV_CRUCERO || e == NAV_LENTO || e == NAV_PARED;
+}
+
+static void entrarRetroceso(uint8_t) {
+  detener();
+  velocidadActual = parametros[PARAM_VELOCIDAD_MINIMA];
+  frenandoRetroceso = true;
+}
+
+static uint8_t pasoRetroceso(unsigned long t) {
+  // Frena hasta que las ruedas casi paran (si aún giran al acabar la
+  // pausa, motores.h termina de frenar antes de invertir)
+  if (frenandoRetroceso) {
+    if (t < PAUSA_DETENCION_MS && !motoresParados()) return NAV_RETROCESO;
+    frenandoRetroceso = false;
+    inicioMarchaAtrasMs = t;
+  }
+  t -= inicioMarchaAtrasMs;
+  if (t < duracionRetroceso) {
+    retroceder();
+    return NAV_RETROCESO;
+  }
+  detener();
+  if (t < duracionRetroceso + PAUSA_TRAS_RETROCESO_MS && !motoresParados()) return NAV_RETROCESO;
+  if (giroForzado == 0) return NAV_ESCANEO;
+
+  // La estrategia ya decide el giro: sin escaneo
+  gradosGiro = giroForzado;
+  giroForzado = 0;
+  frenteBloqueado = false;
+  barridoInvalidar();
+  return NAV_GIRO;
+}
+
+static void entrarEscaneo(uint8_t) {
+  detener();
+  // Si el barrido continuo tiene datos frescos no hace falta mover el servo
+  reescaneado = false;
+  if (barridoMejorAngulo(BARRIDO_EDAD_MAX_MS, nullptr) < 0) {
+    barridoModo(BARRIDO_ESCANEO, frenteBloqueado ? 90 : -1);
+  } else {
+    Serial.println(F("⚡ Dirección tomada del barrido continuo"));
+  }
+}
+
+// Algún lateral fresco con salida y celdas por descubrir
+static bool hayFrontera() {
+  for (int angulo = 0; angulo <= 180; angulo += BARRIDO_PASO_GRADOS) {
+    if (angulo == 90) continue;
+    long d = barridoDistancia(angulo, BARRIDO_EDAD_MAX_MS);
+    if (d >= DISTANCIA_SALIDA_CM && rejillaPuntuacion(angulo, d) >= PUNTOS_FRONTERA) return true;
+  }
+  return false;
+}
+
+// Entre los sectores con salida, el que más queda por explorar según la
+// rejilla (frontera, poco visitado); sin ninguno, el de mayor distancia
+static int elegirAngulo(int excluir, long *dist) {
+  int mejorAngulo = barridoMejorAngulo(BARRIDO_SIN_LIMITE_EDAD, dist, excluir);
+  if (mejorAngulo < 0) return -1;
+  int mejorPuntos = 0;
+  long mejorDist = 0;
+  for (int angulo = 0; angulo <= 180; angulo += BARRIDO_PASO_GRADOS) {
+    long d = barridoDistancia(angulo, BARRIDO_SIN_LIMITE_EDAD);
+    if (angulo == excluir || d < DISTANCIA_SALIDA_CM) continue;
+    int puntos = rejillaPuntuacion(angulo, d);
+    if (mejorDist == 0 || puntos > mejorPuntos || (puntos == mejorPuntos && d > mejorDist)) {
+      mejorAngulo = angulo;
+      mejorPuntos = puntos;
+      mejorDist = d;
+    }
+  }
+  if (mejorDist > 0) *dist = mejorDist;
+  return mejorAngulo;
+}
+
+static uint8_t pasoEscaneo(unsigned long) {
+  if (barridoEscaneando()) return NAV_ESCANEO;
+
+  // 5. ENCONTRAR la dirección: la más prometedora para explorar.
+  // Tras un bloqueo físico el frente puede leer 400 (pared oblicua sin eco)
+  // aunque el robot acabe de chocar: se elige entre los laterales
+  long maxDist = -1;
+  int excluir = frenteBloqueado ? 90 : -1;
+  int mejorAngulo = elegirAngulo(excluir, &maxDist);
+  if (mejorAngulo < 0 && !reescaneado) {
+    // Faltan sectores (el escaneo no los recorrió): otra pasada, sin
+    // olvidar el bloqueo ni lo ya medido
+    reescaneado = true;
+    barridoModo(BARRIDO_ESCANEO, excluir);
+    return NAV_ESCANEO;
+  }
+  frenteBloqueado = false;
+  barridoInvalidar();  // El robot va a girar
+
+  if (mejorAngulo < 0) {
+    // Nunca de frente a ciegas: por donde se vino había paso
+    Serial.println(F("❓ Sin dirección tras reescanear: media vuelta"));
+    gradosGiro = 180;
+    return NAV_GIRO;
+  }
+
+  Serial.print(F("✅ Mejor dirección: "));
+  Serial.print(mejorAngulo);
+  Serial.print(F("° con "));
+  Serial.print(maxDist);
+  Serial.println(F(" cm"));
+
+  // 0° = derecha, 180° = izquierda; 45°/135° giran GIRO_DIAGONAL_GRADOS
+  if (mejorAngulo == 0 || mejorAngulo == 180) {
+    gradosGiro = 90;
+  } else if (mejorAngulo == 45 || mejorAngulo == 135) {
+    gradosGiro = parametros[PARAM_GIRO_DIAGONAL_GRADOS];
+  } else {
+    gradosGiro = 0;
+  }
+  if (mejorAngulo < 90) gradosGiro = -gradosGiro;
+  return NAV_GIRO;
+}
+
+static void entrarGiro(uint8_t) {
+  if (gradosGiro == 0) {
+    Serial.println(F("⬆️ Frente está despejado"));
+    return;
+  }
+  Serial.print(gradosGiro < 0 ? F("↪️ Girando ") : F("↩️ Girando "));
+  Serial.print(abs(gradosGiro));
+  Serial.println(gradosGiro < 0 ? F("° DERECHA") : F("° IZQUIERDA"));
+  girarGrados(gradosGiro);
+}
+
+// El giro lo cierra motoresControlar() con los encoders; aquí solo se
+// espera a que termine y se deja la pausa antes de avanzar
+static uint8_t pasoGiro(unsigned long) {
+  uint8_t siguiente = paredTrasGiro ? NAV_PARED : NAV_CRUCERO;
+  if (gradosGiro == 0) {
+    paredTrasGiro = false;
+    return siguiente;
+  }
+  unsigned long ahora = millis();
+  if (motoresGirando()) {
+    finGiroMs = ahora;
+    return NAV_GIRO;
+  }
+  if (ahora - finGiroMs < PAUSA_TRAS_GIRO_MS && !motoresParados()) return NAV_GIRO;
+  Serial.println(F("✅ Listo para continuar\n"));
+  paredTrasGiro = false;
+  return siguiente;
+}
+
+// Las detecciones arrancan juntas de cero: ninguna hereda cuentas de
+// antes de una maniobra (la repetición la detecta el historial de
+// recuperacion.cpp, no los contadores). El sensor tapado es la excepción:
+// sus lecturas siguen contando en la maniobra, que con un obstáculo real
+// las lleva por encima de la distancia crítica, y la recuperación salta
+// al volver a avanzar en lugar de otra parada por obstáculo
+static void reiniciarDetecciones() {
+  tiempoAvanzando = millis();
+  tiempoSinCambios = tiempoAvanzando;
+  poseAvance = odometriaPose();
+  cambiosDistancia = 0;
+  ciclosSinCambio = 0;
+  lecturasConEco = 0;
+  ciclosSinEco = 0;
+}
+
+static void entrarAvance(uint8_t anterior) {
+  if (esAvance(anterior)) return;
+  reiniciarDetecciones();
+  entradaAvanceMs = tiempoAvanzando;
+  gobernadorIniciar();
+}
+
+// CRUCERO y LENTO avanzan igual: el gobernador fija la velocidad
+static void avanzarGobernado() {
+  velocidadActual = gobernadorPaso(barridoFrontalEstimacion());
+  avanzarConVelocidad(velocidadActual);
+}
+
+static uint8_t pasoCrucero(unsigned long) {
+  avanzarGobernado();
+  return NAV_CRUCERO;
+}
+
+static uint8_t pasoLento(unsigned long) {
+  avanzarGobernado();
+  return NAV_LENTO;
+}
+
+static void entrarPared(uint8_t anterior) {
+  entrarAvance(anterior);
+  errorPared = PARED_SIN_ERROR;
+  correccionPared = 0;
+  ciclosSinPared = 0;
+  Serial.println(anguloPared == 45 ? F("🧱 Siguiendo pared DERECHA") : F("🧱 Siguiendo pared IZQUIERDA"));
+}
+
+// La misma velocidad gobernada, curvando según el PD de la pared
+static uint8_t pasoPared(unsigned long) {
+  velocidadActual = gobernadorPaso(barridoFrontalEstimacion());
+  avanzarCurvando(velocidadActual, correccionPared);
+  return NAV_PARED;
+}
+
+// Lateral a seguir (45 derecha, 135 izquierda) según el barrido continuo,
+// o -1: pared cerca a 0°/180° que sigue a 45°/135°; la más cercana
+static int ladoPared() {
+  long der = barridoDistancia(0, BARRIDO_EDAD_MAX_MS);
+  long izq = barridoDistancia(180, BARRIDO_EDAD_MAX_MS);
+  long derDiagonal = barridoDistancia(45, BARRIDO_EDAD_MAX_MS);
+  long izqDiagonal = barridoDistancia(135, BARRIDO_EDAD_MAX_MS);
+  bool hayDer = der > 0 && der < PARED_ENTRADA_CM && derDiagonal > 0 && derDiagonal < 2 * PARED_ENTRADA_CM;
+  bool hayIzq = izq > 0 && izq < PARED_ENTRADA_CM && izqDiagonal > 0 && izqDiagonal < 2 * PARED_ENTRADA_CM;
+  if (hayDer && (!hayIzq || der <= izq)) return 45;
+  if (hayIzq) return 135;
+  return -1;
+}
+
+// PD sobre la distancia a 45°/135° con cada lectura lateral nueva.
+// Devuelve false si hay que dejar la pared (perdida o frente cerca).
+static bool seguirPared(long frenteCm) {
+  if (frenteCm < PARED_FRENTE_MIN_CM) return false;
+
+  long rango = barridoDistancia(anguloPared, PARED_EDAD_MAX_MS);
+  if (rango < 0 || rango > 2 * PARED_RANGO_CM) {
+    // Hueco (puerta, esquina) o sin eco: recto hasta confirmarlo
+    correccionPared = 0;
+    errorPared = PARED_SIN_ERROR;
+    return ++ciclosSinPared <= PARED_PERDIDA_CICLOS;
+  }
+  ciclosSinPared = 0;
+  // Durante el vistazo al frente, recto: mantener la última corrección
+  // sin medir la pasa de largo
+  if (barridoDistancia(anguloPared, PARED_FRESCA_MS) < 0) {
+    correccionPared = 0;
+    return true;
+  }
+
+  int error = (int)rango - PARED_RANGO_CM;
+  int derivada = errorPared == PARED_SIN_ERROR ? 0 : error - errorPared;
+  errorPared = error;
+  int salida = (PARED_KP_Q4 * error + PARED_KD_Q4 * derivada) / 16;
+  salida = constrain(salida, -PARED_DIFERENCIA_MAX, PARED_DIFERENCIA_MAX);
+  // Lejos de la pared derecha se curva a la derecha (diferencia negativa)
+  correccionPared = anguloPared == 45 ? -salida : salida;
+  return true;
+}
+
+static void entrarRecuperacion(uint8_t) {
+  detener();
+  velocidadActual = parametros[PARAM_VELOCIDAD_MINIMA];
+  reiniciarDetecciones();
+}
+
+static uint8_t pasoRecuperacion(unsigned long) {
+  Serial.println(F("↩️ Retrocediendo para liberar..."));
+  return NAV_RETROCESO;
+}
+
+// ---- Tabla de estados ----
+
+typedef void (*EntradaEstado)(uint8_t anterior);
+typedef uint8_t (*PasoEstado)(unsigned long transcurridoMs);
+
+static const char N_CRUCERO[] PROGMEM = "CRUCERO";
+static const char N_LENTO[] PROGMEM = "LENTO";
+static const char N_RETROCESO[] PROGMEM = "RETROCESO";
+static const char N_ESCANEO[] PROGMEM = "ESCANEO";
+static const char N_GIRO[] PROGMEM = "GIRO";
+static const char N_RECUPERACION[] PROGMEM = "RECUPERACION";
+static const char N_PARED[] PROGMEM = "PARED";
+
+struct DefinicionEstado {
+  const char *nombre;  // En flash
+  EntradaEstado entrada;
+  PasoEstado paso;
+};
+
+// Mismo orden que EstadoNav; la tabla entera va en flash
+static const DefinicionEstado ESTADOS[NAV_ESTADOS] PROGMEM = {
+  {N_CRUCERO,      entrarAvance,       pasoCrucero},
+  {N_LENTO,        entrarAvance,       pasoLento},
+  {N_RETROCESO,    entrarRetroceso,    pasoRetroceso},
+  {N_ESCANEO,      entrarEscaneo,      pasoEscaneo},
+  {N_GIRO,         entrarGiro,         pasoGiro},
+  {N_RECUPERACION, entrarRecuperacion, pasoRecuperacion},
+  {N_PARED,        entrarPared,        pasoPared},
+};
+
+static void transicion(uint8_t nuevo) {
+  uint8_t anterior = estado;
+  estado = nuevo;
+  entradaMs = millis();
+  TRAZA_ESTADO(nuevo);
+  ((EntradaEstado)pgm_read_ptr(&ESTADOS[nuevo].entrada))(anterior);
+}
+
+// Pide el plan al motor de recuperación y lo deja listo para RETROCESO
+static void planificar(uint8_t evento) {
+  PlanRecuperacion plan =
+    recuperacionEvento(evento, evento == EVENTO_BLOQUEO ? poseAvance : odometriaPose());
+  duracionRetroceso = plan.retrocesoMs;
+  giroForzado = plan.giroGrados;
+  if (plan.estrategia == ESTRATEGIA_RETROCESO_LARGO) {
+    Serial.println(F("🔁 Evasión repetida aquí: retroceso largo"));
+  } else if (plan.estrategia == ESTRATEGIA_MEDIA_VUELTA) {
+    Serial.println(F("🔁 Bucle en el mismo sitio: media vuelta"));
+  } else if (plan.estrategia == ESTRATEGIA_SALIR_PARED) {
+    Serial.println(F("🔁 Bucle persistente: salida siguiendo la pared"));
+    // Girando a la izquierda, lo que tenía delante queda a la derecha
+    anguloPared = plan.giroGrados > 0 ? 45 : 135;
+    paredTrasGiro = true;
+  }
+}
+
+static void recuperar(uint8_t causa) {
+  recuperaciones[causa]++;
+  contadorAtasco = 0;
+  if (causa == REC_BLOQUEO_FISICO) {
+    Serial.println(F("🚫 BLOQUEO FÍSICO detectado (obstáculo no visible)!"));
+    frenteBloqueado = true;
+    planificar(EVENTO_BLOQUEO);
+  } else if (causa == REC_ATASCO) {
+    Serial.println(F("🚨 ATASCADO! Rutina de escape"));
+    planificar(EVENTO_ATASCO);
+  } else {
+    Serial.println(F("⏱️ ATASCO DETECTADO por tiempo (sin avanzar)"));
+    planificar(EVENTO_TIEMPO);
+  }
+  transicion(NAV_RECUPERACION);
+}
+
+// ---- API ----
+
+void navegacionIniciar() {
+  velocidadActual = parametros[PARAM_VELOCIDAD_MINIMA];
+  contadorAtasco = 0;
+  distanciaAnterior = 400;
+  frenteBloqueado = false;
+  giroForzado = 0;
+  paredTrasGiro = false;
+  finParedMs = 0;
+  recuperacionIniciar();
+  memset(recuperaciones, 0, sizeof(recuperaciones));
+  paradas = 0;
+  estado = NAV_ESCANEO;
+  transicion(NAV_ESCANEO);
+}
+
+// Avance real y detecciones de bloqueo y atasco; devuelve true si lanzó
+// una recuperación
+static bool detectarAtasco(const EstimacionDistancia &frente, unsigned long tiempoActual) {
+  PERFIL_ETAPA(ETAPA_ATASCO);
+  long distancia = frente.distanciaCm;
+
+  // Detectar si la distancia cambia (señal de que está avanzando realmente).
+  // Sin eco no se sabe: no cuenta ni como cambio ni como ciclo quieto.
+  ciclosSinEco = frente.eco ? 0 : ciclosSinEco + 1;
+  if (frente.eco) {
+    lecturasConEco++;
+    // Contra la última distancia que contó como cambio: a la velocidad
+    // baja de aproximación se avanza menos de 3 cm por medición
+    if (abs(distancia - distanciaAnterior) > 3) {
+      cambiosDistancia++;
+      ciclosSinCambio = 0;
+      tiempoSinCambios = tiempoActual;
+      distanciaAnterior = distancia;
+      poseAvance = odometriaPose();
+    } else {
+      // No hubo cambio significativo
+      ciclosSinCambio++;
+    }
+  }
+
+  // Sensor bloqueado o muy pegado (sin eco no se sabe)
+  if (frente.eco && distancia < 5) {
+    contadorAtasco++;
+  } else if (frente.eco && distancia > parametros[PARAM_DISTANCIA_CRITICA]) {
+    contadorAtasco = 0;
+  }
+
+  if (!esAvance(estado)) return false;
+
+  // BLOQUEO FÍSICO: Si avanza pero distancia NO cambia en bloqueo_ms
+  // (tantas mediciones como caben y ese tiempo), o si lleva
+  // CICLOS_SIN_ECO_BLOQUEO sin eco (pared oblicua que no lo devuelve; es
+  // más largo para no saltar en un pasillo abierto, y más aún siguiendo
+  // una pared, que ya da ecos laterales)
+  int limiteSinEco = estado == NAV_PARED ? CICLOS_SIN_ECO_PARED : CICLOS_SIN_ECO_BLOQUEO;
+  unsigned long bloqueoMs = (uint16_t)parametros[PARAM_BLOQUEO_MS];
+  int ciclosBloqueo = bloqueoMs / parametros[PARAM_PERIODO_MEDIR_MS];
+  if ((ciclosSinCambio > ciclosBloqueo && tiempoActual - tiempoSinCambios > bloqueoMs) ||
+      ciclosSinEco > limiteSinEco) {
+    recuperar(REC_BLOQUEO_FISICO);
+    return true;
+  }
+
+  // DETECTAR ATASCO: si está muy pegado o sensor bloqueado
+  if (contadorAtasco > parametros[PARAM_ATASCO_LECTURAS]) {
+    recuperar(REC_ATASCO);
+    return true;
+  }
+
+  // DETECTAR ATASCO POR TIEMPO: cada atasco_ventana_ms avanzando, pocos
+  // cambios = atascado (solo si hubo ecos suficientes para juzgarlo: un
+  // pasillo largo sin eco no es un atasco)
+  unsigned long ventanaMs = (uint16_t)parametros[PARAM_ATASCO_VENTANA_MS];
+  if (tiempoActual - tiempoAvanzando > ventanaMs) {
+    int minEcos = ventanaMs / parametros[PARAM_PERIODO_MEDIR_MS] * ECOS_VENTANA_Q10 / 10;
+    bool atascado = cambiosDistancia < 5 && lecturasConEco > minEcos;
+    tiempoAvanzando = tiempoActual;
+    cambiosDistancia = 0;
+    lecturasConEco = 0;
+    if (atascado) {
+      recuperar(REC_TIEMPO);
+      return true;
+    }
+  }
+  return false;
+}
+
+void navegacionMedicion(const EstimacionDistancia &frente) {
+  unsigned long tiempoActual = millis();
+  if (detectarAtasco(frente, tiempoActual) || !esAvance(estado)) return;
+
+  PERFIL_ETAPA(ETAPA_DECISION);
+  long distancia = frente.distanciaCm;
+
+  // EXPLORAR: avanzando sobre terreno ya visitado con una salida lateral
+  // por descubrir, se elige dirección sin esperar al obstáculo
+  if (tiempoActual - entradaAvanceMs > EXPLORAR_TRAS_MS &&
+      rejillaPuntuacion(90, distancia) < 0 && hayFrontera()) {
+    Serial.println(F("🧭 Terreno ya visitado: buscando frontera"));
+    transicion(NAV_ESCANEO);
+    return;
+  }
+
+  // DECIDIR: parar en DISTANCIA_CRITICA; antes, LENTO si el gobernador
+  // limita la velocidad por el obstáculo
+  if (distancia > parametros[PARAM_DISTANCIA_CRITICA]) {
+    if (estado == NAV_PARED) {
+      if (seguirPared(distancia)) return;
+      Serial.println(F("🧱 Fin de la pared"));
+      finParedMs = tiempoActual;
+    } else if (estado == NAV_CRUCERO && distancia >= PARED_FRENTE_MIN_CM &&
+               tiempoActual - finParedMs > PARED_ESPERA_MS &&
+               rejillaPuntuacion(90, distancia) >= 0) {
+      // Solo hacia terreno por recorrer: por lo visitado se sigue buscando
+      // frontera en avance libre
+      int lado = ladoPared();
+      if (lado >= 0) {
+        anguloPared = lado;
+        transicion(NAV_PARED);
+        return;
+      }
+    }
+    uint8_t siguiente =
+        gobernadorLimite(frente) < parametros[PARAM_VELOCIDAD_MAXIMA] ? NAV_LENTO : NAV_CRUCERO;
+    if (estado != siguiente) transicion(siguiente);
+  } else {
+    Serial.println(F("🛑 Obstáculo detectado!"));
+    paradas++;
+    planificar(EVENTO_OBSTACULO);
+    transicion(NAV_RETROCESO);
+  }
+}
+
+// El ISR del eco ya ha frenado y bloqueado el avance: se evade como un
+// obstáculo y se desbloquea con la orden de RETROCESO dada
+static void atenderEmergencia() {
+  Serial.print(F("🛑 PARADA DE EMERGENCIA a "));
+  Serial.print(emergenciaDistanciaCm());
+  Serial.print(F(" cm ("));
+  Serial.print(emergenciaLatenciaUs());
+  Serial.println(F(" us)"));
+  if (esAvance(estado) && contadorAtasco > parametros[PARAM_ATASCO_LECTURAS]) {
+    // Con el sensor tapado desde antes de avanzar no es un obstáculo nuevo
+    recuperar(REC_ATASCO);
+  } else if (esAvance(estado)) {
+    planificar(EVENTO_OBSTACULO);
+    transicion(NAV_RETROCESO);
+  }
+  emergenciaAtender();
+}
+
+void navegacionPaso() {
+  if (emergenciaPendiente()) atenderEmergencia();
+  uint8_t siguiente = ((PasoEstado)pgm_read_ptr(&ESTADOS[estado].paso))(millis() - entradaMs);
+  if (siguiente != estado) transicion(siguiente);
+
+  // El servo barre solo con camino libre y lejos de obstáculos
+  if (estado == NAV_PARED) {
+    barridoSeguirPared(anguloPared);
+  } else if (estado == NAV_CRUCERO && barridoFrontal() > BARRIDO_DISTANCIA_LIBRE) {
+    barridoModo(BARRIDO_CONTINUO);
+  } else {
+    barridoModo(BARRIDO_APARCADO);
+  }
+}
+
+EstadoNav navegacionEstado() {
+  return (EstadoNav)estado;
+}
+
+const __FlashStringHelper *navegacionNombreEstado(EstadoNav e) {
+  return (const __FlashStringHelper *)pgm_read_ptr(&ESTADOS[e].nombre);
+}
+
+int navegacionContadorAtasco() {
+  return contadorAtasco;
+}
+
+uint16_t navegacionParadas() {
+  return paradas;
+}
+
+uint16_t navegacionRecuperaciones(CausaRecuperacion causa) {
+  return recuperaciones[causa];
+}
@@ -0,0 +1,51 @@
+#include "odometria.h"
+#include "configuracion.h"
+#include "encoders.h"
+#include "motores.h"
+
+static PoseOdometria pose = {0, 0, 0};
+static float recorridoMm = 0;
+static uint32_t pulsosPrevios[2] = {0, 0};
+
+void odometriaIniciar() {
+  pose.xMm = 0;
+  pose.yMm = 0;
+  pose.rumbo = 0;
+  recorridoMm = 0;
+  pulsosPrevios[ENCODER_IZQ] = encoderPulsos(ENCODER_IZQ);
+  pulsosPrevios[ENCODER_DER] = encoderPulsos(ENCODER_DER);
+}
+
+void odometriaActualizar() {
+  // Diferencia de contadores: válida aunque el contador dé la vuelta
+  int32_t avance[2];
+  for (uint8_t i = 0; i < 2; i++) {
+    uint32_t pulsos = encoderPulsos(i);
+    avance[i] = (int32_t)(pulsos - pulsosPrevios[i]) * motoresSentido(i);
+    pulsosPrevios[i] = pulsos;
+  }
+  if (avance[ENCODER_IZQ] == 0 && avance[ENCODER_DER] == 0) return;
+
+  const float mmPorPulso = ENCODER_UM_POR_PULSO / 1000.0f;
+  float izq = avance[ENCODER_IZQ] * mmPorPulso;
+  float der = avance[ENCODER_DER] * mmPorPulso;
+  float centro = (izq + der) * 0.5f;
+  float giro = (der - izq) / DISTANCIA_ENTRE_RUEDAS_MM;
+
+  // Integración en el punto medio del arco
+  float rumboMedio = pose.rumbo + giro * 0.5f;
+  pose.xMm += centro * cos(rumboMedio);
+  pose.yMm += centro * sin(rumboMedio);
+  pose.rumbo += giro;
+  if (pose.rumbo > PI) pose.rumbo -= 2 * PI;
+  if (pose.rumbo <= -PI) pose.rumbo += 2 * PI;
+  recorridoMm += fabs(centro);
+}
+
+PoseOdometria odometriaPose() {
+  return pose;
+}
+
+float odometriaRecorridoMm() {
+  return recorridoMm;
+}
@@ -0,0 +1,175 @@
+#include "parametros.h"
+#include "configuracion.h"
+#include "trama_telemetria.h"
+#include "traza.h"
+#include <EEPROM.h>
+
+struct DefinicionParametro {
+  const char *nombre;  // En flash
+  int16_t defecto;
+  int16_t minimo;
+  int16_t maximo;
+};
+
+static const char N_DISTANCIA_CRITICA[] PROGMEM = "distancia_critica";
+static const char N_TTC_MINIMO_MS[] PROGMEM = "ttc_minimo_ms";
+static const char N_VELOCIDAD_MINIMA[] PROGMEM = "velocidad_minima";
+static const char N_VELOCIDAD_MAXIMA[] PROGMEM = "velocidad_maxima";
+static const char N_VELOCIDAD_RETROCESO[] PROGMEM = "velocidad_retroceso";
+static const char N_VELOCIDAD_GIRO[] PROGMEM = "velocidad_giro";
+static const char N_GIRO_DIAGONAL_GRADOS[] PROGMEM = "giro_diagonal_grados";
+static const char N_FACTOR_MOTOR_IZQ_Q8[] PROGMEM = "factor_motor_izq_q8";
+static const char N_FACTOR_MOTOR_DER_Q8[] PROGMEM = "factor_motor_der_q8";
+static const char N_PERIODO_MEDIR_MS[] PROGMEM = "periodo_medir_ms";
+static const char N_BATERIA_NOMINAL_MV[] PROGMEM = "bateria_nominal_mv";
+static const char N_SERVO_GRADOS_S[] PROGMEM = "servo_grados_s";
+static const char N_FRENO_PWM[] PROGMEM = "freno_pwm";
+static const char N_BLOQUEO_MS[] PROGMEM = "bloqueo_ms";
+static const char N_ATASCO_LECTURAS[] PROGMEM = "atasco_lecturas";
+static const char N_ATASCO_VENTANA_MS[] PROGMEM = "atasco_ventana_ms";
+static const char N_EMERGENCIA_CM[] PROGMEM = "emergencia_cm";
+
+// Mismo orden que IdParametro
+static const DefinicionParametro DEFINICIONES[PARAMETROS] PROGMEM = {
+  {N_DISTANCIA_CRITICA, DISTANCIA_CRITICA, 5, 100},
+  {N_TTC_MINIMO_MS, TTC_MINIMO_MS, 100, 5000},
+  {N_VELOCIDAD_MINIMA, VELOCIDAD_MINIMA, 0, 255},
+  {N_VELOCIDAD_MAXIMA, VELOCIDAD_MAXIMA, 0, 255},
+  {N_VELOCIDAD_RETROCESO, VELOCIDAD_RETROCESO, 0, 255},
+  {N_VELOCIDAD_GIRO, VELOCIDAD_GIRO, 0, 255},
+  {N_GIRO_DIAGONAL_GRADOS, GIRO_DIAGONAL_GRADOS, 0, 90},
+  {N_FACTOR_MOTOR_IZQ_Q8, FACTOR_MOTOR_IZQ_Q8, FACTOR_UNIDAD_Q8 / 2, FACTOR_UNIDAD_Q8 * 3 / 2},
+  {N_FACTOR_MOTOR_DER_Q8, FACTOR_MOTOR_DER_Q8, FACTOR_UNIDAD_Q8 / 2, FACTOR_UNIDAD_Q8 * 3 / 2},
+  {N_PERIODO_MEDIR_MS, PERIODO_MEDIR_MS, 50, 1000},
+  {N_BATERIA_NOMINAL_MV, BATERIA_NOMINAL_MV, 0, 15000},
+  {N_SERVO_GRADOS_S, SERVO_GRADOS_POR_S, 100, 1500},
+  {N_FRENO_PWM, FRENO_PWM, 0, 255},
+  {N_BLOQUEO_MS, BLOQUEO_MS, 500, 10000},
+  {N_ATASCO_LECTURAS, ATASCO_LECTURAS, 1, 20},
+  {N_ATASCO_VENTANA_MS, ATASCO_VENTANA_MS, 2000, 30000},
+  {N_EMERGENCIA_CM, EMERGENCIA_CM, 0, 50},
+};
+
+static const ParejaParametros PAREJAS[PARAMETROS_PAREJAS] PROGMEM = {
+  {PARAM_VELOCIDAD_MINIMA, PARAM_VELOCIDAD_MAXIMA, false},
+  {PARAM_EMERGENCIA_CM, PARAM_DISTANCIA_CRITICA, true},
+};
+
+// Imagen tal como va a la EEPROM
+struct ImagenParametros {
+  uint8_t version;
+  uint8_t cantidad;
+  int16_t valores[PARAMETROS];
+  uint16_t crc;
+};
+
+int16_t parametros[PARAMETROS];
+
+static ImagenParametros imagen;    // La que se está guardando
+static int16_t pendiente = -1;     // Próximo byte a escribir, -1 = nada
+
+static int16_t leerCampo(uint8_t id, size_t desplazamiento) {
+  return (int16_t)pgm_read_word((const uint8_t *)&DEFINICIONES[id] + desplazamiento);
+}
+
+int16_t parametroMinimo(uint8_t id) {
+  return leerCampo(id, offsetof(DefinicionParametro, minimo));
+}
+
+int16_t parametroMaximo(uint8_t id) {
+  return leerCampo(id, offsetof(DefinicionParametro, maximo));
+}
+
+const __FlashStringHelper *parametroNombre(uint8_t id) {
+  return (const __FlashStringHelper *)pgm_read_ptr(&DEFINICIONES[id].nombre);
+}
+
+static bool enRango(uint8_t id, int16_t valor) {
+  return valor >= parametroMinimo(id) && valor <= parametroMaximo(id);
+}
+
+ParejaParametros parametrosPareja(uint8_t i) {
+  ParejaParametros p;
+  memcpy_P(&p, &PAREJAS[i], sizeof(p));
+  return p;
+}
+
+int8_t parametrosParejaIncumplida(const int16_t *valores, uint8_t id, int16_t valor) {
+  for (uint8_t i = 0; i < PARAMETROS_PAREJAS; i++) {
+    ParejaParametros p = parametrosPareja(i);
+    int16_t menor = p.menor == id ? valor : valores[p.menor];
+    int16_t mayor = p.mayor == id ? valor : valores[p.mayor];
+    if (menor != 0 && (p.estricta ? menor >= mayor : menor > mayor)) return i;
+  }
+  return -1;
+}
+
+static uint16_t crcImagen(const ImagenParametros &img) {
+  return crc16Ccitt((const uint8_t *)&img, offsetof(ImagenParametros, crc));
+}
+
+static bool imagenValida(const ImagenParametros &img) {
+  if (img.version != PARAMETROS_VERSION || img.cantidad != PARAMETROS) return false;
+  if (img.crc != crcImagen(img)) return false;
+  for (uint8_t i = 0; i < PARAMETROS; i++) {
+    if (!enRango(i, img.valores[i])) return false;
+  }
+  return parametrosParejaIncumplida(img.valores, 0, img.valores[0]) < 0;
+}
+
+bool parametrosIniciar() {
+  for (uint8_t i = 0; i < PARAMETROS; i++) {
+    parametros[i] = leerCampo(i, offsetof(DefinicionParametro, defecto));
+  }
+  pendiente = -1;
+
+  ImagenParametros leida;
+  EEPROM.get(PARAMETROS_DIRECCION, leida);
+  if (!imagenValida(leida)) return false;
+  memcpy(parametros, leida.valores, sizeof(parametros));
+  return true;
+}
+
+int8_t parametroBuscar(const char *nombre) {
+  for (uint8_t i = 0; i < PARAMETROS; i++) {
+    if (strcmp_P(nombre, (const char *)parametroNombre(i)) == 0) return i;
+  }
+  return -1;
+}
+
+bool parametroFijar(uint8_t id, int16_t valor) {
+  if (id >= PARAMETROS || !enRango(id, valor)) return false;
+  if (parametrosParejaIncumplida(parametros, id, valor) >= 0) return false;
+  parametros[id] = valor;
+  TRAZA_PARAMETRO(id, valor);
+  return true;
+}
+
+void parametrosGuardar() {
+  imagen.version = PARAMETROS_VERSION;
+  imagen.cantidad = PARAMETROS;
+  memcpy(imagen.valores, parametros, sizeof(parametros));
+  imagen.crc = crcImagen(imagen);
+  pendiente = 0;
+}
+
+bool parametrosGuardando() {
+  return pendiente >= 0;
+}
+
+bool parametrosActualizar() {
+  if (pendiente < 0) return false;
+
+  // Los bytes que no cambian no gastan escritura: se saltan en la misma llamada
+  const uint8_t *datos = (const uint8_t *)&imagen;
+  while (pendiente < (int16_t)sizeof(imagen)) {
+    int direccion = PARAMETROS_DIRECCION + pendiente;
+    uint8_t b = datos[pendiente++];
+    if (EEPROM.read(direccion) != b) {
+      EEPROM.write(direccion, b);
+      return false;
+    }
+  }
+  pendiente = -1;
+  return true;
+}
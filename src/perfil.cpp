@@ -0,0 +1,151 @@
+#include "perfil.h"
+
+#if PERFILADO
+
+#if defined(__AVR__)
+#define TICKS_POR_US 1UL
+#else
+#include <chrono>
+#define TICKS_POR_US 1000UL
+#endif
+
+#define TOLERANCIA_PERIODO_PCT 10  // Error de periodo que cuenta como excedido
+
+static const char N_MEDICION[] PROGMEM = "medicion";
+static const char N_ATASCO[] PROGMEM = "atasco";
+static const char N_DECISION[] PROGMEM = "decision";
+static const char N_PASO_NAV[] PROGMEM = "paso_nav";
+static const char N_MOTORES[] PROGMEM = "motores";
+static const char N_TELEMETRIA[] PROGMEM = "telemetria";
+static const char N_PERIODO_MEDIR[] PROGMEM = "periodo_medir";
+static const char N_PERIODO_NAV[] PROGMEM = "periodo_nav";
+
+struct DefinicionSerie {
+  const char *nombre;  // En flash
+  uint16_t limiteUs;   // Etapas; los periodos usan TOLERANCIA_PERIODO_PCT
+};
+
+// Mismo orden que SeriePerfil
+static const DefinicionSerie DEFINICIONES[SERIES_PERFIL] PROGMEM = {
+  {N_MEDICION, 2000},
+  {N_ATASCO, 500},
+  {N_DECISION, 3000},
+  {N_PASO_NAV, 1000},
+  {N_MOTORES, 1000},
+  {N_TELEMETRIA, 2000},
+  {N_PERIODO_MEDIR, 0},
+  {N_PERIODO_NAV, 0},
+};
+
+static SerieEstadistica series[SERIES_PERFIL];
+static uint32_t anteriorUs[SERIES_PERFIL - SERIE_PERIODO_MEDIR];  // 0 = sin periodo aún
+
+uint32_t perfilReloj() {
+#if defined(__AVR__)
+  return micros();
+#else
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static bool esPeriodo(uint8_t serie) {
+  return serie >= SERIE_PERIODO_MEDIR;
+}
+
+const __FlashStringHelper *perfilUnidad(uint8_t serie) {
+  return esPeriodo(serie) || TICKS_POR_US == 1 ? F("us") : F("ns");
+}
+
+void perfilIniciar() {
+  memset(series, 0, sizeof(series));
+  for (SerieEstadistica &s : series) s.minimo = 0xFFFFFFFFUL;
+  memset(anteriorUs, 0, sizeof(anteriorUs));
+}
+
+static uint8_t cubeta(uint32_t valor) {
+  uint8_t i = 0;
+  while (valor > 0 && i < PERFIL_CUBETAS - 1) {
+    valor >>= 1;
+    i++;
+  }
+  return i;
+}
+
+static void registrar(uint8_t serie, uint32_t valor, uint32_t limite) {
+  SerieEstadistica &s = series[serie];
+  if (valor < s.minimo) s.minimo = valor;
+  if (valor > s.maximo) s.maximo = valor;
+  if (s.muestras < 0xFFFF && s.suma <= 0xFFFFFFFFUL - valor) {
+    s.suma += valor;
+    s.muestras++;
+  }
+  if (limite > 0 && valor > limite && s.excedidas < 0xFFFF) s.excedidas++;
+  uint16_t &c = s.cubetas[cubeta(valor)];
+  if (c < 0xFFFF) c++;
+}
+
+void perfilRegistrar(uint8_t serie, uint32_t valor) {
+  uint32_t limiteUs = pgm_read_word(&DEFINICIONES[serie].limiteUs);
+  registrar(serie, valor, limiteUs * TICKS_POR_US);
+}
+
+void perfilPeriodo(uint8_t serie, uint32_t nominalUs) {
+  uint32_t ahora = micros();
+  uint32_t &anterior = anteriorUs[serie - SERIE_PERIODO_MEDIR];
+  if (anterior != 0) {
+    uint32_t periodo = ahora - anterior;
+    uint32_t error = periodo > nominalUs ? periodo - nominalUs : nominalUs - periodo;
+    registrar(serie, error, nominalUs * TOLERANCIA_PERIODO_PCT / 100);
+  }
+  anterior = ahora != 0 ? ahora : 1;
+}
+
+const SerieEstadistica &perfilSerie(uint8_t serie) {
+  return series[serie];
+}
+
+void perfilImprimir(uint8_t serie, uint8_t parte) {
+  const SerieEstadistica &s = series[serie];
+  if (parte == 0) {
+    Serial.print(F("perfil "));
+    Serial.print((const __FlashStringHelper *)pgm_read_ptr(&DEFINICIONES[serie].nombre));
+    Serial.print(F(": n "));
+    Serial.print(s.muestras);
+    if (s.muestras > 0) {
+      Serial.print(F(" min/media/max "));
+      Serial.print(s.minimo);
+      Serial.print('/');
+      Serial.print(s.suma / s.muestras);
+      Serial.print('/');
+      Serial.print(s.maximo);
+      Serial.print(' ');
+      Serial.print(perfilUnidad(serie));
+    }
+    Serial.print(F(" excedidas "));
+    Serial.println(s.excedidas);
+    return;
+  }
+
+  int8_t primera = -1, ultima = -1;
+  for (uint8_t i = 0; i < PERFIL_CUBETAS; i++) {
+    if (s.cubetas[i] == 0) continue;
+    if (primera < 0) primera = i;
+    ultima = i;
+  }
+  Serial.print(F("  cubetas"));
+  if (primera >= 0) {
+    Serial.print(' ');
+    Serial.print(primera);
+    Serial.print('-');
+    Serial.print(ultima);
+    Serial.print(':');
+    for (int8_t i = primera; i <= ultima; i++) {
+      Serial.print(' ');
+      Serial.print(s.cubetas[i]);
+    }
+  }
+  Serial.println();
+}
+
+#endif
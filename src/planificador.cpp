@@ -0,0 +1,117 @@
+#include "planificador.h"
+
+struct Tarea {
+  const __FlashStringHelper *nombre;
+  FuncionTarea funcion;
+  uint16_t periodoMs;        // 0 = una sola vez
+  uint16_t plazoMs;
+  unsigned long proximaUs;   // Activación prevista
+  bool activa;
+  MetricasTarea metricas;
+};
+
+static Tarea tareas[PLANIFICADOR_MAX_TAREAS];
+static uint8_t numTareas = 0;
+
+void planificadorIniciar() {
+  numTareas = 0;
+}
+
+int8_t planificadorAgregar(const __FlashStringHelper *nombre, FuncionTarea funcion,
+                           uint16_t periodoMs, uint16_t plazoMs) {
+  if (numTareas >= PLANIFICADOR_MAX_TAREAS) return -1;
+
+  Tarea &t = tareas[numTareas];
+  t.nombre = nombre;
+  t.funcion = funcion;
+  t.periodoMs = periodoMs;
+  t.plazoMs = plazoMs;
+  t.proximaUs = micros() + (unsigned long)periodoMs * 1000UL;  // Primera activación tras un periodo
+  t.activa = periodoMs > 0;
+  memset(&t.metricas, 0, sizeof(t.metricas));
+
+  return numTareas++;
+}
+
+void planificadorProgramar(int8_t id, uint16_t retardoMs) {
+  if (id < 0 || id >= numTareas) return;
+  tareas[id].proximaUs = micros() + (unsigned long)retardoMs * 1000UL;
+  tareas[id].activa = true;
+}
+
+void planificadorDetener(int8_t id) {
+  if (id < 0 || id >= numTareas) return;
+  tareas[id].activa = false;
+}
+
+void planificadorPeriodo(int8_t id, uint16_t periodoMs) {
+  if (id < 0 || id >= numTareas || tareas[id].periodoMs == 0 || periodoMs == 0) return;
+  tareas[id].periodoMs = periodoMs;
+}
+
+void planificadorEjecutar() {
+  for (uint8_t i = 0; i < numTareas; i++) {
+    Tarea &t = tareas[i];
+    if (!t.activa) continue;
+
+    unsigned long inicio = micros();
+    if ((long)(inicio - t.proximaUs) < 0) continue;
+
+    unsigned long activacion = t.proximaUs;
+    unsigned long jitter = inicio - activacion;
+
+    if (t.periodoMs > 0) {
+      // Mantener la fase; si se saltó algún periodo entero, contarlo
+      unsigned long periodoUs = (unsigned long)t.periodoMs * 1000UL;
+      t.proximaUs += periodoUs;
+      while ((long)(inicio - t.proximaUs) >= 0) {
+        t.proximaUs += periodoUs;
+        t.metricas.perdidas++;
+      }
+    } else {
+      t.activa = false;  // Una sola vez (la función puede re-programarla)
+    }
+
+    t.funcion();
+
+    unsigned long fin = micros();
+    unsigned long duracion = fin - inicio;
+    MetricasTarea &m = t.metricas;
+    m.ejecuciones++;
+    m.jitterSumaUs += jitter;
+    if (jitter > m.jitterMaxUs) m.jitterMaxUs = min(jitter, 65535UL);
+    if (duracion > m.duracionMaxUs) m.duracionMaxUs = min(duracion, 65535UL);
+    if (t.plazoMs > 0 && fin - activacion > (unsigned long)t.plazoMs * 1000UL) m.vencidas++;
+  }
+}
+
+const MetricasTarea &planificadorMetricas(int8_t id) {
+  return tareas[id].metricas;
+}
+
+void planificadorReiniciarMetricas() {
+  for (uint8_t i = 0; i < numTareas; i++) {
+    memset(&tareas[i].metricas, 0, sizeof(tareas[i].metricas));
+  }
+}
+
+void planificadorReporte() {
+  Serial.println(F("⏲️ Tarea | ejec | jitter prom/max us | dur max us | vencidas | perdidas"));
+  for (uint8_t i = 0; i < numTareas; i++) {
+    const MetricasTarea &m = tareas[i].metricas;
+    Serial.print(F("  "));
+    Serial.print(tareas[i].nombre);
+    Serial.print(F(" | "));
+    Serial.print(m.ejecuciones);
+    Serial.print(F(" | "));
+    Serial.print(m.ejecuciones ? m.jitterSumaUs / m.ejecuciones : 0);
+    Serial.print(F("/"));
+    Serial.print(m.jitterMaxUs);
+    Serial.print(F(" | "));
+    Serial.print(m.duracionMaxUs);
+    Serial.print(F(" | "));
+    Serial.print(m.vencidas);
+    Serial.print(F(" | "));
+    Serial.println(m.perdidas);
+  }
+}
@@ -0,0 +1,124 @@
+#include "puente_l298n.h"
+
+#if defined(__AVR__) && !defined(PUENTE_API_ARDUINO)
+#define PUENTE_DIRECTO 1
+#include <avr/io.h>
+#endif
+
+static volatile bool avanceBloqueado = false;
+
+void puenteIniciar() {
+  pinMode(MOTOR_IZQ_IN1, OUTPUT);
+  pinMode(MOTOR_IZQ_IN2, OUTPUT);
+  pinMode(MOTOR_IZQ_ENA, OUTPUT);
+
+  pinMode(MOTOR_DER_IN3, OUTPUT);
+  pinMode(MOTOR_DER_IN4, OUTPUT);
+  pinMode(MOTOR_DER_ENB, OUTPUT);
+
+  avanceBloqueado = false;
+  OrdenPuente suelto = {0, 0, 0, 0};
+  puenteAplicar(suelto);
+}
+
+static inline bool avanza(const OrdenPuente &o) {
+  return o.sentidoIzq == 1 || o.sentidoDer == 1;
+}
+
+// Entrada "adelante" (IN1/IN3) y "atrás" (IN2/IN4) de cada sentido
+static inline bool entradaAdelante(int8_t sentido) {
+  return sentido == 1 || sentido == PUENTE_FRENO;
+}
+
+static inline bool entradaAtras(int8_t sentido) {
+  return sentido == -1 || sentido == PUENTE_FRENO;
+}
+
+#if defined(PUENTE_DIRECTO)
+
+// Bits de los pines que van a nivel alto para un sentido, en un puerto
+static inline uint8_t altos(PuertoAvr puerto, int8_t izq, int8_t der) {
+  uint8_t b = 0;
+  if (entradaAdelante(izq)) b |= mascaraEnPuerto(puerto, MOTOR_IZQ_IN1);
+  if (entradaAtras(izq)) b |= mascaraEnPuerto(puerto, MOTOR_IZQ_IN2);
+  if (entradaAdelante(der)) b |= mascaraEnPuerto(puerto, MOTOR_DER_IN3);
+  if (entradaAtras(der)) b |= mascaraEnPuerto(puerto, MOTOR_DER_IN4);
+  return b;
+}
+
+// COM0x1 conecta la salida del comparador al pin; con duty 0 se
+// desconecta y el pin queda al nivel de PORTx (bajo), como analogWrite(0)
+static inline uint8_t bitCom(uint8_t canal) {
+  return canal == 0 ? _BV(COM0A1) : _BV(COM0B1);
+}
+
+void puenteAplicar(const OrdenPuente &o) {
+  constexpr uint8_t canalIzq = CanalPwm<MOTOR_IZQ_ENA>::canal;
+  constexpr uint8_t canalDer = CanalPwm<MOTOR_DER_ENB>::canal;
+  static_assert(canalIzq != canalDer, "ENA y ENB deben usar canales distintos de Timer0");
+
+  // Todo se calcula antes de la sección crítica
+  uint8_t altosB = altos(PUERTO_B, o.sentidoIzq, o.sentidoDer);
+  uint8_t altosD = altos(PUERTO_D, o.sentidoIzq, o.sentidoDer);
+  uint8_t altosC = altos(PUERTO_C, o.sentidoIzq, o.sentidoDer);
+  uint8_t com = (o.pwmIzq ? bitCom(canalIzq) : 0) | (o.pwmDer ? bitCom(canalDer) : 0);
+  uint8_t ocrA = canalIzq == 0 ? o.pwmIzq : o.pwmDer;
+  uint8_t ocrB = canalIzq == 0 ? o.pwmDer : o.pwmIzq;
+
+  uint8_t sreg = SREG;
+  cli();
+  if (avanceBloqueado && avanza(o)) {
+    SREG = sreg;
+    return;
+  }
+  OCR0A = ocrA;
+  OCR0B = ocrB;
+  TCCR0A = (TCCR0A & ~(_BV(COM0A1) | _BV(COM0B1))) | com;
+  if (mascaraPuente(PUERTO_B)) PORTB = (PORTB & ~mascaraPuente(PUERTO_B)) | altosB;
+  if (mascaraPuente(PUERTO_C)) PORTC = (PORTC & ~mascaraPuente(PUERTO_C)) | altosC;
+  if (mascaraPuente(PUERTO_D)) PORTD = (PORTD & ~mascaraPuente(PUERTO_D)) | altosD;
+  SREG = sreg;
+}
+
+#else
+
+// Con el estado de interrupciones guardado: también se llama desde el ISR
+// del eco, donde interrupts() las habilitaría a destiempo
+void puenteAplicar(const OrdenPuente &o) {
+#if defined(__AVR__)
+  uint8_t sreg = SREG;
+  cli();
+#else
+  noInterrupts();
+#endif
+  if (!(avanceBloqueado && avanza(o))) {
+    digitalWrite(MOTOR_IZQ_IN1, entradaAdelante(o.sentidoIzq) ? HIGH : LOW);
+    digitalWrite(MOTOR_IZQ_IN2, entradaAtras(o.sentidoIzq) ? HIGH : LOW);
+    analogWrite(MOTOR_IZQ_ENA, o.pwmIzq);
+
+    digitalWrite(MOTOR_DER_IN3, entradaAdelante(o.sentidoDer) ? HIGH : LOW);
+    digitalWrite(MOTOR_DER_IN4, entradaAtras(o.sentidoDer) ? HIGH : LOW);
+    analogWrite(MOTOR_DER_ENB, o.pwmDer);
+  }
+#if defined(__AVR__)
+  SREG = sreg;
+#else
+  interrupts();
+#endif
+}
+
+#endif
+
+void puenteBloquearAvance(uint8_t freno) {
+  OrdenPuente orden = {PUENTE_FRENO, PUENTE_FRENO, freno, freno};
+  avanceBloqueado = true;
+  puenteAplicar(orden);
+}
+
+void puenteDesbloquearAvance() {
+  avanceBloqueado = false;
+}
+
+bool puenteAvanceBloqueado() {
+  return avanceBloqueado;
+}
@@ -0,0 +1,103 @@
+#include "recuperacion.h"
+#include "barrido.h"
+
+#define RETROCESO_OBSTACULO_MS 200
+#define RETROCESO_BLOQUEO_MS 400
+#define RETROCESO_TIEMPO_MS 500
+#ifndef RETROCESO_LARGO_MS
+#define RETROCESO_LARGO_MS 500
+#endif
+#define GIRO_SALIDA_GRADOS 90
+#ifndef RECUPERACION_SEGUIDOS_MS
+#define RECUPERACION_SEGUIDOS_MS 12000UL
+#endif
+
+struct Evento {
+  unsigned long tiempoMs;
+  int16_t xCm;
+  int16_t yCm;
+  int16_t rumboGrados;
+  uint8_t tipo;
+};
+
+static Evento historial[RECUPERACION_HISTORIAL];
+static uint8_t siguiente = 0;
+static uint8_t guardados = 0;
+static uint16_t estrategias[ESTRATEGIAS];
+
+static const uint16_t RETROCESO_TIPO_MS[EVENTOS] = {
+  RETROCESO_OBSTACULO_MS, RETROCESO_BLOQUEO_MS, RETROCESO_BLOQUEO_MS, RETROCESO_TIEMPO_MS
+};
+
+void recuperacionIniciar() {
+  siguiente = 0;
+  guardados = 0;
+  memset(estrategias, 0, sizeof(estrategias));
+}
+
+static int normalizarGrados(int grados) {
+  while (grados > 180) grados -= 360;
+  while (grados <= -180) grados += 360;
+  return grados;
+}
+
+// Eventos anteriores recientes a menos de RECUPERACION_RADIO_CM de e, con
+// su rumbo medio (media circular) en *rumboMedio
+static uint8_t eventosCerca(const Evento &e, float *rumboMedio) {
+  uint8_t n = 0;
+  float senos = 0, cosenos = 0;
+  for (uint8_t i = 0; i < guardados; i++) {
+    const Evento &h = historial[i];
+    if (e.tiempoMs - h.tiempoMs > RECUPERACION_VENTANA_MS) continue;
+    long dx = h.xCm - e.xCm;
+    long dy = h.yCm - e.yCm;
+    bool lejos = dx * dx + dy * dy > (long)RECUPERACION_RADIO_CM * RECUPERACION_RADIO_CM;
+    // Con un bloqueo de por medio la odometría no vale (patinaje): cuenta
+    // como mismo sitio si fue hace poco
+    bool patinaje = (h.tipo != EVENTO_OBSTACULO || e.tipo != EVENTO_OBSTACULO) &&
+                    e.tiempoMs - h.tiempoMs <= RECUPERACION_SEGUIDOS_MS;
+    if (lejos && !patinaje) continue;
+    senos += sin(h.rumboGrados * DEG_TO_RAD);
+    cosenos += cos(h.rumboGrados * DEG_TO_RAD);
+    n++;
+  }
+  *rumboMedio = n > 0 ? atan2(senos, cosenos) * RAD_TO_DEG : e.rumboGrados;
+  return n;
+}
+
+PlanRecuperacion recuperacionEvento(uint8_t tipo, const PoseOdometria &p) {
+  Evento e = {millis(), (int16_t)(p.xMm / 10), (int16_t)(p.yMm / 10),
+              (int16_t)(p.rumbo * RAD_TO_DEG), tipo};
+
+  float rumboMedio;
+  uint8_t cerca = eventosCerca(e, &rumboMedio);
+
+  historial[siguiente] = e;
+  siguiente = (siguiente + 1) % RECUPERACION_HISTORIAL;
+  if (guardados < RECUPERACION_HISTORIAL) guardados++;
+
+  PlanRecuperacion plan = {ESTRATEGIA_NORMAL, RETROCESO_TIPO_MS[tipo], 0};
+  if (cerca >= 2) {
+    plan.estrategia = (uint8_t)min(cerca - 1, (int)ESTRATEGIA_SALIR_PARED);
+    plan.retrocesoMs = RETROCESO_LARGO_MS;
+  }
+
+  if (plan.estrategia == ESTRATEGIA_MEDIA_VUELTA) {
+    // De espaldas al rumbo con el que se ha ido entrando en el rincón
+    plan.giroGrados = normalizarGrados((int)rumboMedio + 180 - e.rumboGrados);
+  } else if (plan.estrategia == ESTRATEGIA_SALIR_PARED) {
+    // Lateral con más sitio en el último barrido (sin dato cuenta como nada)
+    long izquierda = barridoDistancia(180, BARRIDO_SIN_LIMITE_EDAD);
+    long derecha = barridoDistancia(0, BARRIDO_SIN_LIMITE_EDAD);
+    plan.giroGrados = izquierda >= derecha ? GIRO_SALIDA_GRADOS : -GIRO_SALIDA_GRADOS;
+    guardados = 0;
+    siguiente = 0;
+  }
+
+  estrategias[plan.estrategia]++;
+  return plan;
+}
+
+uint16_t recuperacionEstrategias(EstrategiaRecuperacion estrategia) {
+  return estrategias[estrategia];
+}
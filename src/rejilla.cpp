@@ -0,0 +1,101 @@
+#include "rejilla.h"
+#include "odometria.h"
+
+#define CELDAS_POR_BYTE 4
+#define PASO_RAYO_CM (REJILLA_CELDA_CM / 2)
+
+// Peso de cada celda en la puntuación de una dirección
+#define PESO_DESCONOCIDA 3
+#define PESO_LIBRE 1
+#define PESO_VISITADA -2
+
+static uint8_t celdas[REJILLA_LADO * REJILLA_LADO / CELDAS_POR_BYTE];
+static uint16_t conocidas = 0;
+
+// Índice de celda, o -1 fuera de la rejilla
+static int16_t indice(float xCm, float yCm) {
+  int columna = (int)floor(xCm / REJILLA_CELDA_CM) + REJILLA_LADO / 2;
+  int fila = (int)floor(yCm / REJILLA_CELDA_CM) + REJILLA_LADO / 2;
+  if (columna < 0 || fila < 0 || columna >= REJILLA_LADO || fila >= REJILLA_LADO) return -1;
+  return fila * REJILLA_LADO + columna;
+}
+
+static uint8_t leer(int16_t i) {
+  return (celdas[i / CELDAS_POR_BYTE] >> ((i % CELDAS_POR_BYTE) * 2)) & 3;
+}
+
+static void escribir(int16_t i, uint8_t valor) {
+  uint8_t desplazamiento = (i % CELDAS_POR_BYTE) * 2;
+  uint8_t &b = celdas[i / CELDAS_POR_BYTE];
+  if (((b >> desplazamiento) & 3) == CELDA_DESCONOCIDA) conocidas++;
+  b = (b & ~(3 << desplazamiento)) | (valor << desplazamiento);
+}
+
+void rejillaIniciar() {
+  memset(celdas, 0, sizeof(celdas));
+  conocidas = 0;
+}
+
+void rejillaVisitar() {
+  PoseOdometria p = odometriaPose();
+  int16_t i = indice(p.xMm / 10, p.yMm / 10);
+  if (i >= 0) escribir(i, CELDA_VISITADA);
+}
+
+// Recorre el rayo en pasos de media celda desde la pose actual
+struct Rayo {
+  float x, y, dx, dy;
+};
+
+static Rayo rayoDesde(int anguloServo) {
+  PoseOdometria p = odometriaPose();
+  float direccion = p.rumbo + (anguloServo - 90) * DEG_TO_RAD;
+  Rayo r = {p.xMm / 10, p.yMm / 10, cos(direccion), sin(direccion)};
+  return r;
+}
+
+void rejillaObservar(int anguloServo, long distCm) {
+  long libre = min(distCm, (long)REJILLA_RAYO_MAX_CM);
+  Rayo r = rayoDesde(anguloServo);
+
+  // Lo recorrido queda libre; lo visitado y lo ocupado se respetan
+  for (long d = PASO_RAYO_CM; d < libre; d += PASO_RAYO_CM) {
+    int16_t i = indice(r.x + r.dx * d, r.y + r.dy * d);
+    if (i < 0) return;
+    if (leer(i) == CELDA_DESCONOCIDA) escribir(i, CELDA_LIBRE);
+  }
+  if (distCm <= REJILLA_RAYO_MAX_CM) {
+    int16_t i = indice(r.x + r.dx * distCm, r.y + r.dy * distCm);
+    if (i >= 0 && leer(i) != CELDA_VISITADA) escribir(i, CELDA_OCUPADA);
+  }
+}
+
+int rejillaPuntuacion(int anguloServo, long distCm) {
+  long alcance = min(distCm, (long)REJILLA_RAYO_MAX_CM);
+  Rayo r = rayoDesde(anguloServo);
+  int puntos = 0;
+  int16_t anterior = -1;
+
+  for (long d = PASO_RAYO_CM; d < alcance; d += PASO_RAYO_CM) {
+    int16_t i = indice(r.x + r.dx * d, r.y + r.dy * d);
+    if (i < 0) break;
+    if (i == anterior) continue;  // Cada celda cuenta una vez
+    anterior = i;
+    switch (leer(i)) {
+      case CELDA_DESCONOCIDA: puntos += PESO_DESCONOCIDA; break;
+      case CELDA_LIBRE:       puntos += PESO_LIBRE; break;
+      case CELDA_VISITADA:    puntos += PESO_VISITADA; break;
+      default:                return puntos;  // Ocupada: no se sigue
+    }
+  }
+  return puntos;
+}
+
+uint8_t rejillaCelda(float xCm, float yCm) {
+  int16_t i = indice(xCm, yCm);
+  return i >= 0 ? leer(i) : (uint8_t)CELDA_DESCONOCIDA;
+}
+
+uint16_t rejillaConocidas() {
+  return conocidas;
+}
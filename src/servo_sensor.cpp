@@ -0,0 +1,73 @@
+#include "servo_sensor.h"
+#include "parametros.h"
+#include <Servo.h>
+
+#if MOTOR_IZQ_ENA == 9 || MOTOR_IZQ_ENA == 10 || MOTOR_DER_ENB == 9 || MOTOR_DER_ENB == 10
+#error "los pines 9 y 10 no tienen PWM con el Servo (Timer1)"
+#endif
+
+static Servo servo;
+
+// Movimiento en curso: de origen a destino desde la orden en inicioMs
+static int16_t origen = 90;
+static int16_t destino = 90;
+static unsigned long inicioMs = 0;
+static unsigned long asentadoMs = 0;
+
+static unsigned long recorridoMs(int grados) {
+  return (unsigned long)grados * 1000UL / (uint16_t)parametros[PARAM_SERVO_GRADOS_S];
+}
+
+void servoIniciar(int angulo) {
+  servo.attach(SERVO_PIN);
+  servo.write(angulo);
+  origen = angulo;
+  destino = angulo;
+  inicioMs = millis();
+  asentadoMs = inicioMs + SERVO_RETARDO_MS + recorridoMs(180) + SERVO_ASENTAMIENTO_MS;
+}
+
+void servoMover(int angulo) {
+  angulo = constrain(angulo, 0, 180);
+  if (angulo == destino) return;
+  unsigned long ahora = millis();
+  int anterior = destino;
+  origen = servoAnguloEn(ahora);
+  destino = angulo;
+  inicioMs = ahora;
+  servo.write(angulo);
+  // A medio camino el eje real puede ir por delante de la estimación
+  // (servo_grados_s es de menos), hasta el destino anterior: se cuenta el
+  // peor recorrido
+  int recorrido = max(abs(destino - origen), abs(destino - anterior));
+  asentadoMs = ahora + SERVO_RETARDO_MS + recorridoMs(recorrido) + SERVO_ASENTAMIENTO_MS;
+}
+
+int servoAnguloPedido() {
+  return destino;
+}
+
+int servoAnguloEn(unsigned long ms) {
+  long movido = (long)(ms - inicioMs) - SERVO_RETARDO_MS;
+  if (movido <= 0) return origen;
+  long grados = movido * (uint16_t)parametros[PARAM_SERVO_GRADOS_S] / 1000L;
+  if (grados >= abs(destino - origen)) return destino;
+  return destino > origen ? origen + grados : origen - grados;
+}
+
+int servoAnguloEstimado() {
+  return servoAnguloEn(millis());
+}
+
+bool servoAsentado() {
+  return (long)(millis() - asentadoMs) >= 0;
+}
+
+unsigned long servoAsentadoMs() {
+  return asentadoMs;
+}
+
+unsigned long servoEtaMs() {
+  long falta = (long)(asentadoMs - millis());
+  return falta > 0 ? (unsigned long)falta : 0;
+}
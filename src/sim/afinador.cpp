@@ -0,0 +1,385 @@
+#include "afinador.h"
+#include "benchmark.h"
+#include "parametros.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Espacio de búsqueda: parámetro de parametros.h, su #define en
+// configuracion.h y el rango que se prueba (dentro del de la consola)
+struct Dimension {
+  const char *parametro;
+  const char *macro;
+  int16_t minimo, maximo;
+};
+
+static const Dimension ESPACIO[] = {
+  {"distancia_critica", "DISTANCIA_CRITICA", 8, 30},
+  {"ttc_minimo_ms", "TTC_MINIMO_MS", 300, 1200},
+  {"velocidad_minima", "VELOCIDAD_MINIMA", 70, 150},
+  {"velocidad_maxima", "VELOCIDAD_MAXIMA", 150, 255},
+  {"velocidad_retroceso", "VELOCIDAD_RETROCESO", 100, 220},
+  {"velocidad_giro", "VELOCIDAD_GIRO", 90, 200},
+  {"giro_diagonal_grados", "GIRO_DIAGONAL_GRADOS", 40, 80},
+  {"periodo_medir_ms", "PERIODO_MEDIR_MS", 80, 250},
+  {"freno_pwm", "FRENO_PWM", 0, 255},
+  {"bloqueo_ms", "BLOQUEO_MS", 1000, 4000},
+  {"atasco_lecturas", "ATASCO_LECTURAS", 1, 8},
+  {"atasco_ventana_ms", "ATASCO_VENTANA_MS", 5000, 20000},
+};
+
+#define DIMENSIONES (sizeof(ESPACIO) / sizeof(ESPACIO[0]))
+#define MUTACION_SIGMA 0.1  // Desviación de una perturbación, en fracción del rango
+
+struct Candidato {
+  int16_t valores[DIMENSIONES];
+  bool valido = true;
+  double velMediaCmS = 0;
+  double colisiones = 0;      // Por misión
+  double escapeMedioS = 0;
+  double coberturaM2Min = 0;
+  unsigned frente = 0;        // 1 = no dominado (Pareto), 0 = alguna misión falló
+};
+
+struct Mision {
+  std::string mapa;
+  uint32_t semilla;
+};
+
+struct Medida {
+  bool ok = false;
+  double velMediaCmS, colisiones, escapeMedioS, coberturaM2Min;
+};
+
+// ---- Reparto con robo de trabajo ----
+
+// Una cola por hilo: cada uno saca de la suya por detrás y, vacía, roba la
+// tarea más antigua de otra. Las misiones duran muy distinto (el mapa, los
+// atascos, los parámetros), así que un reparto fijo deja hilos parados.
+class ColasTrabajo {
+ public:
+  explicit ColasTrabajo(size_t hilos) : colas(hilos) {}
+
+  void poner(size_t hilo, size_t tarea) {
+    std::lock_guard<std::mutex> cerrojo(colas[hilo].m);
+    colas[hilo].tareas.push_back(tarea);
+  }
+
+  bool sacar(size_t hilo, size_t &tarea) {
+    {
+      Cola &propia = colas[hilo];
+      std::lock_guard<std::mutex> cerrojo(propia.m);
+      if (!propia.tareas.empty()) {
+        tarea = propia.tareas.back();
+        propia.tareas.pop_back();
+        return true;
+      }
+    }
+    for (size_t i = 1; i < colas.size(); i++) {
+      Cola &otra = colas[(hilo + i) % colas.size()];
+      std::lock_guard<std::mutex> cerrojo(otra.m);
+      if (!otra.tareas.empty()) {
+        tarea = otra.tareas.front();
+        otra.tareas.pop_front();
+        robos++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  unsigned robadas() const { return robos; }
+
+ private:
+  struct Cola {
+    std::mutex m;
+    std::deque<size_t> tareas;
+  };
+  std::vector<Cola> colas;
+  std::atomic<unsigned> robos{0};
+};
+
+// ---- Misiones ----
+
+static std::vector<Mision> misiones(unsigned semillas) {
+  std::vector<Mision> m;
+  for (const CasoBenchmark &c : benchmarkCasos(semillas)) m.push_back({c.mapa, c.semilla});
+  return m;
+}
+
+// Lanza robot_sim --csv con los parámetros del candidato y lee su fila
+static Medida medir(const OpcionesAfinado &o, const Candidato &c, const Mision &m) {
+  char segundos[32];
+  snprintf(segundos, sizeof(segundos), "%g", o.segundos);
+  std::string orden = "'" + o.ejecutable + "' --csv --mapa " + m.mapa + " --semilla " +
+                      std::to_string(m.semilla) + " --segundos " + segundos;
+  for (size_t d = 0; d < DIMENSIONES; d++) {
+    orden += std::string(" --param ") + ESPACIO[d].parametro + "=" + std::to_string(c.valores[d]);
+  }
+  orden += " 2>/dev/null";
+
+  Medida r;
+  FILE *f = popen(orden.c_str(), "r");
+  if (!f) return r;
+  char linea[512];
+  std::string ultima;
+  while (fgets(linea, sizeof(linea), f)) ultima = linea;
+  if (pclose(f) != 0) return r;
+
+  // Columnas de benchmarkFilaCsv()
+  std::vector<double> campos;
+  size_t inicio = ultima.find(',');
+  if (ultima.compare(0, inicio, m.mapa) != 0) return r;
+  while (inicio != std::string::npos) {
+    campos.push_back(atof(ultima.c_str() + inicio + 1));
+    inicio = ultima.find(',', inicio + 1);
+  }
+  if (campos.size() < 14) return r;
+  r.ok = true;
+  r.velMediaCmS = campos[2];
+  r.colisiones = campos[6];
+  r.escapeMedioS = campos[8];
+  r.coberturaM2Min = campos[13];
+  return r;
+}
+
+// Todas las misiones de los candidatos desde "desde", repartidas por los hilos
+static void evaluar(const OpcionesAfinado &o, unsigned hilos, const std::vector<Mision> &lista,
+                    std::vector<Candidato> &candidatos, size_t desde) {
+  auto inicio = std::chrono::steady_clock::now();
+  const size_t n = (candidatos.size() - desde) * lista.size();
+  std::vector<Medida> medidas(n);
+  ColasTrabajo colas(hilos);
+  for (size_t t = 0; t < n; t++) colas.poner(t % hilos, t);
+
+  std::vector<std::thread> grupo;
+  for (unsigned h = 0; h < hilos; h++) {
+    grupo.emplace_back([&, h]() {
+      size_t t;
+      while (colas.sacar(h, t)) {
+        medidas[t] = medir(o, candidatos[desde + t / lista.size()], lista[t % lista.size()]);
+      }
+    });
+  }
+  for (std::thread &h : grupo) h.join();
+
+  for (size_t i = desde; i < candidatos.size(); i++) {
+    Candidato &c = candidatos[i];
+    for (size_t j = 0; j < lista.size(); j++) {
+      const Medida &m = medidas[(i - desde) * lista.size() + j];
+      if (!m.ok) {
+        c.valido = false;
+        continue;
+      }
+      c.velMediaCmS += m.velMediaCmS / lista.size();
+      c.colisiones += m.colisiones / lista.size();
+      c.escapeMedioS += m.escapeMedioS / lista.size();
+      c.coberturaM2Min += m.coberturaM2Min / lista.size();
+    }
+  }
+  double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+  fprintf(stderr, "%zu candidatos x %zu misiones en %u hilos: %.1f s (%u tareas robadas)\n",
+          candidatos.size() - desde, lista.size(), hilos, s, colas.robadas());
+}
+
+// ---- Búsqueda ----
+
+static int dimension(const char *parametro) {
+  for (size_t d = 0; d < DIMENSIONES; d++) {
+    if (strcmp(ESPACIO[d].parametro, parametro) == 0) return (int)d;
+  }
+  return -1;
+}
+
+// Combinaciones que el firmware no admite
+// (las parejas de parametros.h; emergencia_cm queda en su valor)
+static void reparar(Candidato &c) {
+  int minima = dimension("velocidad_minima"), maxima = dimension("velocidad_maxima");
+  if (c.valores[minima] > c.valores[maxima]) std::swap(c.valores[minima], c.valores[maxima]);
+  int critica = dimension("distancia_critica");
+  int16_t emergencia = parametros[PARAM_EMERGENCIA_CM];
+  if (emergencia != 0 && c.valores[critica] <= emergencia) c.valores[critica] = emergencia + 1;
+}
+
+static Candidato sortear(std::mt19937 &rng) {
+  Candidato c;
+  for (size_t d = 0; d < DIMENSIONES; d++) {
+    std::uniform_int_distribution<int> valor(ESPACIO[d].minimo, ESPACIO[d].maximo);
+    c.valores[d] = (int16_t)valor(rng);
+  }
+  reparar(c);
+  return c;
+}
+
+// Cada dimensión cambia con probabilidad 1/2 (al menos una)
+static Candidato perturbar(const Candidato &origen, std::mt19937 &rng) {
+  Candidato c;
+  std::copy(origen.valores, origen.valores + DIMENSIONES, c.valores);
+  std::bernoulli_distribution cambia(0.5);
+  std::normal_distribution<double> salto(0, MUTACION_SIGMA);
+  std::uniform_int_distribution<size_t> alguna(0, DIMENSIONES - 1);
+  size_t obligada = alguna(rng);
+  for (size_t d = 0; d < DIMENSIONES; d++) {
+    if (d != obligada && !cambia(rng)) continue;
+    const Dimension &e = ESPACIO[d];
+    long v = lround(c.valores[d] + salto(rng) * (e.maximo - e.minimo));
+    c.valores[d] = (int16_t)std::min<long>(std::max<long>(v, e.minimo), e.maximo);
+  }
+  reparar(c);
+  return c;
+}
+
+static bool domina(const Candidato &a, const Candidato &b) {
+  return a.velMediaCmS >= b.velMediaCmS && a.colisiones <= b.colisiones &&
+         (a.velMediaCmS > b.velMediaCmS || a.colisiones < b.colisiones);
+}
+
+// Frentes sucesivos: el 1 no lo domina nadie, el 2 solo los del 1...
+static void clasificar(std::vector<Candidato> &candidatos) {
+  size_t quedan = 0;
+  for (Candidato &c : candidatos) {
+    c.frente = 0;
+    if (c.valido) quedan++;
+  }
+  for (unsigned frente = 1; quedan > 0; frente++) {
+    std::vector<size_t> este;
+    for (size_t i = 0; i < candidatos.size(); i++) {
+      if (!candidatos[i].valido || candidatos[i].frente != 0) continue;
+      bool dominado = false;
+      for (size_t j = 0; j < candidatos.size() && !dominado; j++) {
+        const Candidato &otro = candidatos[j];
+        dominado = otro.valido && otro.frente == 0 && domina(otro, candidatos[i]);
+      }
+      if (!dominado) este.push_back(i);
+    }
+    for (size_t i : este) candidatos[i].frente = frente;
+    quedan -= este.size();
+  }
+}
+
+// Por frente y, dentro de cada uno, de menos colisiones a más velocidad
+static bool antes(const Candidato *a, const Candidato *b) {
+  if ((a->frente == 0) != (b->frente == 0)) return b->frente == 0;
+  if (a->frente != b->frente) return a->frente < b->frente;
+  return a->colisiones < b->colisiones;
+}
+
+// El más rápido del frente sin más colisiones que configuracion.h; si no
+// hay ninguno, el de menos colisiones
+static const Candidato *elegir(const std::vector<const Candidato *> &orden, const Candidato &defecto) {
+  const Candidato *mejor = nullptr;
+  for (const Candidato *c : orden) {
+    if (c->frente != 1 || c->colisiones > defecto.colisiones) continue;
+    if (!mejor || c->velMediaCmS > mejor->velMediaCmS) mejor = c;
+  }
+  return mejor ? mejor : orden.front();
+}
+
+static bool escribirCabecera(const OpcionesAfinado &o, size_t nMisiones,
+                             const std::vector<const Candidato *> &orden, const Candidato &defecto,
+                             const Candidato &elegido) {
+  FILE *f = fopen(o.salida.c_str(), "w");
+  if (!f) return false;
+  fprintf(f, "// Generado por robot_sim --afinar: %zu candidatos, %zu misiones de %g s cada uno.\n",
+          orden.size(), nMisiones, o.segundos);
+  fprintf(f, "// Frente de Pareto (velocidad media en cm/s, colisiones por misión):\n");
+  for (const Candidato *c : orden) {
+    if (c->frente != 1) break;
+    fprintf(f, "//   %5.2f %6.2f ", c->velMediaCmS, c->colisiones);
+    for (size_t d = 0; d < DIMENSIONES; d++) fprintf(f, " %s=%d", ESPACIO[d].parametro, c->valores[d]);
+    fprintf(f, "%s\n", c == &elegido ? "  <- elegido" : "");
+  }
+  fprintf(f, "// configuracion.h: %.2f cm/s, %.2f colisiones. Elegido: el más rápido\n"
+             "// del frente sin más colisiones (o, si no hay, el de menos).\n",
+          defecto.velMediaCmS, defecto.colisiones);
+  fprintf(f, "#ifndef AFINADO_H\n#define AFINADO_H\n\n");
+  for (size_t d = 0; d < DIMENSIONES; d++) {
+    fprintf(f, "#define %s %d\n", ESPACIO[d].macro, elegido.valores[d]);
+  }
+  fprintf(f, "\n#endif\n");
+  return fclose(f) == 0;
+}
+
+int afinarParametros(const OpcionesAfinado &o) {
+  // Los valores por defecto son los de parametros.h en este mismo binario
+  parametrosIniciar();
+  Candidato defecto;
+  for (size_t d = 0; d < DIMENSIONES; d++) {
+    const Dimension &e = ESPACIO[d];
+    int8_t id = parametroBuscar(e.parametro);
+    if (id < 0 || e.minimo < parametroMinimo(id) || e.maximo > parametroMaximo(id)) {
+      fprintf(stderr, "afinador: %s no existe o se sale de su rango\n", e.parametro);
+      return 2;
+    }
+    defecto.valores[d] = parametros[id];
+  }
+
+  unsigned hilos = o.hilos ? o.hilos : std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<Mision> lista = misiones(o.semillas);
+  std::mt19937 rng(o.semilla);
+
+  // Primera mitad: configuracion.h y sorteo uniforme
+  std::vector<Candidato> candidatos;
+  candidatos.push_back(defecto);
+  unsigned sorteados = std::max(o.candidatos / 2, 1u);
+  while (candidatos.size() < sorteados) candidatos.push_back(sortear(rng));
+  evaluar(o, hilos, lista, candidatos, 0);
+  if (!candidatos[0].valido) {
+    fprintf(stderr, "afinador: fallan las misiones con configuracion.h (¿%s?)\n",
+            o.ejecutable.c_str());
+    return 1;
+  }
+
+  // Segunda mitad: alrededor del frente
+  clasificar(candidatos);
+  std::vector<size_t> frente;
+  for (size_t i = 0; i < candidatos.size(); i++) {
+    if (candidatos[i].frente == 1) frente.push_back(i);
+  }
+  size_t desde = candidatos.size();
+  std::uniform_int_distribution<size_t> padre(0, frente.size() - 1);
+  while (candidatos.size() < o.candidatos) {
+    candidatos.push_back(perturbar(candidatos[frente[padre(rng)]], rng));
+  }
+  if (candidatos.size() > desde) evaluar(o, hilos, lista, candidatos, desde);
+  clasificar(candidatos);
+
+  std::vector<const Candidato *> orden;
+  for (const Candidato &c : candidatos) orden.push_back(&c);
+  std::stable_sort(orden.begin(), orden.end(), antes);
+  const Candidato &elegido = *elegir(orden, candidatos[0]);
+
+  printf("candidato,frente,vel_media_cm_s,colisiones,escape_medio_s,cobertura_m2_min");
+  for (size_t d = 0; d < DIMENSIONES; d++) printf(",%s", ESPACIO[d].parametro);
+  printf("\n");
+  for (const Candidato *c : orden) {
+    printf("%zu,%u,%.2f,%.2f,%.2f,%.3f", (size_t)(c - &candidatos[0]), c->frente, c->velMediaCmS,
+           c->colisiones, c->escapeMedioS, c->coberturaM2Min);
+    for (size_t d = 0; d < DIMENSIONES; d++) printf(",%d", c->valores[d]);
+    printf("\n");
+  }
+
+  fprintf(stderr, "configuracion.h: %.2f cm/s, %.2f colisiones; elegido (candidato %zu): "
+                  "%.2f cm/s, %.2f colisiones\n",
+          candidatos[0].velMediaCmS, candidatos[0].colisiones, (size_t)(&elegido - &candidatos[0]),
+          elegido.velMediaCmS, elegido.colisiones);
+  if (!o.salida.empty()) {
+    if (!escribirCabecera(o, lista.size(), orden, candidatos[0], elegido)) {
+      fprintf(stderr, "no se puede escribir %s\n", o.salida.c_str());
+      return 2;
+    }
+    fprintf(stderr, "cabecera en %s\n", o.salida.c_str());
+  }
+  return 0;
+}
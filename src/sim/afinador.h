@@ -0,0 +1,29 @@
+#ifndef AFINADOR_H
+#define AFINADOR_H
+
+// Afinador de parámetros (robot_sim --afinar): busca valores de
+// parametros.h con más velocidad media y menos colisiones sobre el corpus
+// del banco. El firmware es todo estado global, así que cada misión es un
+// proceso robot_sim aparte (--csv --param ...) y un grupo de hilos con robo
+// de trabajo los reparte por los núcleos. La primera mitad de los
+// candidatos se sortea en todo el rango; la segunda perturba los del frente
+// de Pareto de la primera. Escribe por stdout los candidatos ordenados por
+// frente y, si se pide, una cabecera afinado.h con el elegido que
+// configuracion.h incluye si está en include/.
+
+#include <stdint.h>
+#include <string>
+
+struct OpcionesAfinado {
+  std::string ejecutable;     // robot_sim que ejecuta las misiones
+  unsigned candidatos = 64;   // Incluido el de configuracion.h
+  unsigned hilos = 0;         // 0 = uno por núcleo
+  double segundos = 120;      // Por misión
+  unsigned semillas = 0;      // 0 = corpus del banco; N = cada mapa con las semillas 1..N
+  uint32_t semilla = 1;       // Del sorteo de candidatos
+  std::string salida;         // Cabecera afinado.h ("" = no se escribe)
+};
+
+int afinarParametros(const OpcionesAfinado &opciones);
+
+#endif
@@ -0,0 +1,677 @@
+#include "benchmark.h"
+#include "mision.h"
+#include "motores.h"
+#include "encoders.h"
+#include "parametros.h"
+#include "calibracion.h"
+#include "navegacion.h"
+#include "frenada.h"
+#include "emergencia.h"
+#include "telemetros.h"
+#include "servo_sensor.h"
+#include "barrido.h"
+#include "hal_nativo.h"
+
+#include <math.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Corpus fijo: cambiarlo invalida la comparación con resultados anteriores
+static const CasoBenchmark CORPUS[] = {
+  {"sala", 1}, {"sala", 2}, {"sala", 3},
+  {"pasillo", 1}, {"pasillo", 2}, {"pasillo", 3},
+  {"callejon", 1}, {"callejon", 2}, {"callejon", 3},
+  {"puertas", 1}, {"puertas", 2}, {"puertas", 3},
+  {"obstaculos", 1}, {"obstaculos", 2}, {"obstaculos", 3},
+  {"obstaculos", 4}, {"obstaculos", 5},
+};
+
+const CasoBenchmark *benchmarkCorpus(size_t *casos) {
+  *casos = sizeof(CORPUS) / sizeof(CORPUS[0]);
+  return CORPUS;
+}
+
+std::vector<CasoBenchmark> benchmarkCasos(unsigned semillas) {
+  size_t casos = sizeof(CORPUS) / sizeof(CORPUS[0]);
+  if (semillas == 0) return std::vector<CasoBenchmark>(CORPUS, CORPUS + casos);
+  std::vector<CasoBenchmark> lista;
+  for (size_t i = 0; i < casos; i++) {
+    // Cada mapa una vez, en el orden del corpus
+    if (i > 0 && strcmp(CORPUS[i].mapa, CORPUS[i - 1].mapa) == 0) continue;
+    for (uint32_t s = 1; s <= semillas; s++) lista.push_back({CORPUS[i].mapa, s});
+  }
+  return lista;
+}
+
+void benchmarkCabeceraCsv() {
+  printf("mapa,semilla,segundos,vel_media_cm_s,fraccion_detenido,escaneos_bloqueantes,"
+         "latencia_escaneo_ms,colisiones,paradas,escape_medio_s,escape_max_s,"
+         "rec_bloqueo,rec_atasco,rec_tiempo,cobertura_m2_min,error_odometria_cm,"
+         "error_servo_max_grados,error_servo_mov_grados,corriente_pico_a,emergencias,"
+         "latencia_emergencia_max_us\n");
+}
+
+void benchmarkFilaCsv(const ResultadoMision &r) {
+  printf("%s,%u,%.1f,%.2f,%.3f,%u,%.0f,%u,%u,%.2f,%.1f,%u,%u,%u,%.3f,%.1f,%.1f,%.1f,%.2f,%u,%.0f\n",
+         r.mapa.c_str(), r.semilla, r.segundos, r.velMediaCmS, r.fraccionDetenido,
+         r.escaneosBloqueantes, r.latenciaEscaneoMs, r.colisiones, r.paradas,
+         r.escapeMedioS, r.escapeMaxS, r.recBloqueo, r.recAtasco, r.recTiempo,
+         r.coberturaM2Min, r.errorOdometriaCm, r.errorServoMaxGrados, r.errorServoMovGrados,
+         r.corrientePicoA, r.emergencias, r.latenciaEmergenciaMaxUs);
+}
+
+static void imprimirJson(const ResultadoMision &r, bool ultima) {
+  printf("    {\"mapa\": \"%s\", \"semilla\": %u, \"segundos\": %.1f, "
+         "\"vel_media_cm_s\": %.2f, \"fraccion_detenido\": %.3f, "
+         "\"escaneos_bloqueantes\": %u, \"latencia_escaneo_ms\": %.0f, \"colisiones\": %u, \"paradas\": %u, "
+         "\"escape_medio_s\": %.2f, \"escape_max_s\": %.1f, "
+         "\"rec_bloqueo\": %u, \"rec_atasco\": %u, \"rec_tiempo\": %u, "
+         "\"cobertura_m2_min\": %.3f, \"error_odometria_cm\": %.1f, "
+         "\"error_servo_max_grados\": %.1f, \"error_servo_mov_grados\": %.1f, "
+         "\"corriente_pico_a\": %.2f, \"emergencias\": %u, "
+         "\"latencia_emergencia_max_us\": %.0f}%s\n",
+         r.mapa.c_str(), r.semilla, r.segundos, r.velMediaCmS, r.fraccionDetenido,
+         r.escaneosBloqueantes, r.latenciaEscaneoMs, r.colisiones, r.paradas,
+         r.escapeMedioS, r.escapeMaxS, r.recBloqueo, r.recAtasco, r.recTiempo, r.coberturaM2Min,
+         r.errorOdometriaCm, r.errorServoMaxGrados, r.errorServoMovGrados, r.corrientePicoA,
+         r.emergencias, r.latenciaEmergenciaMaxUs, ultima ? "" : ",");
+}
+
+int benchmarkEjecutar(FormatoBenchmark formato, double segundos, unsigned semillas) {
+  std::vector<ResultadoMision> resultados;
+  ResultadoMision media = {"media", 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+  for (const CasoBenchmark &c : benchmarkCasos(semillas)) {
+    Mapa mapa;
+    if (!simMapaPorNombre(c.mapa, c.semilla, mapa)) {
+      fprintf(stderr, "mapa desconocido en el corpus: %s\n", c.mapa);
+      return 1;
+    }
+    ResultadoMision r = ejecutarMision(mapa, c.semilla, segundos);
+    resultados.push_back(r);
+
+    media.segundos += r.segundos;
+    media.velMediaCmS += r.velMediaCmS;
+    media.fraccionDetenido += r.fraccionDetenido;
+    media.escaneosBloqueantes += r.escaneosBloqueantes;
+    media.latenciaEscaneoMs += r.latenciaEscaneoMs;
+    media.colisiones += r.colisiones;
+    media.paradas += r.paradas;
+    media.escapeMedioS += r.escapeMedioS;
+    if (r.escapeMaxS > media.escapeMaxS) media.escapeMaxS = r.escapeMaxS;
+    media.recBloqueo += r.recBloqueo;
+    media.recAtasco += r.recAtasco;
+    media.recTiempo += r.recTiempo;
+    media.coberturaM2Min += r.coberturaM2Min;
+    media.errorOdometriaCm += r.errorOdometriaCm;
+    if (r.errorServoMaxGrados > media.errorServoMaxGrados) media.errorServoMaxGrados = r.errorServoMaxGrados;
+    media.errorServoMovGrados += r.errorServoMovGrados;
+    if (r.corrientePicoA > media.corrientePicoA) media.corrientePicoA = r.corrientePicoA;
+    media.emergencias += r.emergencias;
+    if (r.latenciaEmergenciaMaxUs > media.latenciaEmergenciaMaxUs) {
+      media.latenciaEmergenciaMaxUs = r.latenciaEmergenciaMaxUs;
+    }
+    media.tiempoRealS += r.tiempoRealS;
+  }
+
+  // Promedios en los valores continuos; los contadores quedan como totales
+  double n = (double)resultados.size();
+  media.segundos /= n;
+  media.velMediaCmS /= n;
+  media.fraccionDetenido /= n;
+  media.latenciaEscaneoMs /= n;
+  media.escapeMedioS /= n;
+  media.coberturaM2Min /= n;
+  media.errorOdometriaCm /= n;
+  media.errorServoMovGrados /= n;
+
+  if (formato == BENCH_CSV) {
+    benchmarkCabeceraCsv();
+    for (const ResultadoMision &r : resultados) benchmarkFilaCsv(r);
+    benchmarkFilaCsv(media);
+  } else {
+    printf("{\n  \"misiones\": [\n");
+    for (size_t i = 0; i < resultados.size(); i++) {
+      imprimirJson(resultados[i], i + 1 == resultados.size());
+    }
+    printf("  ],\n  \"resumen\":\n");
+    imprimirJson(media, true);
+    printf("}\n");
+  }
+
+  fprintf(stderr, "%zu misiones en %.2f s de CPU\n", resultados.size(), media.tiempoRealS);
+  return 0;
+}
+
+// ---- Giros ----
+
+static const int GIROS[] = {30, 45, 60, 90, 135, 180, -30, -45, -60, -90, -135, -180};
+
+#define GIROS_ESPERA_US 500000ULL  // Tras terminar, hasta que las ruedas paran
+
+int benchmarkGiros(FormatoBenchmark formato) {
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+
+  if (formato == BENCH_CSV) {
+    printf("pedido_grados,real_grados,error_grados,tiempo_ms\n");
+  } else {
+    printf("{\n  \"giros\": [\n");
+  }
+
+  double sumaError = 0, maxError = 0, sumaTiempo = 0;
+  const size_t n = sizeof(GIROS) / sizeof(GIROS[0]);
+  for (size_t i = 0; i < n; i++) {
+    simIniciar(vacio, 1);
+    parametrosIniciar();  // Sin setup(): velocidades por defecto
+    motoresIniciar();
+    encodersIniciar();
+
+    // Mismo periodo de control que la tarea del firmware
+    const unsigned long periodoUs = MOTORES_PERIODO_CONTROL_MS * 1000UL;
+    girarGrados(GIROS[i]);
+    unsigned long long inicio = simRelojUs();
+    while (motoresGirando() && simRelojUs() - inicio < 5000000ULL) {
+      simAvanzarUs(periodoUs);
+      motoresControlar();
+    }
+    double tiempoMs = (simRelojUs() - inicio) / 1000.0;
+    simAvanzarUs(GIROS_ESPERA_US);
+
+    double real = simEstado().rumbo * 180.0 / M_PI;
+    double error = real - GIROS[i];
+    sumaError += fabs(error);
+    sumaTiempo += tiempoMs;
+    if (fabs(error) > maxError) maxError = fabs(error);
+
+    if (formato == BENCH_CSV) {
+      printf("%d,%.1f,%.1f,%.0f\n", GIROS[i], real, error, tiempoMs);
+    } else {
+      printf("    {\"pedido_grados\": %d, \"real_grados\": %.1f, \"error_grados\": %.1f, "
+             "\"tiempo_ms\": %.0f}%s\n", GIROS[i], real, error, tiempoMs, i + 1 == n ? "" : ",");
+    }
+  }
+
+  if (formato == BENCH_JSON) {
+    printf("  ],\n  \"resumen\": {\"error_medio_grados\": %.1f, \"error_max_grados\": %.1f, "
+           "\"tiempo_medio_ms\": %.0f}\n}\n", sumaError / n, maxError, sumaTiempo / n);
+  }
+  fprintf(stderr, "error medio %.1f° (máx %.1f°), %.0f ms por giro\n",
+          sumaError / n, maxError, sumaTiempo / n);
+  return 0;
+}
+
+// ---- Frenada e inversión ----
+
+static const int FRENOS_PWM[] = {0, 160, 255};
+static const int VELOCIDADES_FRENADA[] = {100, 150, 200, 255};
+
+#define FRENADA_MARCHA_US 1500000ULL  // Hasta velocidad de crucero
+#define FRENADA_PARADA_US 1000000ULL
+
+static void controlarDurante(unsigned long long us) {
+  const unsigned long periodoUs = MOTORES_PERIODO_CONTROL_MS * 1000UL;
+  unsigned long long inicio = simRelojUs();
+  while (simRelojUs() - inicio < us) {
+    simAvanzarUs(periodoUs);
+    motoresControlar();
+  }
+}
+
+static double avanceCm(float x0, float y0) {
+  return hypot(simEstado().x - x0, simEstado().y - y0);
+}
+
+// Pico de corriente de un motor al pasar de velocidad a marcha atrás, por
+// el perfil de motores.h o directa en lazo abierto
+static void inversion(int freno, bool directa, double *marchaA, double *totalA) {
+  Mapa vacio = {"vacio", 1000, 1000, 200, 500, 0, {}};
+  simIniciar(vacio, 1);
+  parametrosIniciar();
+  parametroFijar(PARAM_FRENO_PWM, freno);
+  motoresIniciar();
+  encodersIniciar();
+  if (directa) {
+    motoresLazoAbierto(255, 255);
+  } else {
+    avanzarConVelocidad(255);
+  }
+  controlarDurante(FRENADA_MARCHA_US);
+  *marchaA = simEstado().corrientePicoA;
+  if (directa) {
+    motoresLazoAbierto(-parametros[PARAM_VELOCIDAD_RETROCESO], -parametros[PARAM_VELOCIDAD_RETROCESO]);
+  } else {
+    retroceder();
+  }
+  controlarDurante(FRENADA_PARADA_US);
+  *totalA = simEstado().corrientePicoA;
+}
+
+struct FilaFrenada {
+  int freno, velocidad, vMmS;
+  double realMm;
+  int previstoInicialMm, previstoMm;
+};
+
+int benchmarkFrenada(FormatoBenchmark formato) {
+  const size_t nFrenos = sizeof(FRENOS_PWM) / sizeof(FRENOS_PWM[0]);
+  const size_t nVel = sizeof(VELOCIDADES_FRENADA) / sizeof(VELOCIDADES_FRENADA[0]);
+  std::vector<FilaFrenada> filas;
+  double errorInicial = 0, errorAprendido = 0;
+  for (size_t f = 0; f < nFrenos; f++) {
+    // Recinto largo: dos pasadas por todas las velocidades sin girar, la
+    // primera con el modelo por defecto y la segunda con lo aprendido
+    Mapa vacio = {"vacio", 4000, 1000, 100, 500, 0, {}};
+    simIniciar(vacio, 1);
+    parametrosIniciar();
+    parametroFijar(PARAM_FRENO_PWM, FRENOS_PWM[f]);
+    motoresIniciar();
+    encodersIniciar();
+
+    size_t primera = filas.size();
+    for (int pasada = 0; pasada < 2; pasada++) {
+      for (size_t i = 0; i < nVel; i++) {
+        avanzarConVelocidad(VELOCIDADES_FRENADA[i]);
+        controlarDurante(FRENADA_MARCHA_US);
+        int vMmS = (encoderVelocidadMmS(ENCODER_IZQ) + encoderVelocidadMmS(ENCODER_DER)) / 2;
+        int previsto = frenadaDistanciaMm(vMmS);
+        float x0 = simEstado().x, y0 = simEstado().y;
+        detener();
+        controlarDurante(FRENADA_PARADA_US);
+        double real = avanceCm(x0, y0) * 10.0;
+        if (pasada == 0) {
+          filas.push_back({FRENOS_PWM[f], VELOCIDADES_FRENADA[i], vMmS, real, previsto, 0});
+          continue;
+        }
+        FilaFrenada &fila = filas[primera + i];
+        fila.vMmS = vMmS;
+        fila.realMm = real;
+        fila.previstoMm = previsto;
+        errorInicial = fmax(errorInicial, fabs(fila.previstoInicialMm - real));
+        errorAprendido = fmax(errorAprendido, fabs(previsto - real));
+      }
+    }
+  }
+
+  if (formato == BENCH_CSV) {
+    printf("freno_pwm,velocidad,vel_mm_s,real_mm,previsto_inicial_mm,previsto_mm\n");
+  } else {
+    printf("{\n  \"frenadas\": [\n");
+  }
+  for (size_t i = 0; i < filas.size(); i++) {
+    const FilaFrenada &r = filas[i];
+    if (formato == BENCH_CSV) {
+      printf("%d,%d,%d,%.0f,%d,%d\n", r.freno, r.velocidad, r.vMmS, r.realMm,
+             r.previstoInicialMm, r.previstoMm);
+    } else {
+      printf("    {\"freno_pwm\": %d, \"velocidad\": %d, \"vel_mm_s\": %d, \"real_mm\": %.0f, "
+             "\"previsto_inicial_mm\": %d, \"previsto_mm\": %d}%s\n", r.freno, r.velocidad,
+             r.vMmS, r.realMm, r.previstoInicialMm, r.previstoMm, i + 1 == filas.size() ? "" : ",");
+    }
+  }
+
+  if (formato == BENCH_CSV) {
+    printf("\nfreno_pwm,inversion,pico_marcha_a,pico_inversion_a\n");
+  } else {
+    printf("  ],\n  \"inversiones\": [\n");
+  }
+  for (size_t f = 0; f < nFrenos; f++) {
+    for (int directa = 1; directa >= 0; directa--) {
+      double marchaA, totalA;
+      inversion(FRENOS_PWM[f], directa, &marchaA, &totalA);
+      const char *modo = directa ? "directa" : "perfil";
+      if (formato == BENCH_CSV) {
+        printf("%d,%s,%.2f,%.2f\n", FRENOS_PWM[f], modo, marchaA, totalA);
+      } else {
+        printf("    {\"freno_pwm\": %d, \"inversion\": \"%s\", \"pico_marcha_a\": %.2f, "
+               "\"pico_inversion_a\": %.2f}%s\n", FRENOS_PWM[f], modo, marchaA, totalA,
+               f + 1 == nFrenos && !directa ? "" : ",");
+      }
+    }
+  }
+  if (formato == BENCH_JSON) printf("  ]\n}\n");
+  fprintf(stderr, "error máximo de la frenada prevista: %.0f mm por defecto, %.0f mm aprendida\n",
+          errorInicial, errorAprendido);
+  return 0;
+}
+
+// ---- Parada de emergencia ----
+
+// loop() ciego hacia un muro: la tarea del eco y el lazo de motores corren,
+// con loop() parado atascoMs tras cada EMERGENCIA_BUCLE_US, pero nadie
+// mide ni decide; solo el ISR del eco puede parar. Cada caso sale desde
+// varias distancias para que el muro caiga en fases distintas de los
+// disparos.
+static const int ATASCOS_MS[] = {0, 20, 50};
+static const float SALIDAS_CM[] = {50, 52, 54, 56, 58, 60, 62, 64};
+
+#define EMERGENCIA_TAREA_ECO_US 5000UL     // Como en main.cpp
+#define EMERGENCIA_BUCLE_US 100000ULL
+#define EMERGENCIA_LIMITE_US 8000000ULL
+#define EMERGENCIA_QUIETO_US 1000000ULL    // Tras la parada, el avance sigue pedido
+
+struct FilaEmergencia {
+  int velocidad, atascoMs, umbralCm;
+  double velMaxCmS;
+  int ecoMinCm;                 // Eco más corto que disparó una parada
+  unsigned long latenciaMaxUs;
+  double huecoMinCm;            // Del sensor al muro, ya parado
+  unsigned paradas, colisiones;
+};
+
+// Corre la tarea del eco y el lazo de motores durante us, en pasadas de
+// loop() separadas por los atascos; con hastaParada, también hasta que
+// salta la parada de emergencia
+static void bucleCiego(unsigned long long us, bool hastaParada, int atascoMs, double *velMaxCmS) {
+  unsigned long long inicio = simRelojUs(), tramo = inicio, control = inicio;
+  while (simRelojUs() - inicio < us && simEstado().colisiones == 0 &&
+         !(hastaParada && emergenciaPendiente())) {
+    telemetrosActualizar();
+    if (simRelojUs() - control >= MOTORES_PERIODO_CONTROL_MS * 1000ULL) {
+      control = simRelojUs();
+      motoresControlar();
+    }
+    simAvanzarUs(EMERGENCIA_TAREA_ECO_US);
+    *velMaxCmS = fmax(*velMaxCmS, (simEstado().vIzq + simEstado().vDer) * 0.5);
+    if (atascoMs > 0 && simRelojUs() - tramo >= EMERGENCIA_BUCLE_US) {
+      simAvanzarUs(atascoMs * 1000UL);
+      tramo = simRelojUs();
+    }
+  }
+}
+
+static void emergencia(float salidaCm, FilaEmergencia &f) {
+  Mapa muro = {"muro", 400, 200, salidaCm, 100, 0, {{300, 0, 300, 200}}};
+  simIniciar(muro, 1);
+  parametrosIniciar();
+  parametroFijar(PARAM_EMERGENCIA_CM, f.umbralCm);
+  telemetrosIniciar();
+  motoresIniciar();
+  encodersIniciar();
+  servoIniciar(90);
+  barridoIniciar();
+  simAvanzarUs(servoEtaMs() * 1000UL);
+
+  avanzarConVelocidad(f.velocidad);
+  bucleCiego(EMERGENCIA_LIMITE_US, true, f.atascoMs, &f.velMaxCmS);
+  if (emergenciaPendiente()) {
+    f.paradas++;
+    f.ecoMinCm = f.paradas == 1 ? emergenciaDistanciaCm() : min((int)emergenciaDistanciaCm(), f.ecoMinCm);
+    f.latenciaMaxUs = max(f.latenciaMaxUs, emergenciaLatenciaUs());
+    bucleCiego(EMERGENCIA_QUIETO_US, false, f.atascoMs, &f.velMaxCmS);
+  }
+  const EstadoSim &e = simEstado();
+  float sx = e.x + simFisica().sensorAdelanteCm * cosf(e.rumbo);
+  float sy = e.y + simFisica().sensorAdelanteCm * sinf(e.rumbo);
+  f.huecoMinCm = fmin(f.huecoMinCm, simRaycast(sx, sy, e.rumbo));
+  if (e.colisiones > 0) f.colisiones++;
+}
+
+int benchmarkEmergencia(FormatoBenchmark formato, int umbralCm) {
+  const int velocidades[] = {VELOCIDAD_MAXIMA, 255};
+  const size_t salidas = sizeof(SALIDAS_CM) / sizeof(SALIDAS_CM[0]);
+  std::vector<FilaEmergencia> filas;
+  for (int velocidad : velocidades) {
+    for (int atascoMs : ATASCOS_MS) {
+      for (int umbral : {umbralCm, 0}) {
+        FilaEmergencia f = {velocidad, atascoMs, umbral, 0, 0, 0, 1e9, 0, 0};
+        for (float salida : SALIDAS_CM) emergencia(salida, f);
+        filas.push_back(f);
+      }
+    }
+  }
+
+  if (formato == BENCH_CSV) {
+    printf("velocidad,atasco_ms,emergencia_cm,vel_max_cm_s,paradas,eco_min_cm,latencia_max_us,"
+           "hueco_min_cm,colisiones\n");
+  } else {
+    printf("{\n  \"casos\": [\n");
+  }
+  unsigned long peorUs = 0;
+  bool correcto = umbralCm > 0;
+  for (size_t i = 0; i < filas.size(); i++) {
+    const FilaEmergencia &r = filas[i];
+    if (formato == BENCH_CSV) {
+      printf("%d,%d,%d,%.1f,%u,%d,%lu,%.1f,%u\n", r.velocidad, r.atascoMs, r.umbralCm, r.velMaxCmS,
+             r.paradas, r.ecoMinCm, r.latenciaMaxUs, r.huecoMinCm, r.colisiones);
+    } else {
+      printf("    {\"velocidad\": %d, \"atasco_ms\": %d, \"emergencia_cm\": %d, "
+             "\"vel_max_cm_s\": %.1f, \"paradas\": %u, \"eco_min_cm\": %d, "
+             "\"latencia_max_us\": %lu, \"hueco_min_cm\": %.1f, \"colisiones\": %u}%s\n",
+             r.velocidad, r.atascoMs, r.umbralCm, r.velMaxCmS, r.paradas, r.ecoMinCm,
+             r.latenciaMaxUs, r.huecoMinCm, r.colisiones, i + 1 == filas.size() ? "" : ",");
+    }
+    if (r.umbralCm > 0) {
+      // Con la parada, el ISR frena antes del muro y el avance no vuelve
+      correcto = correcto && r.paradas == salidas && r.colisiones == 0 &&
+                 r.latenciaMaxUs <= EMERGENCIA_LATENCIA_MAX_US;
+      peorUs = max(peorUs, r.latenciaMaxUs);
+    } else {
+      // Sin ella, el bucle ciego choca: si no, el banco no prueba nada
+      correcto = correcto && r.colisiones == salidas;
+    }
+  }
+  if (formato == BENCH_JSON) printf("  ]\n}\n");
+  fprintf(stderr, "parada de emergencia a %d cm: peor latencia del eco al puente %lu us (cota %lu); %s\n",
+          umbralCm, peorUs, EMERGENCIA_LATENCIA_MAX_US, correcto ? "correcta" : "FALLA");
+  return correcto ? 0 : 1;
+}
+
+// ---- Calibración de motores ----
+
+void setup();
+void loop();
+
+static const int VELOCIDADES_RECTA[] = {100, 150, 200};
+
+#define CALIBRACION_LIMITE_S 90.0
+#define RECTA_DURACION_US 2000000ULL
+#define PASO_BUCLE_CAL_US 500
+
+// Rumbo (°) y desvío lateral (cm) tras avanzar en recta desde parado
+static void recta(int velocidad, const CurvaMotor *curvas, double *rumbo, double *lateral) {
+  Mapa vacio = {"vacio", 1000, 1000, 200, 500, 0, {}};
+  simIniciar(vacio, 1);
+  parametrosIniciar();
+  motoresIniciar();
+  encodersIniciar();
+  motoresFijarCurvas(curvas, 0);
+
+  const unsigned long periodoUs = MOTORES_PERIODO_CONTROL_MS * 1000UL;
+  avanzarConVelocidad(velocidad);
+  unsigned long long inicio = simRelojUs();
+  while (simRelojUs() - inicio < RECTA_DURACION_US) {
+    simAvanzarUs(periodoUs);
+    motoresControlar();
+  }
+  *rumbo = simEstado().rumbo * 180.0 / M_PI;
+  *lateral = simEstado().y - vacio.y0;
+}
+
+// Lanza "cal" por la consola del firmware frente a una pared, compara las
+// curvas con el modelo del simulador y mide la deriva en recta con los
+// factores y con las curvas
+int benchmarkCalibracion(FormatoBenchmark formato) {
+  Mapa pared = {"pared", 400, 200, 230, 100, 0, {{400, 0, 400, 200}}};  // A ~160 cm
+  simIniciar(pared, 1);
+  setup();
+  halEntradaSerie("cal\n");
+  bool empezada = false;
+  while (simEstado().tiempoS < CALIBRACION_LIMITE_S && (!empezada || calibracionActiva())) {
+    loop();
+    simAvanzarUs(PASO_BUCLE_CAL_US);
+    empezada = empezada || calibracionActiva();
+  }
+  if (calibracionActiva() || motoresCurvas() == nullptr) {
+    fprintf(stderr, "la calibración no terminó\n");
+    return 1;
+  }
+  CurvaMotor curvas[2];
+  memcpy(curvas, motoresCurvas(), sizeof(curvas));
+  double duracionS = simEstado().tiempoS;
+
+  const ParametrosFisicos &f = simFisica();
+  const float vMax[2] = {f.vMaxIzq, f.vMaxDer};
+  double errorCurva = 0;
+  for (uint8_t m = 0; m < 2; m++) {
+    for (uint8_t i = 0; i < CURVA_PUNTOS; i++) {
+      int pwm = CURVA_PWM_MIN + i * CURVA_PWM_PASO;
+      double real = (pwm - f.zonaMuertaPwm) / (255.0 - f.zonaMuertaPwm) * vMax[m] * 10.0;
+      errorCurva = fmax(errorCurva, fabs(curvas[m].velocidadMmS[i] - real) / real);
+    }
+  }
+
+  const size_t n = sizeof(VELOCIDADES_RECTA) / sizeof(VELOCIDADES_RECTA[0]);
+  if (formato == BENCH_CSV) {
+    printf("velocidad,rumbo_factores_grados,rumbo_curvas_grados,"
+           "lateral_factores_cm,lateral_curvas_cm\n");
+  } else {
+    printf("{\n  \"rectas\": [\n");
+  }
+  double sumaFactores = 0, sumaCurvas = 0;
+  for (size_t i = 0; i < n; i++) {
+    double rumboF, lateralF, rumboC, lateralC;
+    recta(VELOCIDADES_RECTA[i], nullptr, &rumboF, &lateralF);
+    recta(VELOCIDADES_RECTA[i], curvas, &rumboC, &lateralC);
+    sumaFactores += fabs(rumboF);
+    sumaCurvas += fabs(rumboC);
+    if (formato == BENCH_CSV) {
+      printf("%d,%.2f,%.2f,%.2f,%.2f\n", VELOCIDADES_RECTA[i], rumboF, rumboC, lateralF, lateralC);
+    } else {
+      printf("    {\"velocidad\": %d, \"rumbo_factores_grados\": %.2f, \"rumbo_curvas_grados\": %.2f, "
+             "\"lateral_factores_cm\": %.2f, \"lateral_curvas_cm\": %.2f}%s\n",
+             VELOCIDADES_RECTA[i], rumboF, rumboC, lateralF, lateralC, i + 1 == n ? "" : ",");
+    }
+  }
+  if (formato == BENCH_JSON) {
+    printf("  ],\n  \"resumen\": {\"duracion_s\": %.1f, \"zona_muerta_izq\": %u, "
+           "\"zona_muerta_der\": %u, \"error_curva_max\": %.3f}\n}\n",
+           duracionS, curvas[0].zonaMuerta, curvas[1].zonaMuerta, errorCurva);
+  }
+  fprintf(stderr, "calibración en %.1f s: zona muerta %u/%u (modelo %.0f), error de curva máx %.1f%%; "
+          "rumbo medio en recta %.2f° con factores, %.2f° con curvas\n",
+          duracionS, curvas[0].zonaMuerta, curvas[1].zonaMuerta, f.zonaMuertaPwm, 100 * errorCurva,
+          sumaFactores / n, sumaCurvas / n);
+  return 0;
+}
+
+// ---- Descarga de la batería ----
+
+#define BATERIA_TRAMO_S 100.0
+
+struct TramoBateria {
+  double desdeS, bateriaV, velMediaCmS, velCruceroCmS, seguimiento, fraccionDetenido;
+  uint32_t recuperaciones;
+};
+
+// Pack de 6 NiMH que se agota en unos 600 s de misión
+static ParametrosFisicos fisicaDescarga() {
+  ParametrosFisicos f;
+  f.bateriaLlenaV = 9.6f;
+  f.bateriaVaciaV = 7.2f;
+  f.capacidadAs = 550;
+  f.resistenciaOhm = 0.5f;
+  return f;
+}
+
+static uint32_t recuperaciones() {
+  return navegacionRecuperaciones(REC_BLOQUEO_FISICO) + navegacionRecuperaciones(REC_ATASCO) +
+         navegacionRecuperaciones(REC_TIEMPO);
+}
+
+// La tensión de cada tramo es la media en bornes, con carga
+static std::vector<TramoBateria> descarga(bool compensada, double segundos) {
+  Mapa mapa;
+  simMapaPorNombre("sala", 1, mapa);
+  simIniciar(mapa, 1, fisicaDescarga());
+  setup();
+  if (!compensada) parametroFijar(PARAM_BATERIA_NOMINAL_MV, 0);
+
+  std::vector<TramoBateria> tramos;
+  TramoBateria t = {0, 0, 0, 0, 0, 0, 0};
+  double avance0 = 0, detenido0 = 0, sumaV = 0, sumaReal = 0, sumaPedida = 0, sumaCrucero = 0;
+  uint32_t muestras = 0, rec0 = 0, muestrasCrucero = 0;
+  int16_t cruceroMmS = (int16_t)((long)parametros[PARAM_VELOCIDAD_MAXIMA] * MM_S_POR_PWM_Q8 / 256);
+  while (simEstado().tiempoS < segundos) {
+    loop();
+    simAvanzarUs(PASO_BUCLE_US);
+    const EstadoSim &e = simEstado();
+    sumaV += e.bateriaV;
+    muestras++;
+    // Seguimiento: avance real frente al pedido mientras va recto hacia delante
+    int16_t pedidaIzq = motoresObjetivoMmS(MOTOR_IZQ), pedidaDer = motoresObjetivoMmS(MOTOR_DER);
+    if (pedidaIzq > 0 && pedidaDer > 0) {
+      sumaReal += (e.vIzq + e.vDer) * 5.0;  // cm/s -> mm/s, media de las dos
+      sumaPedida += (pedidaIzq + pedidaDer) * 0.5;
+    }
+    // Crucero: las dos ruedas a la velocidad máxima pedida, que no depende
+    // del camino (la velocidad media sí: cada tramo recorre otra sala)
+    if (pedidaIzq >= cruceroMmS && pedidaDer >= cruceroMmS) {
+      sumaCrucero += (e.vIzq + e.vDer) * 0.5;
+      muestrasCrucero++;
+    }
+    if (e.tiempoS - t.desdeS >= BATERIA_TRAMO_S || e.tiempoS >= segundos) {
+      double duracion = e.tiempoS - t.desdeS;
+      t.bateriaV = sumaV / muestras;
+      t.velMediaCmS = (e.avanceCm - avance0) / duracion;
+      t.seguimiento = sumaPedida > 0 ? sumaReal / sumaPedida : 0;
+      t.velCruceroCmS = muestrasCrucero ? sumaCrucero / muestrasCrucero : 0;
+      t.fraccionDetenido = (e.tiempoDetenidoS - detenido0) / duracion;
+      t.recuperaciones = recuperaciones() - rec0;
+      tramos.push_back(t);
+      t.desdeS = e.tiempoS;
+      avance0 = e.avanceCm;
+      detenido0 = e.tiempoDetenidoS;
+      rec0 = recuperaciones();
+      sumaV = 0;
+      sumaReal = 0;
+      sumaPedida = 0;
+      sumaCrucero = 0;
+      muestras = 0;
+      muestrasCrucero = 0;
+    }
+  }
+  return tramos;
+}
+
+int benchmarkBateria(FormatoBenchmark formato, double segundos) {
+  std::vector<TramoBateria> modos[2] = {descarga(true, segundos), descarga(false, segundos)};
+  const char *nombres[2] = {"compensada", "sin_compensar"};
+
+  if (formato == BENCH_CSV) {
+    printf("modo,desde_s,bateria_v,vel_media_cm_s,vel_crucero_cm_s,seguimiento,fraccion_detenido,"
+           "recuperaciones\n");
+  } else {
+    printf("{\n  \"tramos\": [\n");
+  }
+  double extremos[2][2];  // Velocidad de crucero mínima y máxima por modo
+  for (int m = 0; m < 2; m++) {
+    extremos[m][0] = 1e9;
+    extremos[m][1] = 0;
+    for (size_t i = 0; i < modos[m].size(); i++) {
+      const TramoBateria &t = modos[m][i];
+      extremos[m][0] = fmin(extremos[m][0], t.velCruceroCmS);
+      extremos[m][1] = fmax(extremos[m][1], t.velCruceroCmS);
+      if (formato == BENCH_CSV) {
+        printf("%s,%.0f,%.2f,%.2f,%.2f,%.3f,%.3f,%u\n", nombres[m], t.desdeS, t.bateriaV,
+               t.velMediaCmS, t.velCruceroCmS, t.seguimiento, t.fraccionDetenido, t.recuperaciones);
+      } else {
+        bool ultima = m == 1 && i + 1 == modos[m].size();
+        printf("    {\"modo\": \"%s\", \"desde_s\": %.0f, \"bateria_v\": %.2f, "
+               "\"vel_media_cm_s\": %.2f, \"vel_crucero_cm_s\": %.2f, \"seguimiento\": %.3f, "
+               "\"fraccion_detenido\": %.3f, \"recuperaciones\": %u}%s\n",
+               nombres[m], t.desdeS, t.bateriaV, t.velMediaCmS, t.velCruceroCmS, t.seguimiento,
+               t.fraccionDetenido, t.recuperaciones, ultima ? "" : ",");
+      }
+    }
+  }
+  if (formato == BENCH_JSON) {
+    printf("  ],\n  \"resumen\": {\"rango_crucero_compensada_cm_s\": %.2f, "
+           "\"rango_crucero_sin_compensar_cm_s\": %.2f}\n}\n",
+           extremos[0][1] - extremos[0][0], extremos[1][1] - extremos[1][0]);
+  }
+  fprintf(stderr, "crucero por tramo: %.2f-%.2f cm/s compensada, %.2f-%.2f cm/s sin compensar\n",
+          extremos[0][0], extremos[0][1], extremos[1][0], extremos[1][1]);
+  return 0;
+}
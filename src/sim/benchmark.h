@@ -0,0 +1,62 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Banco de pruebas de navegación: corpus fijo de mapas y semillas
+// (pasillos, callejones, cajas, puertas estrechas). Escribe una fila por
+// misión y una fila "media" en CSV o JSON por stdout.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "mision.h"
+
+enum FormatoBenchmark {
+  BENCH_CSV,
+  BENCH_JSON
+};
+
+struct CasoBenchmark {
+  const char *mapa;
+  uint32_t semilla;
+};
+
+// semillas 0 = el corpus; K = cada mapa del corpus con las semillas 1..K.
+// Con 17 misiones las colisiones varían un 20 % con cualquier cambio:
+// comparar colisiones pide cientos (--semillas 40 son 200).
+int benchmarkEjecutar(FormatoBenchmark formato, double segundos, unsigned semillas);
+
+// Corpus fijo del banco
+const CasoBenchmark *benchmarkCorpus(size_t *casos);
+
+// Misiones del banco y del afinador según semillas (como benchmarkEjecutar)
+std::vector<CasoBenchmark> benchmarkCasos(unsigned semillas);
+
+// Columnas CSV del banco, una fila por misión
+void benchmarkCabeceraCsv();
+void benchmarkFilaCsv(const ResultadoMision &r);
+
+// Precisión y duración de girarGrados() en un recinto vacío
+int benchmarkGiros(FormatoBenchmark formato);
+
+// Distancia de frenada real frente a la prevista (frenada.h) a varias
+// velocidades con rueda libre y dos duty de freno, y pico de corriente al
+// invertir con el perfil de motores.h o directamente
+int benchmarkFrenada(FormatoBenchmark formato);
+
+// Avance ciego contra un muro con loop() atascado a ratos, con la parada
+// de emergencia del ISR a umbralCm (emergencia.h) y sin ella: eco, latencia
+// del eco al puente y hueco al parar. Devuelve 1 si con ella choca o pasa
+// de la cota de latencia, o si sin ella no choca
+int benchmarkEmergencia(FormatoBenchmark formato, int umbralCm);
+
+// Calibración de motores (orden "cal") frente a una pared y deriva en recta
+// con los factores y con las curvas medidas
+int benchmarkCalibracion(FormatoBenchmark formato);
+
+// Misión en "sala" durante una descarga completa de la batería, con y sin
+// compensación de tensión: tensión, velocidad media y de crucero por tramo
+#define BENCH_BATERIA_S 900.0  // Por defecto: la descarga (~600 s) y tres tramos ya vacía
+int benchmarkBateria(FormatoBenchmark formato, double segundos);
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef ARDUINO_H_NATIVO
+#define ARDUINO_H_NATIVO
+
+// HAL mínima de Arduino para compilar el firmware en Linux ([env:native]).
+// El tiempo es virtual: millis()/micros() solo avanzan cuando el simulador
+// integra la física (delay(), delayMicroseconds() o el bucle principal),
+// así que el código de control corre mucho más rápido que en tiempo real.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <type_traits>
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+
+#define NUM_PINES_NATIVO 20
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_ptr(p) (*(const void *const *)(p))
+#define PSTR(s) (s)
+#define strcmp_P strcmp
+#define memcpy_P memcpy
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t modo);
+void digitalWrite(uint8_t pin, uint8_t valor);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int valor);
+int analogRead(uint8_t pin);
+unsigned long pulseIn(uint8_t pin, uint8_t estado, unsigned long timeoutUs = 1000000UL);
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+template <class T, class L, class H>
+inline T constrain(T x, L bajo, H alto) {
+  return x < (T)bajo ? (T)bajo : (x > (T)alto ? (T)alto : x);
+}
+
+template <class A, class B>
+inline typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+
+template <class A, class B>
+inline typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// stdlib.h de C++ ya trae abs(int/long/long long) en el espacio global
+
+// Serial: escribe en stdout solo si el simulador lo pide (--verbose)
+class SerialNativo {
+ public:
+  void begin(unsigned long) {}
+  void flush() {}
+  int available();
+  int read();
+  int availableForWrite() { return 64; }
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t *datos, size_t n);
+
+  size_t print(const char *s);
+  size_t print(const __FlashStringHelper *s) { return print(reinterpret_cast<const char *>(s)); }
+  size_t print(char c);
+  size_t print(int n) { return print((long)n); }
+  size_t print(unsigned int n) { return print((unsigned long)n); }
+  size_t print(long n);
+  size_t print(unsigned long n);
+  size_t print(double n, int decimales = 2);
+
+  template <class T>
+  size_t println(T v) { size_t n = print(v); return n + print('\n'); }
+  size_t println(double v, int decimales) { size_t n = print(v, decimales); return n + print('\n'); }
+  size_t println() { return print('\n'); }
+};
+
+extern SerialNativo Serial;
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef EEPROM_H_NATIVO
+#define EEPROM_H_NATIVO
+
+#include <stdint.h>
+#include <string.h>
+
+// EEPROM de 1 KB del ATmega328P en memoria. halReiniciar() la deja borrada
+// (0xFF), como una placa nueva en cada misión. Cuenta las escrituras para
+// comprobar que guardar solo toca los bytes que cambian.
+
+#define EEPROM_NATIVA_BYTES 1024
+
+class EEPROMNativa {
+ public:
+  uint8_t read(int direccion) const;
+  void write(int direccion, uint8_t valor);
+  void update(int direccion, uint8_t valor) {
+    if (read(direccion) != valor) write(direccion, valor);
+  }
+  uint16_t length() const { return EEPROM_NATIVA_BYTES; }
+
+  template <class T>
+  T &get(int direccion, T &valor) const {
+    for (size_t i = 0; i < sizeof(T); i++) ((uint8_t *)&valor)[i] = read(direccion + (int)i);
+    return valor;
+  }
+
+  template <class T>
+  const T &put(int direccion, const T &valor) {
+    for (size_t i = 0; i < sizeof(T); i++) update(direccion + (int)i, ((const uint8_t *)&valor)[i]);
+    return valor;
+  }
+
+  void borrar();
+  uint32_t escrituras = 0;
+
+ private:
+  uint8_t datos[EEPROM_NATIVA_BYTES];
+};
+
+extern EEPROMNativa EEPROM;
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef SERVO_H_NATIVO
+#define SERVO_H_NATIVO
+
+#include <stdint.h>
+
+// Servo simulado: write() fija el ángulo pedido y el simulador mueve el
+// eje desde la siguiente trama de 20 ms con una velocidad de giro
+// limitada (ver simulador.cpp).
+class Servo {
+ public:
+  uint8_t attach(int pin);
+  void write(int angulo);
+  int read();
+};
+
+#endif
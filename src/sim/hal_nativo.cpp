@@ -0,0 +1,190 @@
+#include <Arduino.h>
+#include <Servo.h>
+#include <EEPROM.h>
+#include <stdio.h>
+#include <deque>
+
+#include "hal_nativo.h"
+#include "simulador.h"
+#include "configuracion.h"
+
+SerialNativo Serial;
+EEPROMNativa EEPROM;
+
+static uint8_t niveles[NUM_PINES_NATIVO];
+static int pwm[NUM_PINES_NATIVO];
+static std::deque<uint8_t> entradaSerie;
+static int servoAngulo = 90;
+static std::vector<uint8_t> *capturaSerie = nullptr;
+static bool enIsr = false;
+
+// Coste en el UNO a 16 MHz: digitalWrite() resuelve pin, puerto y timer en
+// unos 60 ciclos; analogWrite() en un pin de Timer0, unos 90
+#define HAL_DIGITAL_WRITE_US 4UL
+#define HAL_ANALOG_WRITE_US 6UL
+
+int (*halAnalogico)(uint8_t pin) = nullptr;
+
+void halReiniciar() {
+  servoAngulo = 90;
+  memset(niveles, 0, sizeof(niveles));
+  memset(pwm, 0, sizeof(pwm));
+  entradaSerie.clear();
+  EEPROM.borrar();
+}
+
+uint8_t halPin(uint8_t pin) {
+  return pin < NUM_PINES_NATIVO ? niveles[pin] : 0;
+}
+
+int halPwm(uint8_t pin) {
+  return pin < NUM_PINES_NATIVO ? pwm[pin] : 0;
+}
+
+void halEntradaSerie(const std::string &texto) {
+  entradaSerie.insert(entradaSerie.end(), texto.begin(), texto.end());
+}
+
+void halIsr(bool dentro) {
+  enIsr = dentro;
+}
+
+void halCapturarSerie(std::vector<uint8_t> *destino) {
+  capturaSerie = destino;
+}
+
+// ---- Tiempo ----
+
+unsigned long millis() {
+  return (unsigned long)(simRelojUs() / 1000ULL);
+}
+
+unsigned long micros() {
+  return (unsigned long)simRelojUs();
+}
+
+void delay(unsigned long ms) {
+  simAvanzarUs(ms * 1000UL);
+}
+
+void delayMicroseconds(unsigned int us) {
+  simAvanzarUs(us);
+}
+
+// ---- Pines ----
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t valor) {
+  if (enIsr) simGastarUs(HAL_DIGITAL_WRITE_US);
+  if (pin < NUM_PINES_NATIVO) niveles[pin] = valor ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  return halPin(pin);
+}
+
+// Como en el AVR, analogWrite deja el pin a nivel fijo en 0 y 255
+void analogWrite(uint8_t pin, int valor) {
+  if (enIsr) simGastarUs(HAL_ANALOG_WRITE_US);
+  if (pin >= NUM_PINES_NATIVO) return;
+  pwm[pin] = constrain(valor, 0, 255);
+  niveles[pin] = pwm[pin] > 0 ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin) {
+  return halAnalogico ? halAnalogico(pin) : 0;
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t, unsigned long timeoutUs) {
+  unsigned long ancho = pin == ECHO_PIN ? simEcoUltrasonido(simEstado().servoGrados) : 0;
+  if (ancho == 0 || ancho > timeoutUs) {
+    simAvanzarUs(timeoutUs);
+    return 0;
+  }
+  simAvanzarUs(ancho);
+  return ancho;
+}
+
+// ---- Servo ----
+
+uint8_t Servo::attach(int) {
+  return 1;
+}
+
+void Servo::write(int angulo) {
+  servoAngulo = constrain(angulo, 0, 180);
+  simServoPedido(servoAngulo);
+}
+
+int Servo::read() {
+  return servoAngulo;
+}
+
+// ---- EEPROM ----
+
+uint8_t EEPROMNativa::read(int direccion) const {
+  return direccion >= 0 && direccion < EEPROM_NATIVA_BYTES ? datos[direccion] : 0xFF;
+}
+
+void EEPROMNativa::write(int direccion, uint8_t valor) {
+  if (direccion < 0 || direccion >= EEPROM_NATIVA_BYTES) return;
+  datos[direccion] = valor;
+  escrituras++;
+}
+
+void EEPROMNativa::borrar() {
+  memset(datos, 0xFF, sizeof(datos));
+  escrituras = 0;
+}
+
+// ---- Serial ----
+
+int SerialNativo::available() {
+  return (int)entradaSerie.size();
+}
+
+int SerialNativo::read() {
+  if (entradaSerie.empty()) return -1;
+  uint8_t c = entradaSerie.front();
+  entradaSerie.pop_front();
+  return c;
+}
+
+size_t SerialNativo::write(uint8_t c) {
+  if (simVerbose) fputc(c, stdout);
+  if (capturaSerie) capturaSerie->push_back(c);
+  return 1;
+}
+
+size_t SerialNativo::write(const uint8_t *datos, size_t n) {
+  if (simVerbose) fwrite(datos, 1, n, stdout);
+  if (capturaSerie) capturaSerie->insert(capturaSerie->end(), datos, datos + n);
+  return n;
+}
+
+size_t SerialNativo::print(const char *s) {
+  return write((const uint8_t *)s, strlen(s));
+}
+
+size_t SerialNativo::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t SerialNativo::print(long n) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%ld", n);
+  return print(buf);
+}
+
+size_t SerialNativo::print(unsigned long n) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%lu", n);
+  return print(buf);
+}
+
+size_t SerialNativo::print(double n, int decimales) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", decimales, n);
+  return print(buf);
+}
@@ -0,0 +1,30 @@
+#ifndef HAL_NATIVO_H
+#define HAL_NATIVO_H
+
+// Estado de los pines de la HAL nativa, leído por el simulador
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+void halReiniciar();
+uint8_t halPin(uint8_t pin);
+int halPwm(uint8_t pin);
+
+// Dentro de un ISR simulado (flanco del eco), digitalWrite() y
+// analogWrite() gastan el tiempo que tardan en el UNO (simGastarUs())
+void halIsr(bool dentro);
+
+// Bytes que el firmware leerá por Serial.read()
+void halEntradaSerie(const std::string &texto);
+
+// Si no es nulo, lo que el firmware escribe por Serial se añade aquí
+// (además de ir a stdout con --verbose)
+void halCapturarSerie(std::vector<uint8_t> *destino);
+
+// analogRead(): lo pone el simulador (IR, batería) o el reproductor de trazas
+extern int (*halAnalogico)(uint8_t pin);
+
+// Servo.write() -> posición pedida al servo simulado
+void simServoPedido(int angulo);
+
+#endif
@@ -0,0 +1,192 @@
+// Ejecuta el firmware sin modificar (setup()/loop() de src/main.cpp)
+// contra el simulador 2D, más rápido que en tiempo real.
+//
+//   robot_sim [--mapa NOMBRE] [--semilla N] [--segundos S] [--verbose] [--csv]
+//   robot_sim --bench [--json] [--segundos S] [--semillas N]
+//   robot_sim --giros [--json]
+//   robot_sim --frenada [--json]
+//   robot_sim --emergencia [--json] [--param emergencia_cm=N]
+//   robot_sim --calibrar [--json]
+//   robot_sim --bateria [--json] [--segundos S]
+//   robot_sim --grabar FICHERO [--mapa NOMBRE] [--semilla N] [--segundos S]
+//   robot_sim --reproducir FICHERO
+//   robot_sim --afinar CANDIDATOS [--hilos N] [--semillas N] [--segundos S]
+//             [--semilla N] [--salida afinado.h]
+//
+// --param NOMBRE=VALOR (repetible) fija un parámetro de parametros.h en las
+// misiones, como si estuviera guardado en la EEPROM.
+//
+// Con pio test (PIO_UNIT_TESTING) el main() es el de cada test de test/.
+
+#ifndef PIO_UNIT_TESTING
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#include "simulador.h"
+#include "mision.h"
+#include "benchmark.h"
+#include "reproduccion.h"
+#include "afinador.h"
+#include "parametros.h"
+#include "configuracion.h"
+
+#include <unistd.h>
+
+static void uso() {
+  fprintf(stderr, "uso: robot_sim [--mapa NOMBRE] [--semilla N] [--segundos S] [--verbose] [--csv]\n");
+  fprintf(stderr, "     robot_sim --bench [--json] [--segundos S] [--semillas N]\n");
+  fprintf(stderr, "     robot_sim --giros [--json]\n");
+  fprintf(stderr, "     robot_sim --frenada [--json]\n");
+  fprintf(stderr, "     robot_sim --emergencia [--json] [--param emergencia_cm=N]\n");
+  fprintf(stderr, "     robot_sim --calibrar [--json]\n");
+  fprintf(stderr, "     robot_sim --bateria [--json] [--segundos S]\n");
+  fprintf(stderr, "     robot_sim --grabar FICHERO [--mapa NOMBRE] [--semilla N] [--segundos S]\n");
+  fprintf(stderr, "     robot_sim --reproducir FICHERO\n");
+  fprintf(stderr, "     robot_sim --afinar CANDIDATOS [--hilos N] [--semillas N] [--segundos S]\n"
+                  "               [--semilla N] [--salida afinado.h]\n");
+  fprintf(stderr, "     --param NOMBRE=VALOR fija un parámetro en las misiones (repetible)\n");
+  fprintf(stderr, "     --servo-real G: el servo simulado gira a G °/s (el modelo del firmware,\n"
+                  "                     servo_grados_s, no cambia)\n");
+  fprintf(stderr, "mapas:");
+  for (const std::string &n : simNombresMapas()) fprintf(stderr, " %s", n.c_str());
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+  std::string nombreMapa = "sala";
+  uint32_t semilla = 1;
+  double segundos = 60;
+  bool bench = false;
+  bool giros = false;
+  bool frenada = false;
+  bool emergencia = false;
+  bool calibrar = false;
+  bool bateria = false;
+  bool csv = false;
+  std::string grabar, reproducir;
+  FormatoBenchmark formato = BENCH_CSV;
+  std::vector<std::pair<uint8_t, int16_t> > valores;
+  OpcionesAfinado afinado;
+  bool afinar = false;
+  bool segundosFijados = false;
+  ParametrosFisicos fisica;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--mapa" && i + 1 < argc) {
+      nombreMapa = argv[++i];
+    } else if (arg == "--semilla" && i + 1 < argc) {
+      semilla = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--segundos" && i + 1 < argc) {
+      segundos = atof(argv[++i]);
+      segundosFijados = true;
+    } else if (arg == "--verbose") {
+      simVerbose = true;
+    } else if (arg == "--bench") {
+      bench = true;
+    } else if (arg == "--giros") {
+      giros = true;
+    } else if (arg == "--frenada") {
+      frenada = true;
+    } else if (arg == "--emergencia") {
+      emergencia = true;
+    } else if (arg == "--calibrar") {
+      calibrar = true;
+    } else if (arg == "--bateria") {
+      bateria = true;
+    } else if (arg == "--grabar" && i + 1 < argc) {
+      grabar = argv[++i];
+    } else if (arg == "--reproducir" && i + 1 < argc) {
+      reproducir = argv[++i];
+    } else if (arg == "--json") {
+      formato = BENCH_JSON;
+    } else if (arg == "--csv") {
+      csv = true;
+    } else if (arg == "--param" && i + 1 < argc) {
+      std::string p = argv[++i];
+      size_t igual = p.find('=');
+      int8_t id = igual == std::string::npos ? -1 : parametroBuscar(p.substr(0, igual).c_str());
+      long valor = id < 0 ? 0 : strtol(p.c_str() + igual + 1, nullptr, 10);
+      if (id < 0 || valor < parametroMinimo(id) || valor > parametroMaximo(id)) {
+        fprintf(stderr, "parámetro desconocido o fuera de rango: %s\n", p.c_str());
+        return 2;
+      }
+      valores.push_back({(uint8_t)id, (int16_t)valor});
+    } else if (arg == "--afinar" && i + 1 < argc) {
+      afinar = true;
+      afinado.candidatos = (unsigned)strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--hilos" && i + 1 < argc) {
+      afinado.hilos = (unsigned)strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--semillas" && i + 1 < argc) {
+      afinado.semillas = (unsigned)strtoul(argv[++i], nullptr, 10);
+    } else if (arg == "--servo-real" && i + 1 < argc) {
+      fisica.servoGradosPorSeg = atof(argv[++i]);
+    } else if (arg == "--salida" && i + 1 < argc) {
+      afinado.salida = argv[++i];
+    } else {
+      uso();
+      return 2;
+    }
+  }
+
+  // Las parejas de parametros.h con todos los --param a la vez: en orden,
+  // uno a uno, se podría pasar por una combinación que no se admite
+  parametrosIniciar();
+  for (const auto &v : valores) parametros[v.first] = v.second;
+  int8_t pareja = parametrosParejaIncumplida(parametros, 0, parametros[0]);
+  if (pareja >= 0) {
+    ParejaParametros p = parametrosPareja(pareja);
+    fprintf(stderr, "parámetros incoherentes: %s %s %s\n",
+            (const char *)parametroNombre(p.menor), p.estricta ? ">=" : ">",
+            (const char *)parametroNombre(p.mayor));
+    return 2;
+  }
+  misionFijarParametros(valores);
+  misionFijarFisica(fisica);
+  if (afinar) {
+    // Las misiones son procesos de este mismo binario
+    char ruta[4096];
+    ssize_t n = readlink("/proc/self/exe", ruta, sizeof(ruta) - 1);
+    afinado.ejecutable = n > 0 ? std::string(ruta, n) : std::string(argv[0]);
+    if (segundosFijados) afinado.segundos = segundos;
+    afinado.semilla = semilla;
+    return afinarParametros(afinado);
+  }
+  if (bench) return benchmarkEjecutar(formato, segundos, afinado.semillas);
+  if (giros) return benchmarkGiros(formato);
+  if (frenada) return benchmarkFrenada(formato);
+  if (emergencia) {
+    int16_t umbralCm = EMERGENCIA_CM;
+    for (const auto &v : valores) {
+      if (v.first == PARAM_EMERGENCIA_CM) umbralCm = v.second;
+    }
+    return benchmarkEmergencia(formato, umbralCm);
+  }
+  if (calibrar) return benchmarkCalibracion(formato);
+  if (bateria) return benchmarkBateria(formato, segundosFijados ? segundos : BENCH_BATERIA_S);
+  if (!reproducir.empty()) return reproducirTraza(reproducir);
+  if (!grabar.empty()) return grabarTraza(grabar, nombreMapa, semilla, segundos);
+
+  Mapa mapa;
+  if (!simMapaPorNombre(nombreMapa, semilla, mapa)) {
+    uso();
+    return 2;
+  }
+
+  ResultadoMision r = ejecutarMision(mapa, semilla, segundos);
+  if (csv) {
+    benchmarkCabeceraCsv();
+    benchmarkFilaCsv(r);
+    return 0;
+  }
+  const EstadoSim &e = simEstado();
+  printf("mapa=%s semilla=%u t=%.1fs vel_media=%.1fcm/s detenido=%.0f%% colisiones=%u "
+         "escaneos=%u cobertura=%.2fm2/min pose=(%.0f,%.0f,%.0f°) x%.0f tiempo real\n",
+         r.mapa.c_str(), r.semilla, r.segundos, r.velMediaCmS, 100.0 * r.fraccionDetenido,
+         r.colisiones, r.escaneosBloqueantes, r.coberturaM2Min, e.x, e.y,
+         e.rumbo * 180.0 / M_PI, r.tiempoRealS > 0 ? r.segundos / r.tiempoRealS : 0);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include "simulador.h"
+
+#include <math.h>
+#include <random>
+
+static void pared(Mapa &m, float x1, float y1, float x2, float y2) {
+  m.paredes.push_back({x1, y1, x2, y2});
+}
+
+static void caja(Mapa &m, float x, float y, float ancho, float alto) {
+  pared(m, x, y, x + ancho, y);
+  pared(m, x + ancho, y, x + ancho, y + alto);
+  pared(m, x + ancho, y + alto, x, y + alto);
+  pared(m, x, y + alto, x, y);
+}
+
+static Mapa recinto(const char *nombre, float ancho, float alto,
+                    float x0, float y0, float rumboGrados) {
+  Mapa m;
+  m.nombre = nombre;
+  m.ancho = ancho;
+  m.alto = alto;
+  m.x0 = x0;
+  m.y0 = y0;
+  m.rumbo0 = rumboGrados * (float)M_PI / 180.0f;
+  caja(m, 0, 0, ancho, alto);
+  return m;
+}
+
+// Habitación de 3x3 m con una caja en el centro
+static Mapa sala(uint32_t) {
+  Mapa m = recinto("sala", 300, 300, 50, 50, 45);
+  caja(m, 120, 120, 60, 60);
+  return m;
+}
+
+// Pasillo en L de 70 cm de ancho
+static Mapa pasillo(uint32_t) {
+  Mapa m = recinto("pasillo", 600, 400, 40, 35, 0);
+  caja(m, 0, 70, 530, 330);
+  return m;
+}
+
+// Recinto de 4x4 m con cajas al azar (según la semilla)
+static Mapa obstaculos(uint32_t semilla) {
+  Mapa m = recinto("obstaculos", 400, 400, 40, 40, 45);
+  std::mt19937 rng(semilla);
+  std::uniform_real_distribution<float> lado(20, 50), pos(30, 330);
+  for (int i = 0; i < 8; i++) {
+    float x = pos(rng), y = pos(rng);
+    if (x < 100 && y < 100) continue;  // Dejar libre la salida
+    caja(m, x, y, lado(rng), lado(rng));
+  }
+  return m;
+}
+
+// Callejón sin salida: arranca dentro mirando al fondo cerrado
+static Mapa callejon(uint32_t) {
+  Mapa m = recinto("callejon", 400, 300, 80, 150, 0);
+  pared(m, 50, 120, 250, 120);
+  pared(m, 50, 180, 250, 180);
+  pared(m, 250, 120, 250, 180);
+  return m;
+}
+
+// Dos habitaciones unidas por una puerta estrecha de 45 cm
+static Mapa puertas(uint32_t) {
+  Mapa m = recinto("puertas", 600, 300, 60, 60, 30);
+  pared(m, 300, 0, 300, 130);
+  pared(m, 300, 175, 300, 300);
+  return m;
+}
+
+struct EntradaMapa {
+  const char *nombre;
+  Mapa (*crear)(uint32_t semilla);
+};
+
+static const EntradaMapa MAPAS[] = {
+  {"sala", sala},
+  {"pasillo", pasillo},
+  {"obstaculos", obstaculos},
+  {"callejon", callejon},
+  {"puertas", puertas},
+};
+
+bool simMapaPorNombre(const std::string &nombre, uint32_t semilla, Mapa &mapa) {
+  for (const EntradaMapa &e : MAPAS) {
+    if (nombre == e.nombre) {
+      mapa = e.crear(semilla);
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<std::string> simNombresMapas() {
+  std::vector<std::string> nombres;
+  for (const EntradaMapa &e : MAPAS) nombres.push_back(e.nombre);
+  return nombres;
+}
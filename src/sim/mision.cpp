@@ -0,0 +1,112 @@
+#include "mision.h"
+#include "barrido.h"
+#include "navegacion.h"
+#include "odometria.h"
+#include "parametros.h"
+#include "emergencia.h"
+
+#include <math.h>
+
+#include <chrono>
+
+void setup();
+void loop();
+
+#define ESCAPE_RADIO_CM 50.0  // Distancia al punto de la primera maniobra para darla por resuelta
+
+// Episodio de evasión: desde la primera maniobra (RETROCESO o RECUPERACION)
+// hasta que el robot vuelve a avanzar a más de ESCAPE_RADIO_CM de donde
+// empezó. Las maniobras encadenadas dentro del radio son el mismo episodio.
+struct Escapes {
+  bool activo = false;
+  double inicioS = 0, x0 = 0, y0 = 0;
+  uint32_t episodios = 0;
+  double sumaS = 0, maxS = 0;
+
+  void cerrar(double ahoraS) {
+    double d = ahoraS - inicioS;
+    sumaS += d;
+    if (d > maxS) maxS = d;
+    episodios++;
+    activo = false;
+  }
+
+  void observar(const EstadoSim &e, EstadoNav nav) {
+    if (!activo && (nav == NAV_RETROCESO || nav == NAV_RECUPERACION)) {
+      activo = true;
+      inicioS = e.tiempoS;
+      x0 = e.x;
+      y0 = e.y;
+    } else if (activo && (nav == NAV_CRUCERO || nav == NAV_LENTO || nav == NAV_PARED) &&
+               hypot(e.x - x0, e.y - y0) >= ESCAPE_RADIO_CM) {
+      cerrar(e.tiempoS);
+    }
+  }
+};
+
+static std::vector<std::pair<uint8_t, int16_t> > parametrosMision;
+
+void misionFijarParametros(const std::vector<std::pair<uint8_t, int16_t> > &valores) {
+  parametrosMision = valores;
+}
+
+static ParametrosFisicos fisicaMision;
+
+void misionFijarFisica(const ParametrosFisicos &fisica) {
+  fisicaMision = fisica;
+}
+
+ResultadoMision ejecutarMision(const Mapa &mapa, uint32_t semilla, double segundos) {
+  auto inicio = std::chrono::steady_clock::now();
+  simIniciar(mapa, semilla, fisicaMision);
+  if (!parametrosMision.empty()) {
+    // simIniciar() deja la EEPROM borrada: setup() los carga de la imagen
+    // Ya comprobados juntos (main_nativo.cpp): uno a uno, parametroFijar()
+    // rechazaría los pasos intermedios que incumplen una pareja
+    parametrosIniciar();
+    for (const auto &p : parametrosMision) parametros[p.first] = p.second;
+    parametrosGuardar();
+    while (!parametrosActualizar()) {
+    }
+  }
+  setup();
+  Escapes escapes;
+  while (simEstado().tiempoS < segundos) {
+    loop();
+    simAvanzarUs(PASO_BUCLE_US);
+    escapes.observar(simEstado(), navegacionEstado());
+  }
+  // Uno sin resolver al acabar cuenta lo que lleva (cota inferior)
+  if (escapes.activo) escapes.cerrar(simEstado().tiempoS);
+
+  const EstadoSim &e = simEstado();
+  ResultadoMision r;
+  r.mapa = mapa.nombre;
+  r.semilla = semilla;
+  r.segundos = e.tiempoS;
+  r.velMediaCmS = e.avanceCm / e.tiempoS;
+  r.fraccionDetenido = e.tiempoDetenidoS / e.tiempoS;
+  r.escaneosBloqueantes = barridoEscaneos();
+  r.latenciaEscaneoMs = r.escaneosBloqueantes ? (double)barridoDuracionEscaneosMs() / r.escaneosBloqueantes : 0;
+  r.colisiones = e.colisiones;
+  r.paradas = navegacionParadas();
+  r.escapeMedioS = escapes.episodios ? escapes.sumaS / escapes.episodios : 0;
+  r.escapeMaxS = escapes.maxS;
+  r.recBloqueo = navegacionRecuperaciones(REC_BLOQUEO_FISICO);
+  r.recAtasco = navegacionRecuperaciones(REC_ATASCO);
+  r.recTiempo = navegacionRecuperaciones(REC_TIEMPO);
+  r.coberturaM2Min = e.celdasVisitadas * (SIM_CELDA_CM * SIM_CELDA_CM / 10000.0) / (e.tiempoS / 60.0);
+
+  // La odometría parte de (0, 0, 0) en la pose inicial del mapa
+  PoseOdometria odo = odometriaPose();
+  double ox = mapa.x0 + (odo.xMm * cos(mapa.rumbo0) - odo.yMm * sin(mapa.rumbo0)) / 10.0;
+  double oy = mapa.y0 + (odo.xMm * sin(mapa.rumbo0) + odo.yMm * cos(mapa.rumbo0)) / 10.0;
+  r.errorOdometriaCm = hypot(ox - e.x, oy - e.y);
+  r.errorServoMaxGrados = e.errorServoAsentadoMax;
+  r.errorServoMovGrados = e.disparosMovimiento ? e.errorServoMovimiento / e.disparosMovimiento : 0;
+  r.corrientePicoA = e.corrientePicoA;
+  r.emergencias = emergenciaParadas();
+  r.latenciaEmergenciaMaxUs = emergenciaLatenciaMaxUs();
+  r.tiempoRealS = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+  return r;
+}
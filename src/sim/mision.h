@@ -0,0 +1,51 @@
+#ifndef MISION_H
+#define MISION_H
+
+// Una misión: reinicia el simulador, ejecuta setup() y loop() durante el
+// tiempo pedido y resume las métricas del simulador y del firmware.
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "simulador.h"
+
+#define PASO_BUCLE_US 250UL  // Tiempo virtual entre dos pasadas de loop()
+
+struct ResultadoMision {
+  std::string mapa;
+  uint32_t semilla;
+  double segundos;
+  double velMediaCmS;         // Avance hacia delante / tiempo total
+  double fraccionDetenido;
+  uint32_t escaneosBloqueantes;
+  double latenciaEscaneoMs;   // Espera media por escaneo bloqueante
+  uint32_t colisiones;
+  uint32_t paradas;           // Detenciones por obstáculo al frente
+  double escapeMedioS;        // Tiempo medio hasta salir de una evasión (ver mision.cpp)
+  double escapeMaxS;
+  uint32_t recBloqueo;        // Recuperaciones por bloqueo físico
+  uint32_t recAtasco;         // Recuperaciones por sensor bloqueado
+  uint32_t recTiempo;         // Recuperaciones por 10 s sin progreso
+  double coberturaM2Min;      // Área barrida por minuto
+  double errorOdometriaCm;    // Pose de odometría frente a la real al final
+  double errorServoMaxGrados; // Eje real frente al modelo en disparos con el servo asentado
+  double errorServoMovGrados; // Media en los disparos con el servo en movimiento
+  double corrientePicoA;      // Máxima de un motor (simulador.h)
+  uint32_t emergencias;       // Paradas de emergencia del ISR del eco (emergencia.h)
+  double latenciaEmergenciaMaxUs;
+  double tiempoRealS;
+};
+
+ResultadoMision ejecutarMision(const Mapa &mapa, uint32_t semilla, double segundos);
+
+// Valores de parametros.h (id, valor) que las misiones siguientes encuentran
+// guardados en la EEPROM, como si se hubieran fijado por la consola. Vacío
+// = los de configuracion.h.
+void misionFijarParametros(const std::vector<std::pair<uint8_t, int16_t> > &valores);
+
+// Física de las misiones siguientes (por defecto, la de simulador.h)
+void misionFijarFisica(const ParametrosFisicos &fisica);
+
+#endif
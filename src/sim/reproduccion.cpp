@@ -0,0 +1,267 @@
+#include "reproduccion.h"
+#include "simulador.h"
+#include "mision.h"
+#include "hal_nativo.h"
+#include "configuracion.h"
+#include "ultrasonido.h"
+#include "encoders.h"
+#include "parametros.h"
+#include "navegacion.h"
+#include "traza.h"
+#include "trama_traza.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+void setup();
+void loop();
+
+#if TRAZA
+
+struct Traza {
+  std::vector<EventoTraza> eventos;
+  uint32_t origenUs = 0;         // Base de la primera trama (trazaIniciar())
+  uint32_t tramas = 0;
+  uint32_t tramasPerdidas = 0;   // Huecos en la secuencia
+  uint32_t eventosPerdidos = 0;  // Cola llena en el robot
+  uint32_t erroneos = 0;         // Tramas con el CRC bien y un evento mal
+};
+
+// Busca las tramas con CRC válido entre el resto de la salida Serial
+static Traza extraer(const std::vector<uint8_t> &bytes) {
+  Traza t;
+  uint8_t secuencia = 0;
+  size_t i = 0;
+  while (i + TRAZA_CABECERA + 4 + 2 <= bytes.size()) {
+    const uint8_t *p = &bytes[i];
+    size_t carga = p[4];
+    size_t total = TRAZA_CABECERA + carga + 2;
+    if (p[0] != TRAZA_SINC_0 || p[1] != TRAZA_SINC_1 || p[2] != TRAZA_VERSION || carga < 4 ||
+        carga > TRAZA_CARGA_MAX || i + total > bytes.size() ||
+        crc16Ccitt(p, TRAZA_CABECERA + carga) != (p[total - 2] | (p[total - 1] << 8))) {
+      i++;
+      continue;
+    }
+
+    if (t.tramas > 0) t.tramasPerdidas += (uint8_t)(p[3] - secuencia - 1);
+    secuencia = p[3];
+    const uint8_t *q = p + TRAZA_CABECERA;
+    uint32_t tiempo = q[0] | (q[1] << 8) | (q[2] << 16) | ((uint32_t)q[3] << 24);
+    if (t.tramas == 0) t.origenUs = tiempo;
+    t.tramas++;
+
+    const uint8_t *fin = q + carga;
+    for (q += 4; q < fin;) {
+      EventoTraza e;
+      uint8_t n = trazaDecodificar(q, fin, tiempo, e);
+      if (n == 0) {
+        t.erroneos++;
+        break;
+      }
+      q += n;
+      if (e.tipo == TRAZA_PERDIDOS) t.eventosPerdidos += e.dato;
+      t.eventos.push_back(e);
+    }
+    i += total;
+  }
+  return t;
+}
+
+static bool leerFichero(const std::string &nombre, std::vector<uint8_t> &bytes) {
+  FILE *f = fopen(nombre.c_str(), "rb");
+  if (!f) return false;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+static std::vector<EventoTraza> decisiones(const std::vector<EventoTraza> &eventos, uint32_t hastaUs) {
+  std::vector<EventoTraza> d;
+  for (const EventoTraza &e : eventos) {
+    if (e.tipo == TRAZA_ESTADO && (int32_t)(e.us - hastaUs) <= 0) d.push_back(e);
+  }
+  return d;
+}
+
+int grabarTraza(const std::string &fichero, const std::string &nombreMapa, uint32_t semilla,
+                double segundos) {
+  Mapa mapa;
+  if (!simMapaPorNombre(nombreMapa, semilla, mapa)) {
+    fprintf(stderr, "mapa desconocido: %s\n", nombreMapa.c_str());
+    return 2;
+  }
+  std::vector<uint8_t> salida;
+  halCapturarSerie(&salida);
+  ResultadoMision r = ejecutarMision(mapa, semilla, segundos);
+  halCapturarSerie(nullptr);
+
+  FILE *f = fopen(fichero.c_str(), "wb");
+  if (!f || fwrite(salida.data(), 1, salida.size(), f) != salida.size()) {
+    fprintf(stderr, "no se puede escribir %s\n", fichero.c_str());
+    if (f) fclose(f);
+    return 2;
+  }
+  fclose(f);
+  Traza t = extraer(salida);
+  printf("grabado %s: %s semilla %u, %.1f s, %zu bytes de Serial, %u tramas, %zu eventos, "
+         "%u perdidos\n",
+         fichero.c_str(), r.mapa.c_str(), r.semilla, r.segundos, salida.size(), t.tramas,
+         t.eventos.size(), t.eventosPerdidos);
+  return 0;
+}
+
+// Entradas pendientes de entregar, en orden de grabación
+static std::vector<EventoTraza> entradas;
+static size_t siguiente = 0;
+static std::map<uint8_t, std::deque<int> > lecturasAdc;
+
+// Lo que habría hecho el ISR, en el instante grabado y no al final del
+// paso del bucle: millis() y el orden frente a loop() quedan como en el robot
+static void entregar(unsigned long long hastaUs) {
+  while (siguiente < entradas.size()) {
+    const EventoTraza &e = entradas[siguiente];
+    long faltaUs = (int32_t)(e.us - (uint32_t)micros());
+    if (faltaUs < 0) faltaUs = 0;
+    // El eco se apuntó dentro del ISR: cuenta el instante del flanco, que
+    // puede caer en este avance aunque el apunte quede en el siguiente
+    unsigned long entradaUs = e.tipo == TRAZA_ECO ? SIM_ENTRADA_ISR_US : 0;
+    if (simRelojUs() + faltaUs > hastaUs + entradaUs) break;
+    simGastarUs(faltaUs);
+    siguiente++;
+    switch (e.tipo) {
+      case TRAZA_PULSO_IZQ:
+      case TRAZA_PULSO_DER:
+        encoderPulso(e.tipo - TRAZA_PULSO_IZQ, e.us - e.dato);
+        break;
+      case TRAZA_ECO:
+        if (e.dato > 0) {
+          ultrasonidoFlancoEco(true, e.us - e.dato);
+          ultrasonidoFlancoEco(false, e.us);
+        }
+        break;
+      case TRAZA_PARAMETRO:
+        parametroFijar(e.canal, (int16_t)e.dato);
+        break;
+    }
+  }
+}
+
+static int adcGrabado(uint8_t pin) {
+  std::deque<int> &cola = lecturasAdc[pin];
+  if (cola.empty()) return 0;
+  int v = cola.front();
+  cola.pop_front();
+  return v;
+}
+
+static void imprimirDecision(const char *quien, const EventoTraza &e, uint32_t origenUs) {
+  printf("  %-12s t=%9.3f s  %s\n", quien, (e.us - origenUs) / 1e6,
+         (const char *)navegacionNombreEstado((EstadoNav)e.dato));
+}
+
+int reproducirTraza(const std::string &fichero) {
+  std::vector<uint8_t> bytes;
+  if (!leerFichero(fichero, bytes)) {
+    fprintf(stderr, "no se puede leer %s\n", fichero.c_str());
+    return 2;
+  }
+  Traza grabada = extraer(bytes);
+  if (grabada.tramas == 0) {
+    fprintf(stderr, "%s: no hay tramas de traza (¿firmware sin -D TRAZA=1?)\n", fichero.c_str());
+    return 2;
+  }
+  uint32_t finUs = grabada.eventos.empty() ? grabada.origenUs : grabada.eventos.back().us;
+  printf("traza %s: %u tramas (%u perdidas), %zu eventos (%u perdidos en el robot), %.1f s\n",
+         fichero.c_str(), grabada.tramas, grabada.tramasPerdidas, grabada.eventos.size(),
+         grabada.eventosPerdidos, (finUs - grabada.origenUs) / 1e6);
+  if (grabada.tramasPerdidas || grabada.eventosPerdidos || grabada.erroneos) {
+    printf("aviso: la traza está incompleta, la reproducción puede divergir\n");
+  }
+
+  // Los parámetros del arranque van delante de todo lo demás
+  std::vector<int16_t> iniciales;
+  entradas.clear();
+  lecturasAdc.clear();
+  for (const EventoTraza &e : grabada.eventos) {
+    if (e.tipo == TRAZA_PARAMETRO && entradas.empty() && iniciales.size() == e.canal) {
+      iniciales.push_back((int16_t)e.dato);
+    } else if (e.tipo == TRAZA_ANALOGICA) {
+      lecturasAdc[e.canal].push_back((int)e.dato);
+    } else if (e.tipo != TRAZA_ESTADO && e.tipo != TRAZA_PERDIDOS) {
+      entradas.push_back(e);
+    }
+  }
+  siguiente = 0;
+
+  Mapa vacio = {"reproduccion", 100, 100, 50, 50, 0, {}};
+  simIniciar(vacio, 1);
+  simSinFisica(entregar);
+  ultrasonidoMockEco = nullptr;
+  halAnalogico = adcGrabado;
+
+  // Los valores del arranque en la EEPROM, como los tenía el robot
+  parametrosIniciar();
+  for (uint8_t i = 0; i < iniciales.size() && i < PARAMETROS; i++) parametroFijar(i, iniciales[i]);
+  parametrosGuardar();
+  while (!parametrosActualizar()) {
+  }
+
+  std::vector<uint8_t> salida;
+  halCapturarSerie(&salida);
+  simAvanzarUs(grabada.origenUs);
+  setup();
+  while ((int32_t)(micros() - finUs) <= 0) {
+    loop();
+    simAvanzarUs(PASO_BUCLE_US);
+  }
+  trazaEnviar();
+  halCapturarSerie(nullptr);
+  if (siguiente < entradas.size()) {
+    printf("aviso: %zu entradas sin entregar\n", entradas.size() - siguiente);
+  }
+
+  // Comparación de las transiciones de la navegación
+  std::vector<EventoTraza> a = decisiones(grabada.eventos, finUs);
+  std::vector<EventoTraza> b = decisiones(extraer(salida).eventos, finUs);
+  size_t comunes = a.size() < b.size() ? a.size() : b.size();
+  size_t iguales = 0;
+  long desfaseMaxUs = 0;
+  while (iguales < comunes) {
+    long desfase = labs((long)(int32_t)(b[iguales].us - a[iguales].us));
+    if (a[iguales].dato != b[iguales].dato || desfase > REPRODUCCION_TOLERANCIA_MS * 1000L) break;
+    if (desfase > desfaseMaxUs) desfaseMaxUs = desfase;
+    iguales++;
+  }
+
+  printf("decisiones: %zu grabadas, %zu reproducidas, %zu iguales (desfase máximo %.1f ms)\n",
+         a.size(), b.size(), iguales, desfaseMaxUs / 1000.0);
+  if (iguales == a.size() && iguales == b.size()) {
+    printf("sin divergencias\n");
+    return 0;
+  }
+  printf("primera divergencia (decisión %zu):\n", iguales + 1);
+  if (iguales < a.size()) imprimirDecision("grabada", a[iguales], grabada.origenUs);
+  if (iguales < b.size()) imprimirDecision("reproducida", b[iguales], grabada.origenUs);
+  return 1;
+}
+
+#else
+
+int grabarTraza(const std::string &, const std::string &, uint32_t, double) {
+  fprintf(stderr, "compilar con -D TRAZA=1 para grabar trazas\n");
+  return 2;
+}
+
+int reproducirTraza(const std::string &) {
+  fprintf(stderr, "compilar con -D TRAZA=1 para reproducir trazas\n");
+  return 2;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef REPRODUCCION_H
+#define REPRODUCCION_H
+
+// Grabación y reproducción de trazas de sensores (traza.h, -D TRAZA=1).
+//
+// Grabar: una misión del simulador con la salida Serial volcada a un
+// fichero, igual que la captura del puerto serie del robot real
+// (stty -F /dev/ttyACM0 115200 raw; cat /dev/ttyACM0 > fichero).
+//
+// Reproducir: se extraen las tramas de traza del volcado (el texto y la
+// telemetría de por medio se ignoran) y se ejecutan setup()/loop() con
+// el reloj virtual pero sin física: los pulsos de encoder y los ecos se
+// entregan a sus ISR en el instante grabado, las lecturas analógicas
+// (IR, batería) se devuelven en orden y los cambios de parametros[] se
+// aplican en su momento (los del arranque, desde la EEPROM). Después se
+// comparan las transiciones de la navegación de la reproducción con las
+// grabadas.
+//
+// Con la traza de un robot real la reproducción es determinista pero no
+// exacta: el simulador no tiene en cuenta lo que tarda el código. No se
+// reproducen las órdenes de consola (solo su efecto en parametros[]) ni
+// las curvas de calibración de la EEPROM.
+
+#include <stdint.h>
+#include <string>
+
+#define REPRODUCCION_TOLERANCIA_MS 50  // Desfase que aún cuenta como la misma decisión
+
+int grabarTraza(const std::string &fichero, const std::string &nombreMapa, uint32_t semilla,
+                double segundos);
+
+// 0 si las decisiones coinciden, 1 si divergen, 2 si la traza no vale
+int reproducirTraza(const std::string &fichero);
+
+#endif
@@ -0,0 +1,369 @@
+#include "simulador.h"
+#include "hal_nativo.h"
+#include "configuracion.h"
+#include "ultrasonido.h"
+#include "encoders.h"
+#include "telemetros.h"
+#include "servo_sensor.h"
+
+#include <math.h>
+#include <random>
+
+#define PASO_FISICA_US 1000UL
+
+bool simVerbose = false;
+
+static Mapa mapa;
+static ParametrosFisicos fisica;
+static EstadoSim estado;
+static std::mt19937 rng;
+static unsigned long long relojUs = 0;
+static unsigned long long fisicaUs = 0;     // Inicio del paso de física en curso
+static unsigned long long tramaServoUs = 0; // Próxima trama de la librería Servo
+static std::vector<uint8_t> visitadas;      // Rejilla de cobertura
+static int columnas = 0, filas = 0;
+static void (*sinFisica)(unsigned long long hastaUs) = nullptr;
+
+static const float GRADOS = (float)M_PI / 180.0f;
+
+// ---- Geometría ----
+
+static float distanciaASegmento(float px, float py, const Segmento &s) {
+  float dx = s.x2 - s.x1, dy = s.y2 - s.y1;
+  float largo2 = dx * dx + dy * dy;
+  float t = largo2 > 0 ? ((px - s.x1) * dx + (py - s.y1) * dy) / largo2 : 0;
+  t = t < 0 ? 0 : (t > 1 ? 1 : t);
+  float cx = s.x1 + t * dx - px, cy = s.y1 + t * dy - py;
+  return sqrtf(cx * cx + cy * cy);
+}
+
+static bool chocaEn(float x, float y) {
+  for (const Segmento &s : mapa.paredes) {
+    if (distanciaASegmento(x, y, s) < fisica.radioCm) return true;
+  }
+  return false;
+}
+
+float simRaycast(float x, float y, float angulo, float *incidencia) {
+  float dx = cosf(angulo), dy = sinf(angulo);
+  float mejor = -1;
+  for (const Segmento &s : mapa.paredes) {
+    float ex = s.x2 - s.x1, ey = s.y2 - s.y1;
+    float den = dx * ey - dy * ex;
+    if (fabsf(den) < 1e-6f) continue;
+    float t = ((s.x1 - x) * ey - (s.y1 - y) * ex) / den;  // A lo largo del rayo
+    float u = ((s.x1 - x) * dy - (s.y1 - y) * dx) / den;  // A lo largo del segmento
+    if (t <= 0 || u < 0 || u > 1) continue;
+    if (mejor < 0 || t < mejor) {
+      mejor = t;
+      if (incidencia) {
+        float largo = sqrtf(ex * ex + ey * ey);
+        float coseno = fabsf(dx * -ey + dy * ex) / largo;  // Rayo · normal
+        *incidencia = acosf(coseno > 1 ? 1 : coseno);
+      }
+    }
+  }
+  return mejor;
+}
+
+unsigned long simEcoUltrasonido(float anguloGrados) {
+  estado.disparos++;
+  float sx = estado.x + fisica.sensorAdelanteCm * cosf(estado.rumbo);
+  float sy = estado.y + fisica.sensorAdelanteCm * sinf(estado.rumbo);
+  float centro = estado.rumbo + (anguloGrados - 90.0f) * GRADOS;
+
+  // Cinco rayos dentro del cono; vale el más cercano que vuelva
+  float dist = -1;
+  for (int i = -2; i <= 2; i++) {
+    float incidencia = 0;
+    float d = simRaycast(sx, sy, centro + i * fisica.conoGrados * 0.25f * GRADOS, &incidencia);
+    if (d < 0 || incidencia > fisica.incidenciaMaxGrados * GRADOS) continue;
+    if (dist < 0 || d < dist) dist = d;
+  }
+
+  std::uniform_real_distribution<float> uniforme(0, 1);
+  if (dist < 0 || uniforme(rng) < fisica.perdidaEco) {
+    estado.ecosPerdidos++;
+    return 0;
+  }
+  std::normal_distribution<float> ruido(0, fisica.ruidoCm);
+  dist += ruido(rng);
+  if (dist < 2 || dist > fisica.alcanceMaxCm) return 0;
+  return (unsigned long)(dist / 0.017f);
+}
+
+// Los sensores fijos van en el mismo punto que el del servo
+static unsigned long ecoCanal(uint8_t canal) {
+  int angulo = telemetrosAnguloCanal(canal);
+  if (angulo != TELEMETRO_EN_SERVO) return simEcoUltrasonido((float)angulo);
+
+  float error = fabsf(estado.servoGrados - servoAnguloEstimado());
+  if (servoAsentado()) {
+    if (error > estado.errorServoAsentadoMax) estado.errorServoAsentadoMax = error;
+  } else {
+    estado.errorServoMovimiento += error;
+    estado.disparosMovimiento++;
+  }
+  return simEcoUltrasonido(estado.servoGrados);
+}
+
+// IR: un solo rayo (el haz es estrecho) y la curva de telemetroIrACm()
+// invertida; sin impacto o más allá de su alcance, lo que da una pared a
+// 2 m. Batería: el divisor sin ruido, redondeado al paso del ADC.
+int simLecturaAnalogica(uint8_t pin) {
+  if (pin == BATERIA_PIN) {
+    float pinMv = estado.bateriaV * 1000.0f * 10 / BATERIA_DIVISOR_X10;
+    int adc = (int)(pinMv * 1023 / 5000 + 0.5f);
+    return adc > 1023 ? 1023 : adc;
+  }
+  for (uint8_t i = 0; i < telemetrosCantidad(); i++) {
+    const Telemetro &t = telemetro(i);
+    if (t.tipo != TELEMETRO_IR || t.pinA != pin) continue;
+    float sx = estado.x + fisica.sensorAdelanteCm * cosf(estado.rumbo);
+    float sy = estado.y + fisica.sensorAdelanteCm * sinf(estado.rumbo);
+    float d = simRaycast(sx, sy, estado.rumbo + (t.angulo - 90.0f) * GRADOS);
+    if (d < 0 || d > 200) d = 200;
+    std::normal_distribution<float> ruido(0, fisica.ruidoCm);
+    d += ruido(rng);
+    if (d < 1) d = 1;
+    int adc = (int)(4800.0f / d + 20.5f);
+    return adc > 1023 ? 1023 : adc;
+  }
+  return 0;
+}
+
+// Marca las celdas cuyo centro queda bajo el chasis
+static void marcarCobertura() {
+  float r = fisica.radioCm;
+  int c0 = (int)((estado.x - r) / SIM_CELDA_CM), c1 = (int)((estado.x + r) / SIM_CELDA_CM);
+  int f0 = (int)((estado.y - r) / SIM_CELDA_CM), f1 = (int)((estado.y + r) / SIM_CELDA_CM);
+  for (int f = f0; f <= f1; f++) {
+    for (int c = c0; c <= c1; c++) {
+      if (c < 0 || f < 0 || c >= columnas || f >= filas) continue;
+      float dx = (c + 0.5f) * SIM_CELDA_CM - estado.x;
+      float dy = (f + 0.5f) * SIM_CELDA_CM - estado.y;
+      uint8_t &celda = visitadas[f * columnas + c];
+      if (!celda && dx * dx + dy * dy <= r * r) {
+        celda = 1;
+        estado.celdasVisitadas++;
+      }
+    }
+  }
+}
+
+// ---- Encoders ----
+
+// Un pulso cada vez que la rueda avanza una ranura, con la marca de tiempo
+// interpolada dentro del paso (el ISR real mide periodos, no pasos)
+static void pulsosEncoder(int rueda, float v, float dt) {
+  float cmPorPulso = (float)M_PI * fisica.diametroRuedaCm / fisica.ranurasEncoder;
+  float antes = estado.giroRuedaCm[rueda];
+  float despues = antes + fabsf(v) * dt;
+  for (float marca = cmPorPulso; marca <= despues; marca += cmPorPulso) {
+    float fraccion = (marca - antes) / (despues - antes);
+    encoderPulso(rueda, (unsigned long)(fisicaUs + (unsigned long long)(fraccion * dt * 1e6f)));
+  }
+  estado.giroRuedaCm[rueda] = fmodf(despues, cmPorPulso);
+}
+
+// ---- Motores (L298N) y batería ----
+
+// Tensión en bornes con la corriente que piden ahora los motores
+static float actualizarBateria(float dt) {
+  float corriente = fisica.corrienteBaseA;
+  const uint8_t pines[2][3] = {{MOTOR_IZQ_IN1, MOTOR_IZQ_IN2, MOTOR_IZQ_ENA},
+                               {MOTOR_DER_IN3, MOTOR_DER_IN4, MOTOR_DER_ENB}};
+  for (const auto &p : pines) {
+    if (halPin(p[0]) != halPin(p[1])) corriente += fisica.corrienteMotorA * halPwm(p[2]) / 255.0f;
+  }
+  float gastado = fisica.capacidadAs > 0 ? (float)(estado.consumoAs / fisica.capacidadAs) : 0;
+  if (gastado > 1) gastado = 1;
+  float vacio = fisica.bateriaLlenaV - (fisica.bateriaLlenaV - fisica.bateriaVaciaV) * gastado;
+  estado.bateriaV = vacio - fisica.resistenciaOhm * corriente;
+  estado.consumoAs += corriente * dt;
+  return estado.bateriaV / fisica.tensionNominalV;
+}
+
+static void paso(float dt) {
+  const float limite = 255.0f - fisica.zonaMuertaPwm;
+  const float tension = actualizarBateria(dt);  // Relativa a la nominal
+
+  struct Puente { uint8_t a, b, en; float vMax; float *v; };
+  Puente puentes[2] = {
+    {MOTOR_IZQ_IN1, MOTOR_IZQ_IN2, MOTOR_IZQ_ENA, fisica.vMaxIzq, &estado.vIzq},
+    {MOTOR_DER_IN3, MOTOR_DER_IN4, MOTOR_DER_ENB, fisica.vMaxDer, &estado.vDer},
+  };
+
+  for (Puente &p : puentes) {
+    bool a = halPin(p.a), b = halPin(p.b);
+    int pwm = halPwm(p.en);
+    float objetivo = 0, tau = fisica.tauLibre, corriente = 0;
+    float d = pwm / 255.0f, fcem = *p.v / p.vMax;
+    if (pwm > 0 && a != b) {
+      float util = pwm * tension - fisica.zonaMuertaPwm;
+      objetivo = (util > 0 ? util / limite : 0) * p.vMax * (a ? 1.0f : -1.0f);
+      tau = fisica.tauMotor;
+      // Invertir a toda velocidad suma las dos tensiones: casi el doble
+      // que arrancar parado
+      corriente = fabsf(d * tension * (a ? 1.0f : -1.0f) - fcem);
+    } else if (pwm > 0) {
+      // Freno (IN1 = IN2 con EN activo): en corto una fracción duty del
+      // tiempo y libre el resto
+      tau = 1.0f / (d / fisica.tauFreno + (1 - d) / fisica.tauLibre);
+      corriente = d * fabsf(fcem);
+    }
+    corriente *= fisica.corrienteBloqueoA;
+    if (corriente > estado.corrientePicoA) estado.corrientePicoA = corriente;
+    *p.v += (objetivo - *p.v) * (dt / (tau + dt));
+  }
+
+  // Las ruedas giran aunque el chasis esté contra una pared (patinan)
+  pulsosEncoder(ENCODER_IZQ, estado.vIzq, dt);
+  pulsosEncoder(ENCODER_DER, estado.vDer, dt);
+
+  // Cinemática diferencial
+  float v = (estado.vIzq + estado.vDer) * 0.5f;
+  float w = (estado.vDer - estado.vIzq) / fisica.ejeCm;
+  float rumbo = estado.rumbo + w * dt;
+  float x = estado.x + v * cosf(rumbo) * dt;
+  float y = estado.y + v * sinf(rumbo) * dt;
+
+  bool choque = fabsf(v) > 0.01f && chocaEn(x, y);
+  if (choque) {
+    // La pared frena el avance; el giro sobre el propio eje sigue posible
+    x = estado.x;
+    y = estado.y;
+    if (!estado.enColision) estado.colisiones++;
+    estado.enColision = true;
+    estado.libreS = 0;
+    estado.tiempoColisionS += dt;
+  } else {
+    estado.recorridoCm += fabsf(v) * dt;
+    if (v > 0) estado.avanceCm += v * dt;
+    // El contacto acaba tras un paso entero sin tocar: un tramo más corto
+    // que un paso no basta para separarse de la pared
+    estado.libreS += dt;
+    if (estado.libreS >= PASO_FISICA_US * 1e-6f) estado.enColision = false;
+  }
+  bool movido = x != estado.x || y != estado.y;
+  estado.x = x;
+  estado.y = y;
+  estado.rumbo = rumbo;
+  if (movido) marcarCobertura();
+
+  if (fabsf(v) < 1.0f && fabsf(w) * fisica.ejeCm * 0.5f < 1.0f) {
+    estado.tiempoDetenidoS += dt;
+  }
+
+  // Servo con velocidad de giro limitada; la librería Servo envía un pulso
+  // cada trama y la orden nueva no llega hasta el siguiente
+  if (fisica.servoTramaMs <= 0 || fisicaUs >= tramaServoUs) {
+    estado.servoTrama = estado.servoPedido;
+    if (fisica.servoTramaMs > 0) {
+      tramaServoUs = (fisicaUs / (fisica.servoTramaMs * 1000ULL) + 1) * fisica.servoTramaMs * 1000ULL;
+    }
+  }
+  float delta = estado.servoTrama - estado.servoGrados;
+  float maxPaso = fisica.servoGradosPorSeg * dt;
+  estado.servoGrados += delta > maxPaso ? maxPaso : (delta < -maxPaso ? -maxPaso : delta);
+
+  estado.tiempoS += dt;
+}
+
+// ---- API ----
+
+void simIniciar(const Mapa &m, uint32_t semilla, const ParametrosFisicos &f) {
+  mapa = m;
+  fisica = f;
+  rng.seed(semilla);
+  estado = EstadoSim();
+  estado.x = m.x0;
+  estado.y = m.y0;
+  estado.rumbo = m.rumbo0;
+  estado.bateriaV = f.bateriaLlenaV;
+  relojUs = 0;
+  fisicaUs = 0;
+  tramaServoUs = 0;
+  columnas = (int)(m.ancho / SIM_CELDA_CM) + 1;
+  filas = (int)(m.alto / SIM_CELDA_CM) + 1;
+  visitadas.assign(columnas * filas, 0);
+  marcarCobertura();
+  halReiniciar();
+  ultrasonidoMockEco = ecoCanal;
+  halAnalogico = simLecturaAnalogica;
+  sinFisica = nullptr;
+}
+
+void simSinFisica(void (*alAvanzar)(unsigned long long hastaUs)) {
+  sinFisica = alAvanzar;
+}
+
+// Integra pasos enteros hasta hastaUs; con exacto, también el tramo final
+// más corto (lo que no se integra queda para el siguiente avance)
+static void integrarHasta(unsigned long long hastaUs, bool exacto) {
+  while (fisicaUs + PASO_FISICA_US <= hastaUs) {
+    relojUs = fisicaUs + PASO_FISICA_US;
+    paso(PASO_FISICA_US * 1e-6f);
+    fisicaUs += PASO_FISICA_US;
+  }
+  if (exacto && fisicaUs < hastaUs) {
+    relojUs = hastaUs;
+    paso((hastaUs - fisicaUs) * 1e-6f);
+    fisicaUs = hastaUs;
+  }
+}
+
+// Con física el reloj avanza paso a paso: lo que ocurre en un paso (pulsos
+// de encoder) ve micros() al final de ese paso y no al final de todo el
+// avance, como en el ISR real con loop() ocupado. Un flanco del eco parte
+// el paso en su instante y llega al ISR tras SIM_ENTRADA_ISR_US; lo que
+// escribe en los pines cuesta lo que en el UNO (hal_nativo.h)
+void simAvanzarUs(unsigned long us) {
+  if (sinFisica) {
+    unsigned long long finUs = relojUs + us;
+    sinFisica(finUs);
+    relojUs = finUs;
+    return;
+  }
+  unsigned long long finUs = relojUs + us;
+  unsigned long flancoUs;
+  while (ultrasonidoMockProximoFlanco(&flancoUs)) {
+    long faltaUs = (long)(flancoUs - (unsigned long)relojUs);
+    unsigned long long enUs = relojUs + (faltaUs > 0 ? faltaUs : 0);
+    if (enUs > finUs) break;
+    integrarHasta(enUs, true);
+    // El coste solo lo ve el propio ISR: fuera de él, micros() vuelve al
+    // flanco y el reloj de loop() no se desplaza
+    relojUs = enUs + SIM_ENTRADA_ISR_US;
+    halIsr(true);
+    ultrasonidoMockFlancos(flancoUs);
+    halIsr(false);
+    relojUs = enUs;
+  }
+  integrarHasta(finUs, false);
+  relojUs = finUs;
+}
+
+void simGastarUs(unsigned long us) {
+  relojUs += us;
+}
+
+unsigned long long simRelojUs() {
+  return relojUs;
+}
+
+const EstadoSim &simEstado() {
+  return estado;
+}
+
+const Mapa &simMapa() {
+  return mapa;
+}
+
+const ParametrosFisicos &simFisica() {
+  return fisica;
+}
+
+void simServoPedido(int angulo) {
+  estado.servoPedido = angulo < 0 ? 0 : (angulo > 180 ? 180 : angulo);
+}
@@ -0,0 +1,138 @@
+#ifndef SIMULADOR_H
+#define SIMULADOR_H
+
+// Simulador 2D de robot diferencial para [env:native].
+// Lee los pines que escribe el firmware (L298N, servo, trigger), integra
+// la cinemática con un modelo simple de motor con asimetría izquierda /
+// derecha y una batería que se descarga y cae con la corriente, genera los
+// pulsos de los encoders y devuelve ecos ultrasónicos por trazado de rayos
+// contra las paredes del mapa (y lecturas de los telémetros fijos, ver
+// telemetros.h, y del divisor de la batería). Unidades: cm, s y radianes
+// (rumbo 0 = +x, antihorario).
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct Segmento {
+  float x1, y1, x2, y2;
+};
+
+struct Mapa {
+  std::string nombre;
+  float ancho, alto;            // Recinto exterior (cm)
+  float x0, y0, rumbo0;         // Pose inicial
+  std::vector<Segmento> paredes;
+};
+
+struct ParametrosFisicos {
+  float vMaxIzq = 66.0f;        // cm/s a PWM 255 (motor izquierdo más rápido)
+  float vMaxDer = 60.0f;
+  float zonaMuertaPwm = 45.0f;  // Por debajo el motor no arranca
+  float tauMotor = 0.08f;       // Constante de tiempo (s) con el puente activo
+  float tauLibre = 0.25f;       // Constante de tiempo en rueda libre
+  float tauFreno = 0.08f;       // Freno del L298N a duty 255 (motor en corto)
+  float ejeCm = 13.0f;          // Separación entre ruedas
+  float radioCm = 9.0f;         // Radio del chasis para colisiones
+  float sensorAdelanteCm = 6.0f;  // Sensor delante del eje
+  float servoGradosPorSeg = 600.0f;
+  int servoTramaMs = 20;        // La orden se aplica al empezar la siguiente trama
+  float conoGrados = 15.0f;     // Apertura del haz del HC-SR04
+  float incidenciaMaxGrados = 55.0f;  // Más oblicuo = el eco no vuelve
+  float alcanceMaxCm = 400.0f;
+  float ruidoCm = 0.5f;
+  float perdidaEco = 0.02f;     // Probabilidad de eco perdido por disparo
+  float diametroRuedaCm = 6.5f; // Encoders: un pulso por ranura
+  int ranurasEncoder = 20;
+
+  // Batería: la tensión en vacío baja en línea recta de llena a vacía al
+  // gastar la capacidad y cae R * I con la corriente. vMax* son a
+  // tensionNominalV; por defecto es ideal (siempre a la nominal).
+  float tensionNominalV = 9.0f;
+  float bateriaLlenaV = 9.0f;
+  float bateriaVaciaV = 7.0f;
+  float capacidadAs = 0;        // Carga útil (A·s), 0 = no se descarga
+  float resistenciaOhm = 0;     // Interna más cables y puente
+  float corrienteMotorA = 0.7f; // Por motor con el PWM a 255
+  float corrienteBaseA = 0.15f; // Arduino, sensores y servo
+  // Pico de un motor: tensión aplicada menos la fuerza contraelectromotriz
+  // (proporcional a la velocidad) sobre el devanado. Solo para la métrica.
+  float corrienteBloqueoA = 2.0f; // Parado con el PWM a 255 y la tensión nominal
+};
+
+struct EstadoSim {
+  double tiempoS = 0;
+  float x = 0, y = 0, rumbo = 0;
+  float vIzq = 0, vDer = 0;     // Velocidad de cada rueda (cm/s)
+  float servoGrados = 90;       // Posición real del eje del servo
+  int servoPedido = 90;         // Última orden (write())
+  int servoTrama = 90;          // Ángulo del pulso que se está enviando
+  float bateriaV = 0;           // En bornes, con la carga del último paso
+  double consumoAs = 0;         // Carga gastada
+
+  // Métricas acumuladas
+  double recorridoCm = 0;       // Distancia recorrida (valor absoluto)
+  double avanceCm = 0;          // Solo hacia delante
+  double tiempoDetenidoS = 0;
+  double tiempoColisionS = 0;
+  uint32_t colisiones = 0;      // Contactos nuevos con paredes
+  bool enColision = false;
+  float libreS = 0;             // Sin tocar desde el último contacto
+  uint32_t disparos = 0;
+  uint32_t ecosPerdidos = 0;
+  // Eje real frente al modelo del firmware (servo_sensor.h) en los disparos
+  // del sensor del servo: con el servo asentado según el modelo y en
+  // movimiento (suma, para la media)
+  float errorServoAsentadoMax = 0;
+  double errorServoMovimiento = 0;
+  uint32_t disparosMovimiento = 0;
+  float corrientePicoA = 0;     // Máxima de un motor (inversiones, frenadas)
+  uint32_t celdasVisitadas = 0; // Celdas de SIM_CELDA_CM barridas por el chasis
+  float giroRuedaCm[2] = {0, 0};  // Avance de cada rueda desde su último pulso
+};
+
+#define SIM_CELDA_CM 10.0f
+
+void simIniciar(const Mapa &mapa, uint32_t semilla,
+                const ParametrosFisicos &fisica = ParametrosFisicos());
+
+// Integra la física y adelanta el reloj virtual
+void simAvanzarUs(unsigned long us);
+
+// Del flanco a la primera instrucción del ISR del eco en el UNO: respuesta
+// a la interrupción y prólogo (unos 45 ciclos a 16 MHz)
+#define SIM_ENTRADA_ISR_US 3UL
+
+// Tiempo que gasta el código de un ISR simulado: avanza micros() mientras
+// dura el ISR, sin integrar la física
+void simGastarUs(unsigned long us);
+
+// Sin física (reproducción de trazas): simAvanzarUs() llama a alAvanzar
+// con el final del avance, que entrega lo que caiga antes adelantando el
+// reloj con simGastarUs() hasta cada instante. simIniciar() vuelve a la física.
+void simSinFisica(void (*alAvanzar)(unsigned long long hastaUs));
+unsigned long long simRelojUs();
+
+const EstadoSim &simEstado();
+const Mapa &simMapa();
+const ParametrosFisicos &simFisica();
+
+// Distancia al primer impacto desde (x, y) en la dirección angulo, o -1.
+// Si incidencia no es nulo devuelve el ángulo entre el rayo y la normal.
+float simRaycast(float x, float y, float angulo, float *incidencia = nullptr);
+
+// Ancho del eco (us) que vería ahora un HC-SR04 mirando a anguloGrados
+// (90 = al frente, como el servo), 0 = sin eco
+unsigned long simEcoUltrasonido(float anguloGrados);
+
+// Lectura del ADC en ese pin: un Sharp GP2Y0A21 de la tabla de telémetros
+// o el divisor de la batería (BATERIA_PIN)
+int simLecturaAnalogica(uint8_t pin);
+
+// Mapas disponibles (ver mapas.cpp)
+bool simMapaPorNombre(const std::string &nombre, uint32_t semilla, Mapa &mapa);
+std::vector<std::string> simNombresMapas();
+
+extern bool simVerbose;
+
+#endif
@@ -0,0 +1,44 @@
+#include "telemetria.h"
+
+static TramaTelemetria cola[TELEMETRIA_COLA];
+static uint8_t cabeza = 0;   // Próxima a enviar
+static uint8_t cantidad = 0;
+static uint8_t secuencia = 0;
+static uint16_t descartadas = 0;
+
+void telemetriaIniciar() {
+  cabeza = 0;
+  cantidad = 0;
+  secuencia = 0;
+  descartadas = 0;
+}
+
+void telemetriaPublicar(TramaTelemetria &trama) {
+  trama.sinc[0] = TRAMA_SINC_0;
+  trama.sinc[1] = TRAMA_SINC_1;
+  trama.version = TRAMA_VERSION;
+  trama.secuencia = secuencia++;
+  trama.descartadas = descartadas;
+  trama.crc = crc16Ccitt((const uint8_t *)&trama, offsetof(TramaTelemetria, crc));
+
+  if (cantidad == TELEMETRIA_COLA) {
+    // Cola llena: se pierde la más vieja, la nueva siempre entra
+    cabeza = (cabeza + 1) % TELEMETRIA_COLA;
+    cantidad--;
+    descartadas++;
+  }
+  cola[(cabeza + cantidad) % TELEMETRIA_COLA] = trama;
+  cantidad++;
+}
+
+void telemetriaEnviar() {
+  while (cantidad > 0 && Serial.availableForWrite() >= (int)sizeof(TramaTelemetria)) {
+    Serial.write((const uint8_t *)&cola[cabeza], sizeof(TramaTelemetria));
+    cabeza = (cabeza + 1) % TELEMETRIA_COLA;
+    cantidad--;
+  }
+}
+
+uint16_t telemetriaDescartadas() {
+  return descartadas;
+}
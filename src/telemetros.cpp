@@ -0,0 +1,89 @@
+#include "telemetros.h"
+#include "configuracion.h"
+#include "ultrasonido.h"
+#include "barrido.h"
+#include "traza.h"
+#include "emergencia.h"
+
+static constexpr Telemetro TABLA[] = {TELEMETROS};
+#define CANTIDAD (sizeof(TABLA) / sizeof(TABLA[0]))
+
+// HC-SR04 de la tabla a partir de i
+static constexpr uint8_t ultrasonidos(uint8_t i = 0) {
+  return i == CANTIDAD ? 0 : (TABLA[i].tipo == TELEMETRO_ULTRASONIDO) + ultrasonidos(i + 1);
+}
+
+static_assert(CANTIDAD <= TELEMETROS_MAX, "demasiados telémetros en TELEMETROS");
+static_assert(ultrasonidos() <= ULTRASONIDO_CANALES,
+              "más HC-SR04 en TELEMETROS que ULTRASONIDO_CANALES");
+static_assert(TABLA[0].tipo == TELEMETRO_ULTRASONIDO && TABLA[0].angulo == TELEMETRO_EN_SERVO,
+              "el primer telémetro es el HC-SR04 del servo");
+
+struct EstadoTelemetro {
+  int8_t canal;              // Canal de ultrasonido.h (-1 en los IR)
+  int16_t angulo;            // Redondeado al sector del buffer polar
+  uint16_t secuencia;        // Última lectura registrada
+  unsigned long lecturaMs;   // IR: última lectura
+};
+
+static EstadoTelemetro estados[CANTIDAD];
+
+void telemetrosIniciar() {
+  for (uint8_t i = 0; i < CANTIDAD; i++) {
+    const Telemetro &t = TABLA[i];
+    EstadoTelemetro &e = estados[i];
+    e.canal = -1;
+    e.angulo = t.angulo == TELEMETRO_EN_SERVO
+                   ? TELEMETRO_EN_SERVO
+                   : (constrain(t.angulo, 0, 180) + BARRIDO_PASO_GRADOS / 2) / BARRIDO_PASO_GRADOS *
+                         BARRIDO_PASO_GRADOS;
+    e.secuencia = 0;
+    e.lecturaMs = millis() - TELEMETRO_IR_PERIODO_MS;
+    if (t.tipo == TELEMETRO_IR) {
+      pinMode(t.pinA, INPUT);
+    } else if (i == 0) {
+      ultrasonidoIniciar(t.pinA, t.pinB);
+      e.canal = 0;
+    } else {
+      e.canal = ultrasonidoAgregar(t.pinA, t.pinB);
+      if (e.canal >= 0) emergenciaVigilar(e.canal, e.angulo == 90, millis());
+    }
+  }
+}
+
+void telemetrosActualizar() {
+  ultrasonidoActualizar();
+
+  // El 0 es el del servo: sus lecturas las registra barrido.h
+  unsigned long ahora = millis();
+  for (uint8_t i = 1; i < CANTIDAD; i++) {
+    EstadoTelemetro &e = estados[i];
+    if (e.canal >= 0) {
+      LecturaUltrasonido lectura = ultrasonidoUltima(e.canal);
+      if (lectura.secuencia == e.secuencia) continue;
+      e.secuencia = lectura.secuencia;
+      barridoRegistrar(e.angulo, ultrasonidoDistanciaCm(lectura), ultrasonidoConEco(lectura));
+    } else if (ahora - e.lecturaMs >= TELEMETRO_IR_PERIODO_MS) {
+      e.lecturaMs = ahora;
+      int adc = analogRead(TABLA[i].pinA);
+      TRAZA_ANALOGICA(TABLA[i].pinA, adc);
+      long cm = telemetroIrACm(adc);
+      barridoRegistrar(e.angulo, cm, cm < 400);
+    }
+  }
+}
+
+uint8_t telemetrosCantidad() {
+  return CANTIDAD;
+}
+
+const Telemetro &telemetro(uint8_t i) {
+  return TABLA[i];
+}
+
+int telemetrosAnguloCanal(uint8_t canal) {
+  for (uint8_t i = 0; i < CANTIDAD; i++) {
+    if (estados[i].canal == canal) return estados[i].angulo;
+  }
+  return TELEMETRO_EN_SERVO;
+}
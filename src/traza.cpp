@@ -0,0 +1,148 @@
+#include "traza.h"
+
+#if TRAZA
+
+#include "parametros.h"
+
+static volatile EventoTraza cola[TRAZA_COLA];
+static volatile uint8_t cabeza = 0;     // Próximo a codificar
+static volatile uint8_t cantidad = 0;
+static volatile uint16_t perdidos = 0;  // Sin anotar aún en una trama
+static uint32_t anteriorUs = 0;         // Instante del último evento codificado
+static uint8_t secuencia = 0;
+static uint8_t trama[TRAZA_TRAMA_MAX];
+static uint8_t longitud = 0;            // Trama pendiente de enviar (0 = ninguna)
+
+// Con las interrupciones deshabilitadas
+static void apuntar(uint8_t tipo, uint8_t canal, uint32_t dato, unsigned long us) {
+  if (cantidad == TRAZA_COLA) {
+    perdidos++;
+    return;
+  }
+  volatile EventoTraza &e = cola[(cabeza + cantidad) % TRAZA_COLA];
+  e.us = us;
+  e.tipo = tipo;
+  e.canal = canal;
+  e.dato = dato;
+  cantidad++;
+}
+
+static void apuntarAtomico(uint8_t tipo, uint8_t canal, uint32_t dato) {
+  noInterrupts();
+  apuntar(tipo, canal, dato, micros());
+  interrupts();
+}
+
+static void volcar();
+
+void trazaIniciar() {
+  noInterrupts();
+  cabeza = 0;
+  cantidad = 0;
+  perdidos = 0;
+  anteriorUs = micros();
+  interrupts();
+  secuencia = 0;
+  longitud = 0;
+  // Los valores de arranque no caben en la cola: se escriben aquí mismo
+  for (uint8_t i = 0; i < PARAMETROS; i++) {
+    trazaParametro(i, parametros[i]);
+    if (cantidad == TRAZA_COLA) volcar();
+  }
+  volcar();
+}
+
+// En el AVR el flanco se entrega en el propio ISR; en el simulador la
+// física entrega los pulsos al final de su paso, con la marca interpolada
+void trazaPulso(uint8_t rueda, unsigned long marcaUs) {
+#if defined(__AVR__)
+  unsigned long entregaUs = marcaUs;
+#else
+  unsigned long entregaUs = micros();
+#endif
+  apuntar(TRAZA_PULSO_IZQ + rueda, 0, entregaUs - marcaUs, entregaUs);
+}
+
+void trazaEco(uint8_t canal, unsigned long anchoUs) {
+  apuntar(TRAZA_ECO, canal, anchoUs, micros());
+}
+
+void trazaAnalogica(uint8_t pin, int valor) {
+  apuntarAtomico(TRAZA_ANALOGICA, pin, (uint32_t)valor);
+}
+
+void trazaEstado(uint8_t estado) {
+  apuntarAtomico(TRAZA_ESTADO, 0, estado);
+}
+
+void trazaParametro(uint8_t id, int16_t valor) {
+  apuntarAtomico(TRAZA_PARAMETRO, id, (uint16_t)valor);
+}
+
+// Un ISR puede apuntar un instante posterior al de lo que loop() apunta
+// justo después (el ISR ve su propia entrada): el delta no baja de 0
+static void anadir(uint8_t &n, const EventoTraza &e) {
+  uint32_t deltaUs = (int32_t)(e.us - anteriorUs) > 0 ? e.us - anteriorUs : 0;
+  n += trazaCodificar(trama + n, deltaUs, e);
+  anteriorUs += deltaUs;
+}
+
+// Llena la trama con lo que haya en la cola; false si no hay nada
+static bool armar() {
+  uint8_t n = TRAZA_CABECERA;
+  uint32_t base = anteriorUs;
+  for (uint8_t i = 0; i < 4; i++) trama[n++] = (uint8_t)(base >> (8 * i));
+
+  noInterrupts();
+  uint16_t tirados = perdidos;
+  perdidos = 0;
+  interrupts();
+  if (tirados > 0) {
+    EventoTraza e = {anteriorUs, TRAZA_PERDIDOS, 0, tirados};
+    anadir(n, e);
+  }
+
+  while (n + TRAZA_EVENTO_MAX <= TRAZA_CABECERA + TRAZA_CARGA_MAX) {
+    noInterrupts();
+    if (cantidad == 0) {
+      interrupts();
+      break;
+    }
+    const volatile EventoTraza &c = cola[cabeza];
+    EventoTraza e = {c.us, c.tipo, c.canal, c.dato};
+    cabeza = (cabeza + 1) % TRAZA_COLA;
+    cantidad--;
+    interrupts();
+    anadir(n, e);
+  }
+  if (n == TRAZA_CABECERA + 4) return false;
+
+  trama[0] = TRAZA_SINC_0;
+  trama[1] = TRAZA_SINC_1;
+  trama[2] = TRAZA_VERSION;
+  trama[3] = secuencia++;
+  trama[4] = n - TRAZA_CABECERA;
+  uint16_t crc = crc16Ccitt(trama, n);
+  trama[n++] = (uint8_t)crc;
+  trama[n++] = (uint8_t)(crc >> 8);
+  longitud = n;
+  return true;
+}
+
+// Escribe lo encolado esperando a la UART (solo desde setup())
+static void volcar() {
+  while (armar()) {
+    Serial.write(trama, longitud);
+    longitud = 0;
+  }
+}
+
+void trazaEnviar() {
+  while (longitud > 0 || armar()) {
+    if (Serial.availableForWrite() < longitud) return;
+    Serial.write(trama, longitud);
+    longitud = 0;
+  }
+}
+
+#endif
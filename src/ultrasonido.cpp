@@ -0,0 +1,241 @@
+#include "ultrasonido.h"
+#include "traza.h"
+#include "emergencia.h"
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#endif
+
+enum EstadoUltrasonido {
+  US_REPOSO,         // Esperando a que toque el siguiente disparo
+  US_ESPERA_SUBIDA,  // Disparado, esperando flanco de subida del eco
+  US_ESPERA_BAJADA   // Eco en curso, esperando flanco de bajada
+};
+
+struct CanalUltrasonido {
+  uint8_t pinTrig;
+  bool aplazado;
+  unsigned long disparoUs;  // Último disparo de este canal
+  unsigned long noAntesUs;  // Con aplazado
+#if defined(__AVR__)
+  volatile uint8_t *registroEco;
+  uint8_t mascaraEco;
+#endif
+};
+
+static CanalUltrasonido canales[ULTRASONIDO_CANALES];
+static uint8_t numCanales = 0;
+static uint8_t turno = 0;         // Canal que dispara a continuación
+static uint8_t proximoFijo = 1;   // Siguiente canal distinto del 0 en la ronda
+static volatile uint8_t activo = 0;  // Canal del último disparo
+static volatile uint8_t estado = US_REPOSO;
+static volatile unsigned long tDisparo = 0;
+static volatile unsigned long tDisparoMs = 0;
+static volatile unsigned long tSubida = 0;
+static volatile LecturaUltrasonido ultimas[ULTRASONIDO_CANALES];
+
+#if defined(__AVR__)
+// Solo hay un disparo en vuelo: basta con leer el Echo de ese canal, y un
+// cambio en el pin de otro (que no está disparado) no altera el nivel leído.
+static void flancoIsr() {
+  const CanalUltrasonido &c = canales[activo];
+  ultrasonidoFlancoEco((*c.registroEco & c.mascaraEco) != 0, micros());
+}
+
+ISR(PCINT0_vect) {
+  flancoIsr();
+}
+
+ISR(PCINT2_vect) {
+  flancoIsr();
+}
+#else
+unsigned long (*ultrasonidoMockEco)(uint8_t canal) = nullptr;
+static unsigned long mockAncho = 0;
+#endif
+
+// Llamar con interrupciones deshabilitadas o desde el ISR
+static void publicar(unsigned long anchoUs) {
+  volatile LecturaUltrasonido &ultima = ultimas[activo];
+  ultima.anchoUs = anchoUs;
+  ultima.disparoMs = tDisparoMs;
+  ultima.tiempoMs = millis();
+  ultima.secuencia = ultima.secuencia + 1;
+  estado = US_REPOSO;
+  TRAZA_ECO(activo, anchoUs);
+}
+
+static void disparar(uint8_t canal, unsigned long ahoraUs) {
+  uint8_t pin = canales[canal].pinTrig;
+  digitalWrite(pin, LOW);
+  delayMicroseconds(2);
+  digitalWrite(pin, HIGH);
+  delayMicroseconds(10);
+  digitalWrite(pin, LOW);
+
+  noInterrupts();
+  activo = canal;
+  tDisparo = ahoraUs;
+  tDisparoMs = millis();
+  estado = US_ESPERA_SUBIDA;
+  interrupts();
+  canales[canal].disparoUs = ahoraUs;
+
+  // Ronda: 0, fijo 1, 0, fijo 2, ... (un fijo adelantado cuenta como su turno)
+  if (numCanales > 1) {
+    if (canal == 0) {
+      turno = proximoFijo;
+    } else {
+      turno = 0;
+      proximoFijo = canal + 1 < numCanales ? canal + 1 : 1;
+    }
+  }
+
+#ifndef __AVR__
+  mockAncho = ultrasonidoMockEco ? ultrasonidoMockEco(canal) : 0;
+#endif
+}
+
+static void configurarCanal(uint8_t canal, uint8_t pinTrigger, uint8_t pinEco) {
+  CanalUltrasonido &c = canales[canal];
+  c.pinTrig = pinTrigger;
+  c.aplazado = false;
+  c.disparoUs = micros() - ULTRASONIDO_PERIODO_US;  // Primer disparo inmediato
+  pinMode(pinTrigger, OUTPUT);
+  pinMode(pinEco, INPUT);
+  digitalWrite(pinTrigger, LOW);
+
+  noInterrupts();
+  ultimas[canal].anchoUs = 0;
+  ultimas[canal].disparoMs = 0;
+  ultimas[canal].tiempoMs = 0;
+  ultimas[canal].secuencia = 0;
+  interrupts();
+
+#if defined(__AVR__)
+  c.registroEco = portInputRegister(digitalPinToPort(pinEco));
+  c.mascaraEco = digitalPinToBitMask(pinEco);
+  *digitalPinToPCMSK(pinEco) |= _BV(digitalPinToPCMSKbit(pinEco));
+  *digitalPinToPCICR(pinEco) |= _BV(digitalPinToPCICRbit(pinEco));
+#endif
+}
+
+void ultrasonidoIniciar(uint8_t pinTrigger, uint8_t pinEco) {
+  noInterrupts();
+  estado = US_REPOSO;
+  activo = 0;
+  tDisparo = micros() - ULTRASONIDO_PERIODO_US;
+  interrupts();
+  numCanales = 1;
+  turno = 0;
+  proximoFijo = 1;
+  configurarCanal(0, pinTrigger, pinEco);
+}
+
+int8_t ultrasonidoAgregar(uint8_t pinTrigger, uint8_t pinEco) {
+  if (numCanales >= ULTRASONIDO_CANALES) return -1;
+  configurarCanal(numCanales, pinTrigger, pinEco);
+  return numCanales++;
+}
+
+uint8_t ultrasonidoCanales() {
+  return numCanales;
+}
+
+void ultrasonidoAplazar(uint8_t canal, unsigned long desdeUs) {
+  canales[canal].aplazado = true;
+  canales[canal].noAntesUs = desdeUs;
+}
+
+// Microsegundos que le quedan al aplazamiento del canal (0 = puede disparar)
+static unsigned long aplazamientoUs(uint8_t canal, unsigned long ahoraUs) {
+  CanalUltrasonido &c = canales[canal];
+  if (!c.aplazado) return 0;
+  long falta = (long)(c.noAntesUs - ahoraUs);
+  if (falta > 0) return (unsigned long)falta;
+  c.aplazado = false;
+  return 0;
+}
+
+void ultrasonidoFlancoEco(bool nivel, unsigned long us) {
+  if (nivel) {
+    if (estado == US_ESPERA_SUBIDA) {
+      tSubida = us;
+      estado = US_ESPERA_BAJADA;
+    }
+  } else if (estado == US_ESPERA_BAJADA) {
+    // La parada de emergencia va antes que publicar: es la ruta con plazo
+    emergenciaEco(activo, us - tSubida, tDisparoMs, us);
+    publicar(us - tSubida);
+  }
+}
+
+#ifndef __AVR__
+bool ultrasonidoMockProximoFlanco(unsigned long *us) {
+  if (mockAncho == 0) return false;
+  if (estado == US_ESPERA_SUBIDA) {
+    *us = tDisparo + ULTRASONIDO_MOCK_RETARDO_US;
+    return true;
+  }
+  if (estado == US_ESPERA_BAJADA && tSubida + mockAncho - tDisparo <= ULTRASONIDO_TIMEOUT_US) {
+    *us = tSubida + mockAncho;
+    return true;
+  }
+  return false;
+}
+
+// Sintetiza los flancos del eco simulado en su instante exacto
+void ultrasonidoMockFlancos(unsigned long ahoraUs) {
+  unsigned long us;
+  while (ultrasonidoMockProximoFlanco(&us) && (long)(ahoraUs - us) >= 0) {
+    ultrasonidoFlancoEco(estado == US_ESPERA_SUBIDA, us);
+  }
+}
+#endif
+
+void ultrasonidoPaso(unsigned long ahoraUs) {
+#ifndef __AVR__
+  ultrasonidoMockFlancos(ahoraUs);
+#endif
+
+  noInterrupts();
+  uint8_t e = estado;
+  unsigned long desdeDisparo = ahoraUs - tDisparo;
+  if (e != US_REPOSO && desdeDisparo > ULTRASONIDO_TIMEOUT_US) {
+    // Sin eco a tiempo: se publica como timeout y se ignora un flanco tardío
+    publicar(0);
+    e = US_REPOSO;
+  }
+  interrupts();
+
+  if (e != US_REPOSO || numCanales == 0 || desdeDisparo < ULTRASONIDO_SEPARACION_US) return;
+  uint8_t canal = turno;
+  unsigned long espera = aplazamientoUs(canal, ahoraUs);
+  // Un fijo solo se adelanta si su separación acaba antes que la espera
+  if (espera >= ULTRASONIDO_SEPARACION_US && canal == 0 && numCanales > 1) {
+    canal = proximoFijo;
+    espera = aplazamientoUs(canal, ahoraUs);
+  }
+  if (espera == 0 && ahoraUs - canales[canal].disparoUs >= ULTRASONIDO_PERIODO_US) {
+    disparar(canal, ahoraUs);
+  }
+}
+
+void ultrasonidoActualizar() {
+  ultrasonidoPaso(micros());
+}
+
+LecturaUltrasonido ultrasonidoUltima(uint8_t canal) {
+  LecturaUltrasonido copia;
+  noInterrupts();
+  copia.anchoUs = ultimas[canal].anchoUs;
+  copia.disparoMs = ultimas[canal].disparoMs;
+  copia.tiempoMs = ultimas[canal].tiempoMs;
+  copia.secuencia = ultimas[canal].secuencia;
+  interrupts();
+  return copia;
+}
+
+bool ultrasonidoOcupado() {
+  return estado != US_REPOSO;
+}
@@ -0,0 +1,99 @@
+// Consola de parámetros (consola.h): cada orden entra por Serial y su
+// respuesta se captura tal cual, una llamada a consolaActualizar() para
+// interpretarla y otra para escribirla.
+//
+//   pio test -e native -f test_consola
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "configuracion.h"
+#include "consola.h"
+#include "parametros.h"
+#include "sim/simulador.h"
+#include "sim/hal_nativo.h"
+
+static std::vector<uint8_t> salida;
+
+void setUp() {
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+  simIniciar(vacio, 1);
+  parametrosIniciar();
+  consolaIniciar();
+  salida.clear();
+  halCapturarSerie(&salida);
+}
+
+void tearDown() {
+  halCapturarSerie(nullptr);
+}
+
+// Manda la línea y devuelve la primera línea de respuesta
+static std::string orden(const char *linea) {
+  salida.clear();
+  halEntradaSerie(linea);
+  for (uint8_t i = 0; i < 4 && salida.empty(); i++) consolaActualizar();
+  return std::string(salida.begin(), salida.end());
+}
+
+void test_get_y_set() {
+  TEST_ASSERT_EQUAL_STRING("velocidad_maxima=160\n", orden("get velocidad_maxima\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("velocidad_maxima=200\n", orden("set velocidad_maxima 200\r\n").c_str());
+  TEST_ASSERT_EQUAL_INT16(200, parametros[PARAM_VELOCIDAD_MAXIMA]);
+  // Separadores repetidos
+  TEST_ASSERT_EQUAL_STRING("freno_pwm=0\n", orden("set   freno_pwm  0\n").c_str());
+}
+
+void test_valores_no_validos() {
+  TEST_ASSERT_EQUAL_STRING("error: velocidad_maxima [0..255]\n",
+                           orden("set velocidad_maxima 256\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("error: velocidad_maxima [0..255]\n",
+                           orden("set velocidad_maxima 12x\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("error: velocidad_maxima [0..255]\n",
+                           orden("set velocidad_maxima 70000\n").c_str());
+  TEST_ASSERT_EQUAL_INT16(VELOCIDAD_MAXIMA, parametros[PARAM_VELOCIDAD_MAXIMA]);
+
+  // En rango, pero por debajo de la mínima: se nombra la pareja
+  TEST_ASSERT_EQUAL_STRING("error: velocidad_minima > velocidad_maxima\n",
+                           orden("set velocidad_maxima 50\n").c_str());
+}
+
+void test_ordenes_no_validas() {
+  TEST_ASSERT_EQUAL_STRING("error: parámetro desconocido (list)\n", orden("get nada\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("error: usa list get set save cal perfil emerg\n", orden("get\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("error: usa list get set save cal perfil emerg\n",
+                           orden("set velocidad_maxima\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("error: usa list get set save cal perfil emerg\n", orden("borrar\n").c_str());
+
+  // Más larga que CONSOLA_LINEA: se rechaza entera y la siguiente vale
+  std::string larga = "set velocidad_maxima 200" + std::string(CONSOLA_LINEA, ' ') + "\n";
+  TEST_ASSERT_EQUAL_STRING("error: usa list get set save cal perfil emerg\n", orden(larga.c_str()).c_str());
+  TEST_ASSERT_EQUAL_INT16(VELOCIDAD_MAXIMA, parametros[PARAM_VELOCIDAD_MAXIMA]);
+  TEST_ASSERT_EQUAL_STRING("velocidad_maxima=160\n", orden("get velocidad_maxima\n").c_str());
+
+  // Una línea vacía no responde
+  salida.clear();
+  halEntradaSerie("\n");
+  consolaActualizar();
+  consolaActualizar();
+  TEST_ASSERT_TRUE(salida.empty());
+}
+
+void test_una_orden_por_llamada() {
+  salida.clear();
+  halEntradaSerie("set velocidad_maxima 200\nget velocidad_maxima\n");
+  consolaActualizar();  // Interpreta la primera
+  TEST_ASSERT_TRUE(salida.empty());
+  consolaActualizar();  // La escribe; la segunda sigue esperando
+  TEST_ASSERT_EQUAL_STRING("velocidad_maxima=200\n", std::string(salida.begin(), salida.end()).c_str());
+  TEST_ASSERT_EQUAL_STRING("velocidad_maxima=200\n", orden("").c_str());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_get_y_set);
+  RUN_TEST(test_valores_no_validos);
+  RUN_TEST(test_ordenes_no_validas);
+  RUN_TEST(test_una_orden_por_llamada);
+  return UNITY_END();
+}
@@ -0,0 +1,130 @@
+// Parada de emergencia (emergencia.h) desde el flanco del eco: el
+// simulador entrega cada flanco en su instante más la entrada al ISR, y
+// cobra las escrituras en el puente, así que la latencia no es 0 y se
+// puede acotar muy por debajo del paso de física (1 ms).
+//
+//   pio test -e native -f test_emergencia
+
+#include <unity.h>
+#include "configuracion.h"
+#include "ultrasonido.h"
+#include "emergencia.h"
+#include "puente_l298n.h"
+#include "parametros.h"
+#include "calibracion.h"
+#include "sim/simulador.h"
+#include "sim/hal_nativo.h"
+
+#define UMBRAL_CM 12
+
+static unsigned long anchoMock = 0;
+
+static unsigned long ecoMock(uint8_t) {
+  return anchoMock;
+}
+
+void setUp() {
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+  simIniciar(vacio, 1);
+  parametrosIniciar();
+  parametroFijar(PARAM_EMERGENCIA_CM, UMBRAL_CM);
+  puenteIniciar();
+  puenteDesbloquearAvance();
+  emergenciaIniciar();
+  ultrasonidoMockEco = ecoMock;
+  ultrasonidoIniciar(TRIGGER_PIN, ECHO_PIN);
+  emergenciaArmar(true);
+  emergenciaVigilar(0, true, 0);
+}
+
+void tearDown() {}
+
+// Dispara con un eco de anchoUs y deja pasar avanceUs de una vez, como un
+// loop() que no vuelve en todo ese tiempo
+static void medir(unsigned long anchoUs, unsigned long avanceUs) {
+  anchoMock = anchoUs;
+  ultrasonidoPaso(micros());
+  TEST_ASSERT_TRUE(ultrasonidoOcupado());
+  simAvanzarUs(avanceUs);
+}
+
+static void comprobarFrenado() {
+  TEST_ASSERT_TRUE(emergenciaPendiente());
+  TEST_ASSERT_TRUE(puenteAvanceBloqueado());
+  TEST_ASSERT_EQUAL(HIGH, halPin(MOTOR_IZQ_IN1));
+  TEST_ASSERT_EQUAL(HIGH, halPin(MOTOR_IZQ_IN2));
+  TEST_ASSERT_EQUAL(HIGH, halPin(MOTOR_DER_IN3));
+  TEST_ASSERT_EQUAL(HIGH, halPin(MOTOR_DER_IN4));
+  TEST_ASSERT_EQUAL(255, halPwm(MOTOR_IZQ_ENA));
+  TEST_ASSERT_EQUAL(255, halPwm(MOTOR_DER_ENB));
+}
+
+void test_eco_corto_frena_en_el_flanco() {
+  // Bajada a 450 + 600 us del disparo: entregada al final del paso de
+  // física llegaría 950 us tarde
+  medir(600, 5000);
+  comprobarFrenado();
+  TEST_ASSERT_EQUAL_UINT16(10, emergenciaDistanciaCm());
+  TEST_ASSERT_GREATER_THAN_UINT32(0, emergenciaLatenciaUs());  // Entrada y escrituras
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(EMERGENCIA_LATENCIA_MAX_US, emergenciaLatenciaUs());
+  TEST_ASSERT_EQUAL_UINT16(1, emergenciaParadas());
+}
+
+void test_frena_con_loop_atascado() {
+  medir(650, 50000);
+  comprobarFrenado();
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(EMERGENCIA_LATENCIA_MAX_US, emergenciaLatenciaMaxUs());
+
+  // Atendida, el puente vuelve a aceptar el avance
+  emergenciaAtender();
+  TEST_ASSERT_FALSE(emergenciaPendiente());
+  TEST_ASSERT_FALSE(puenteAvanceBloqueado());
+}
+
+void test_eco_lejano_no_frena() {
+  medir(1000, 5000);  // 17 cm
+  TEST_ASSERT_FALSE(emergenciaPendiente());
+  TEST_ASSERT_FALSE(puenteAvanceBloqueado());
+}
+
+void test_desarmada_no_frena() {
+  emergenciaArmar(false);
+  medir(600, 5000);
+  TEST_ASSERT_FALSE(emergenciaPendiente());
+  TEST_ASSERT_FALSE(puenteAvanceBloqueado());
+}
+
+void test_sensor_sin_vigilar_no_frena() {
+  // De lado, y al frente pero con el disparo antes de asentarse el servo
+  emergenciaVigilar(0, false, 0);
+  medir(600, 5000);
+  TEST_ASSERT_FALSE(emergenciaPendiente());
+
+  emergenciaVigilar(0, true, millis() + 1000);
+  simAvanzarUs(ULTRASONIDO_PERIODO_US);
+  medir(600, 5000);
+  TEST_ASSERT_FALSE(emergenciaPendiente());
+  TEST_ASSERT_FALSE(puenteAvanceBloqueado());
+}
+
+void test_calibrar_atiende_la_parada() {
+  medir(600, 5000);
+  comprobarFrenado();
+
+  // La ida de la calibración va en lazo abierto hacia delante: con el
+  // avance bloqueado el puente la dejaría frenada
+  TEST_ASSERT_TRUE(calibracionEmpezar());
+  TEST_ASSERT_FALSE(emergenciaPendiente());
+  TEST_ASSERT_FALSE(puenteAvanceBloqueado());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_eco_corto_frena_en_el_flanco);
+  RUN_TEST(test_frena_con_loop_atascado);
+  RUN_TEST(test_eco_lejano_no_frena);
+  RUN_TEST(test_desarmada_no_frena);
+  RUN_TEST(test_sensor_sin_vigilar_no_frena);
+  RUN_TEST(test_calibrar_atiende_la_parada);
+  return UNITY_END();
+}
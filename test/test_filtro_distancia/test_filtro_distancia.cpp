@@ -0,0 +1,141 @@
+// Filtro de distancia (filtro_distancia.h): el Kalman en coma fija frente
+// al mismo modelo en double, con la misma mediana de 3 y el mismo ruido,
+// en un acercamiento con ruido, un hueco sin eco y la vuelta del eco.
+//
+//   pio test -e native -f test_filtro_distancia
+
+#include <unity.h>
+#include <math.h>
+#include "filtro_distancia.h"
+
+// Los del filtro (filtro_distancia.cpp)
+#define ACEL_CM_S2 150.0
+#define RUIDO_MEDIDA_CM2 4.0
+#define P_RANGO_INICIAL_CM2 16.0
+#define P_VEL_INICIAL_CM2_S2 2500.0
+
+#define PERIODO_MS 60
+
+struct Referencia {
+  double rango, velocidad;
+  double p00, p01, p11;
+  int ventana[3];
+  int llenas, indice;
+};
+
+static void referenciaIniciar(Referencia &r, int z) {
+  r.rango = z;
+  r.velocidad = 0;
+  r.p00 = P_RANGO_INICIAL_CM2;
+  r.p01 = 0;
+  r.p11 = P_VEL_INICIAL_CM2_S2;
+}
+
+static void referenciaPredecir(Referencia &r, double dt) {
+  double q = ACEL_CM_S2 * ACEL_CM_S2;
+  r.rango += r.velocidad * dt;
+  r.p00 += dt * (2 * r.p01 + dt * r.p11) + q * pow(dt, 4) / 4;
+  r.p01 += dt * r.p11 + q * pow(dt, 3) / 2;
+  r.p11 += q * dt * dt;
+}
+
+static int referenciaMediana(const Referencia &r) {
+  const int *v = r.ventana;
+  if (r.llenas == 1) return v[(r.indice + 2) % 3];
+  if (r.llenas == 2) return fmin(v[(r.indice + 1) % 3], v[(r.indice + 2) % 3]);
+  return fmax(fmin(v[0], v[1]), fmin(fmax(v[0], v[1]), v[2]));
+}
+
+static void referenciaMedida(Referencia &r, int cm) {
+  r.ventana[r.indice] = cm;
+  r.indice = (r.indice + 1) % 3;
+  if (r.llenas < 3) r.llenas++;
+  double y = referenciaMediana(r) - r.rango;
+  double s = r.p00 + RUIDO_MEDIDA_CM2;
+  double k0 = r.p00 / s, k1 = r.p01 / s;
+  r.rango += k0 * y;
+  r.velocidad += k1 * y;
+  r.p11 -= r.p01 * r.p01 / s;
+  r.p01 *= RUIDO_MEDIDA_CM2 / s;
+  r.p00 *= RUIDO_MEDIDA_CM2 / s;
+}
+
+// Ancho del eco que ultrasonidoACm() devuelve como cm
+static unsigned long ancho(int cm) {
+  return (cm * 1000UL + 16) / 17;
+}
+
+// Ruido de +-2 cm, repetible
+static int ruido(int i) {
+  static const int8_t TABLA[] = {0, 2, -1, 1, -2, 0, 1, -1, 2, -2, 0, 1};
+  return TABLA[i % sizeof(TABLA)];
+}
+
+static FiltroDistancia filtro;
+static Referencia ref;
+
+void setUp() {
+  filtroDistanciaIniciar(filtro);
+  ref = Referencia();
+}
+
+void tearDown() {}
+
+static void comparar(unsigned long ms) {
+  EstimacionDistancia e = filtroDistanciaEstimar(filtro, ms);
+  TEST_ASSERT_TRUE(e.siguiendo);
+  TEST_ASSERT_INT_WITHIN(1, (long)lround(ref.rango), e.distanciaCm);
+  TEST_ASSERT_INT_WITHIN(2, (long)ref.velocidad, e.velocidadCmS);
+}
+
+// Objetivo a 200 cm que se acerca a 30 cm/s, una lectura cada PERIODO_MS
+static unsigned long acercar(unsigned long desdeMs, int muestras) {
+  unsigned long ms = desdeMs;
+  for (int i = 0; i < muestras; i++, ms += PERIODO_MS) {
+    int cm = (int)lround(200 - 30 * ms / 1000.0) + ruido(i);
+    filtroDistanciaMedida(filtro, ancho(cm), ms);
+    if (ms == 0) {
+      referenciaMedida(ref, cm);  // La primera solo llena la ventana
+      referenciaIniciar(ref, cm);
+    } else {
+      referenciaPredecir(ref, PERIODO_MS / 1000.0);
+      referenciaMedida(ref, cm);
+    }
+    comparar(ms);
+  }
+  return ms;
+}
+
+void test_acercamiento_como_en_double() {
+  acercar(0, 40);
+  TEST_ASSERT_INT_WITHIN(3, -30, filtroDistanciaEstimar(filtro, 40 * PERIODO_MS).velocidadCmS);
+}
+
+void test_hueco_sin_eco_y_vuelta() {
+  unsigned long ms = acercar(0, 30);
+
+  // 600 ms sin eco: sigue el objetivo por predicción, como la referencia
+  // (que predice en los mismos pasos: Q no es aditiva entre pasos)
+  for (int i = 0; i < 600 / PERIODO_MS; i++, ms += PERIODO_MS) {
+    filtroDistanciaMedida(filtro, 0, ms);
+    referenciaPredecir(ref, PERIODO_MS / 1000.0);
+  }
+  EstimacionDistancia e = filtroDistanciaEstimar(filtro, ms - PERIODO_MS);
+  TEST_ASSERT_TRUE(e.siguiendo);
+  TEST_ASSERT_FALSE(e.eco);
+  TEST_ASSERT_INT_WITHIN(1, (long)lround(ref.rango), e.distanciaCm);
+
+  // Vuelve el eco: la covarianza crecida en el hueco da la misma ganancia
+  int cm = (int)lround(200 - 30 * ms / 1000.0);
+  filtroDistanciaMedida(filtro, ancho(cm), ms);
+  referenciaPredecir(ref, PERIODO_MS / 1000.0);
+  referenciaMedida(ref, cm);
+  comparar(ms);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_acercamiento_como_en_double);
+  RUN_TEST(test_hueco_sin_eco_y_vuelta);
+  return UNITY_END();
+}
@@ -0,0 +1,104 @@
+// Gobernador de velocidad (gobernador.h) con el robot parado: el límite
+// por TTC frente al hueco, lo que resta un obstáculo que se acerca, los
+// topes de los parámetros y las rampas de gobernadorPaso().
+//
+//   pio test -e native -f test_gobernador
+
+#include <unity.h>
+#include "configuracion.h"
+#include "gobernador.h"
+#include "encoders.h"
+#include "frenada.h"
+#include "motores.h"
+#include "parametros.h"
+#include "sim/simulador.h"
+
+void setUp() {
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+  simIniciar(vacio, 1);
+  parametrosIniciar();
+  encodersIniciar();
+  frenadaIniciar();
+  gobernadorIniciar();
+}
+
+void tearDown() {}
+
+static EstimacionDistancia frente(long cm, int velocidadCmS = 0) {
+  EstimacionDistancia e = {};
+  e.distanciaCm = cm;
+  e.velocidadCmS = velocidadCmS;
+  e.eco = cm < FILTRO_SIN_ECO_CM;
+  e.siguiendo = e.eco;
+  return e;
+}
+
+static long pwmACmS(int pwm) {
+  return (long)pwm * MM_S_POR_PWM_Q8 / 256 / 10;
+}
+
+void test_topes() {
+  TEST_ASSERT_EQUAL_INT(VELOCIDAD_MINIMA, gobernadorLimite(frente(DISTANCIA_CRITICA)));
+  TEST_ASSERT_EQUAL_INT(VELOCIDAD_MINIMA, gobernadorLimite(frente(DISTANCIA_CRITICA - 5)));
+  TEST_ASSERT_EQUAL_INT(VELOCIDAD_MAXIMA, gobernadorLimite(frente(FILTRO_SIN_ECO_CM)));
+
+  // Los topes son los de la consola
+  parametroFijar(PARAM_VELOCIDAD_MAXIMA, 200);
+  TEST_ASSERT_EQUAL_INT(200, gobernadorLimite(frente(FILTRO_SIN_ECO_CM)));
+}
+
+void test_limite_por_ttc() {
+  int anterior = 0;
+  for (long cm = DISTANCIA_CRITICA + 5; cm <= 150; cm += 5) {
+    int limite = gobernadorLimite(frente(cm));
+    TEST_ASSERT_GREATER_OR_EQUAL(anterior, limite);  // Más hueco, nunca más lento
+    anterior = limite;
+    if (limite == VELOCIDAD_MINIMA || limite == VELOCIDAD_MAXIMA) continue;
+    // Entre los topes, llega a DISTANCIA_CRITICA en TTC_MINIMO_MS o más
+    long ttcCmS = (cm - DISTANCIA_CRITICA) * 1000L / TTC_MINIMO_MS;
+    TEST_ASSERT_LESS_OR_EQUAL(ttcCmS, pwmACmS(limite));
+    TEST_ASSERT_GREATER_OR_EQUAL(ttcCmS - 2, pwmACmS(limite));
+  }
+}
+
+void test_obstaculo_que_se_acerca() {
+  // A 40 cm el robot quieto puede ir a 41 cm/s; si el obstáculo viene a
+  // 20 cm/s, su parte se descuenta (con el tope alto para que no mande)
+  parametroFijar(PARAM_VELOCIDAD_MAXIMA, 255);
+  int quieto = gobernadorLimite(frente(40));
+  int acercandose = gobernadorLimite(frente(40, -20));
+  TEST_ASSERT_LESS_THAN(255, quieto);
+  TEST_ASSERT_INT_WITHIN(2, pwmACmS(quieto) - 20, pwmACmS(acercandose));
+  TEST_ASSERT_EQUAL_INT(20, gobernadorCierreCmS(frente(40, -20)));
+
+  // Uno que se aleja no da permiso para ir más deprisa
+  TEST_ASSERT_EQUAL_INT(quieto, gobernadorLimite(frente(40, 30)));
+}
+
+void test_rampas() {
+  EstimacionDistancia libre = frente(FILTRO_SIN_ECO_CM);
+  int v = VELOCIDAD_MINIMA;
+  while (v < VELOCIDAD_MAXIMA) {
+    simAvanzarUs(50000UL);
+    int siguiente = gobernadorPaso(libre);
+    TEST_ASSERT_EQUAL_INT(min(v + GOBERNADOR_ACEL_PWM_S * 50 / 1000, VELOCIDAD_MAXIMA), siguiente);
+    v = siguiente;
+  }
+
+  // Frena más deprisa de lo que acelera y no baja del límite
+  EstimacionDistancia cerca = frente(DISTANCIA_CRITICA + 10);
+  int limite = gobernadorLimite(cerca);
+  simAvanzarUs(20000UL);
+  TEST_ASSERT_EQUAL_INT(max(v - GOBERNADOR_DECEL_PWM_S * 20 / 1000, limite), gobernadorPaso(cerca));
+  simAvanzarUs(50000UL);
+  TEST_ASSERT_EQUAL_INT(limite, gobernadorPaso(cerca));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_topes);
+  RUN_TEST(test_limite_por_ttc);
+  RUN_TEST(test_obstaculo_que_se_acerca);
+  RUN_TEST(test_rampas);
+  return UNITY_END();
+}
@@ -0,0 +1,118 @@
+// Parámetros (parametros.h): rango, parejas entre valores y la imagen de
+// EEPROM, que se rechaza entera si algo de eso no se cumple.
+//
+//   pio test -e native -f test_parametros
+
+#include <unity.h>
+#include <EEPROM.h>
+#include "configuracion.h"
+#include "parametros.h"
+#include "trama_telemetria.h"
+#include "sim/simulador.h"
+
+// Imagen: versión, cantidad, valores (int16) y CRC-16 de lo anterior
+#define IMAGEN_VALORES 2
+#define IMAGEN_CRC (IMAGEN_VALORES + 2 * PARAMETROS)
+
+void setUp() {
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+  simIniciar(vacio, 1);  // EEPROM borrada
+  parametrosIniciar();
+}
+
+void tearDown() {}
+
+static void guardar() {
+  parametrosGuardar();
+  while (!parametrosActualizar()) {
+  }
+}
+
+// Cambia un valor en la imagen guardada y le pone un CRC correcto
+static void escribirImagen(uint8_t id, int16_t valor) {
+  EEPROM.put(PARAMETROS_DIRECCION + IMAGEN_VALORES + 2 * id, valor);
+  uint8_t bytes[IMAGEN_CRC];
+  for (uint8_t i = 0; i < IMAGEN_CRC; i++) bytes[i] = EEPROM.read(PARAMETROS_DIRECCION + i);
+  EEPROM.put(PARAMETROS_DIRECCION + IMAGEN_CRC, crc16Ccitt(bytes, IMAGEN_CRC));
+}
+
+void test_fuera_de_rango_no_cambia() {
+  TEST_ASSERT_FALSE(parametroFijar(PARAM_VELOCIDAD_MAXIMA, 256));
+  TEST_ASSERT_FALSE(parametroFijar(PARAM_DISTANCIA_CRITICA, 4));
+  TEST_ASSERT_FALSE(parametroFijar(PARAMETROS, 0));
+  TEST_ASSERT_EQUAL_INT16(VELOCIDAD_MAXIMA, parametros[PARAM_VELOCIDAD_MAXIMA]);
+  TEST_ASSERT_EQUAL_INT16(DISTANCIA_CRITICA, parametros[PARAM_DISTANCIA_CRITICA]);
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_VELOCIDAD_MAXIMA, 255));
+}
+
+void test_minima_no_pasa_de_maxima() {
+  TEST_ASSERT_FALSE(parametroFijar(PARAM_VELOCIDAD_MINIMA, VELOCIDAD_MAXIMA + 1));
+  TEST_ASSERT_FALSE(parametroFijar(PARAM_VELOCIDAD_MAXIMA, VELOCIDAD_MINIMA - 1));
+  TEST_ASSERT_EQUAL_INT16(VELOCIDAD_MINIMA, parametros[PARAM_VELOCIDAD_MINIMA]);
+  TEST_ASSERT_EQUAL(0, parametrosParejaIncumplida(parametros, PARAM_VELOCIDAD_MINIMA, 255));
+
+  // Iguales valen; subiendo antes la máxima, la mínima también
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_VELOCIDAD_MINIMA, VELOCIDAD_MAXIMA));
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_VELOCIDAD_MAXIMA, 220));
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_VELOCIDAD_MINIMA, 200));
+}
+
+void test_emergencia_bajo_distancia_critica() {
+  TEST_ASSERT_FALSE(parametroFijar(PARAM_EMERGENCIA_CM, DISTANCIA_CRITICA));
+  TEST_ASSERT_FALSE(parametroFijar(PARAM_DISTANCIA_CRITICA, EMERGENCIA_CM));
+  TEST_ASSERT_EQUAL(1, parametrosParejaIncumplida(parametros, PARAM_EMERGENCIA_CM, 40));
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_EMERGENCIA_CM, DISTANCIA_CRITICA - 1));
+
+  // Desactivada (0) vale con cualquier distancia crítica
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_EMERGENCIA_CM, 0));
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_DISTANCIA_CRITICA, 5));
+  TEST_ASSERT_EQUAL(-1, parametrosParejaIncumplida(parametros, 0, parametros[0]));
+}
+
+void test_guardados_se_cargan() {
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_VELOCIDAD_MAXIMA, 200));
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_EMERGENCIA_CM, 10));
+  guardar();
+  parametroFijar(PARAM_VELOCIDAD_MAXIMA, 150);
+  TEST_ASSERT_TRUE(parametrosIniciar());
+  TEST_ASSERT_EQUAL_INT16(200, parametros[PARAM_VELOCIDAD_MAXIMA]);
+  TEST_ASSERT_EQUAL_INT16(10, parametros[PARAM_EMERGENCIA_CM]);
+}
+
+void test_imagen_incoherente_se_rechaza() {
+  guardar();
+  escribirImagen(PARAM_VELOCIDAD_MINIMA, VELOCIDAD_MAXIMA + 10);
+  TEST_ASSERT_FALSE(parametrosIniciar());
+  TEST_ASSERT_EQUAL_INT16(VELOCIDAD_MINIMA, parametros[PARAM_VELOCIDAD_MINIMA]);
+
+  guardar();
+  escribirImagen(PARAM_EMERGENCIA_CM, DISTANCIA_CRITICA);
+  TEST_ASSERT_FALSE(parametrosIniciar());
+  TEST_ASSERT_EQUAL_INT16(EMERGENCIA_CM, parametros[PARAM_EMERGENCIA_CM]);
+
+  // La misma escritura con un valor coherente sí se carga
+  guardar();
+  escribirImagen(PARAM_EMERGENCIA_CM, DISTANCIA_CRITICA - 1);
+  TEST_ASSERT_TRUE(parametrosIniciar());
+  TEST_ASSERT_EQUAL_INT16(DISTANCIA_CRITICA - 1, parametros[PARAM_EMERGENCIA_CM]);
+}
+
+void test_otra_version_se_rechaza() {
+  TEST_ASSERT_TRUE(parametroFijar(PARAM_VELOCIDAD_MAXIMA, 200));
+  guardar();
+  EEPROM.write(PARAMETROS_DIRECCION, PARAMETROS_VERSION - 1);
+  escribirImagen(PARAM_VELOCIDAD_MAXIMA, 200);  // CRC correcto
+  TEST_ASSERT_FALSE(parametrosIniciar());
+  TEST_ASSERT_EQUAL_INT16(VELOCIDAD_MAXIMA, parametros[PARAM_VELOCIDAD_MAXIMA]);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fuera_de_rango_no_cambia);
+  RUN_TEST(test_minima_no_pasa_de_maxima);
+  RUN_TEST(test_emergencia_bajo_distancia_critica);
+  RUN_TEST(test_guardados_se_cargan);
+  RUN_TEST(test_imagen_incoherente_se_rechaza);
+  RUN_TEST(test_otra_version_se_rechaza);
+  return UNITY_END();
+}
@@ -0,0 +1,121 @@
+// Recuperación (recuperacion.h): la escalera de estrategias con eventos en
+// el mismo sitio y, en misiones del simulador, las dos detecciones que el
+// corpus no dispara: el sensor tapado (REC_ATASCO) y el avance con ecos
+// intermitentes de algo que apenas se acerca (REC_TIEMPO).
+//
+//   pio test -e native -f test_recuperacion
+
+#include <unity.h>
+#include <math.h>
+#include "configuracion.h"
+#include "ultrasonido.h"
+#include "navegacion.h"
+#include "recuperacion.h"
+#include "parametros.h"
+#include "sim/simulador.h"
+#include "sim/mision.h"
+
+void setup();
+void loop();
+
+#define DESDE_S 5.0  // Las misiones se estropean a partir de aquí
+
+static unsigned long (*ecoSimulado)(uint8_t canal) = nullptr;
+static bool tapado = false;
+
+// Solo el sensor del servo (canal 0). Tapado: un eco a 3 cm. Si no, la
+// mitad de cada 0,6 s un objetivo que se acerca a 1,5 cm/s y la otra mitad
+// lo que haya (en el mapa vacío, nada)
+static unsigned long ecoEstropeado(uint8_t canal) {
+  unsigned long real = ecoSimulado(canal);
+  double t = simEstado().tiempoS - DESDE_S;
+  if (canal != 0 || t < 0) return real;
+  if (tapado) return 3 * 58;
+  if (fmod(t, 0.6) >= 0.3) return real;
+  return (unsigned long)((200 - 1.5 * t) * 58);
+}
+
+static void mision(const Mapa &mapa, double segundos, int16_t ventanaMs = 0) {
+  simIniciar(mapa, 1);
+  setup();
+  if (ventanaMs > 0) parametros[PARAM_ATASCO_VENTANA_MS] = ventanaMs;
+  ecoSimulado = ultrasonidoMockEco;
+  ultrasonidoMockEco = ecoEstropeado;
+  while (simEstado().tiempoS < segundos) {
+    loop();
+    simAvanzarUs(PASO_BUCLE_US);
+  }
+}
+
+static PoseOdometria pose(float xMm, float yMm) {
+  PoseOdometria p = {};
+  p.xMm = xMm;
+  p.yMm = yMm;
+  return p;
+}
+
+void setUp() {
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+  simIniciar(vacio, 1);
+  parametrosIniciar();
+  recuperacionIniciar();
+}
+
+void tearDown() {}
+
+void test_escalera_en_el_mismo_sitio() {
+  const uint8_t esperadas[] = {ESTRATEGIA_NORMAL, ESTRATEGIA_NORMAL, ESTRATEGIA_RETROCESO_LARGO,
+                               ESTRATEGIA_MEDIA_VUELTA, ESTRATEGIA_SALIR_PARED,
+                               ESTRATEGIA_NORMAL};  // Tras salir, la escalera empieza de nuevo
+  for (uint8_t i = 0; i < sizeof(esperadas); i++) {
+    PlanRecuperacion plan = recuperacionEvento(i % 2 ? EVENTO_ATASCO : EVENTO_TIEMPO, pose(0, 0));
+    TEST_ASSERT_EQUAL_UINT8(esperadas[i], plan.estrategia);
+    simAvanzarUs(1000000UL);
+  }
+  TEST_ASSERT_EQUAL_UINT16(1, recuperacionEstrategias(ESTRATEGIA_SALIR_PARED));
+}
+
+void test_lejos_o_viejos_no_escalan() {
+  // Paradas a 1 m una de otra
+  for (uint8_t i = 0; i < 4; i++) {
+    PlanRecuperacion plan = recuperacionEvento(EVENTO_OBSTACULO, pose(i * 1000.0f, 0));
+    TEST_ASSERT_EQUAL_UINT8(ESTRATEGIA_NORMAL, plan.estrategia);
+    simAvanzarUs(1000000UL);
+  }
+  // En el mismo sitio, pero fuera de la ventana
+  for (uint8_t i = 0; i < 3; i++) {
+    simAvanzarUs((RECUPERACION_VENTANA_MS + 1000) * 1000UL);
+    PlanRecuperacion plan = recuperacionEvento(EVENTO_OBSTACULO, pose(0, 0));
+    TEST_ASSERT_EQUAL_UINT8(ESTRATEGIA_NORMAL, plan.estrategia);
+  }
+}
+
+void test_sensor_tapado_salta_atasco() {
+  Mapa sala;
+  TEST_ASSERT_TRUE(simMapaPorNombre("sala", 1, sala));
+  tapado = true;
+  mision(sala, 30);
+  TEST_ASSERT_GREATER_THAN_UINT32(3, navegacionRecuperaciones(REC_ATASCO));
+  // Siempre en el mismo sitio para la política: la escalera llega arriba
+  TEST_ASSERT_GREATER_THAN_UINT32(0, recuperacionEstrategias(ESTRATEGIA_MEDIA_VUELTA));
+  TEST_ASSERT_GREATER_THAN_UINT32(0, recuperacionEstrategias(ESTRATEGIA_SALIR_PARED));
+}
+
+void test_eco_intermitente_salta_tiempo() {
+  // Con la ventana por defecto (10 s) el avance recto llega al borde de la
+  // rejilla (3 m) y el robot gira antes de cerrarla
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+  tapado = false;
+  mision(vacio, 15, 6000);
+  TEST_ASSERT_EQUAL_UINT16(1, navegacionRecuperaciones(REC_TIEMPO));
+  TEST_ASSERT_EQUAL_UINT16(0, navegacionRecuperaciones(REC_BLOQUEO_FISICO));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_escalera_en_el_mismo_sitio);
+  RUN_TEST(test_lejos_o_viejos_no_escalan);
+  RUN_TEST(test_sensor_tapado_salta_atasco);
+  RUN_TEST(test_eco_intermitente_salta_tiempo);
+  return UNITY_END();
+}
@@ -0,0 +1,102 @@
+// Telemetría binaria (telemetria.h, trama_telemetria.h): el CRC frente al
+// vector de referencia de CRC-16/CCITT-FALSE y las tramas tal como salen
+// por Serial, con la cola que tira la más vieja.
+//
+//   pio test -e native -f test_telemetria
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "telemetria.h"
+#include "sim/simulador.h"
+#include "sim/hal_nativo.h"
+
+static std::vector<uint8_t> salida;
+
+void setUp() {
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+  simIniciar(vacio, 1);
+  salida.clear();
+  halCapturarSerie(&salida);
+  telemetriaIniciar();
+}
+
+void tearDown() {
+  halCapturarSerie(nullptr);
+}
+
+static TramaTelemetria trama(uint32_t tiempoMs) {
+  TramaTelemetria t;
+  memset(&t, 0, sizeof(t));
+  t.tiempoMs = tiempoMs;
+  t.distanciaCm = -1;
+  t.rumboCentigrados = 9000;
+  t.bateriaMv = 7400;
+  return t;
+}
+
+void test_crc_vector_de_referencia() {
+  const uint8_t digitos[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16Ccitt(digitos, sizeof(digitos)));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, crc16Ccitt(digitos, 0));
+}
+
+void test_trama_en_serial() {
+  TramaTelemetria t = trama(123456);
+  telemetriaPublicar(t);
+  telemetriaEnviar();
+  TEST_ASSERT_EQUAL(sizeof(TramaTelemetria), salida.size());
+
+  // Little-endian y empaquetada: los campos caen donde los lee telemetria_csv
+  const uint8_t *b = salida.data();
+  TEST_ASSERT_EQUAL_HEX8(TRAMA_SINC_0, b[0]);
+  TEST_ASSERT_EQUAL_HEX8(TRAMA_SINC_1, b[1]);
+  TEST_ASSERT_EQUAL_UINT8(TRAMA_VERSION, b[2]);
+  TEST_ASSERT_EQUAL_UINT8(0, b[3]);
+  TEST_ASSERT_EQUAL_HEX8(0x40, b[4]);  // 123456 = 0x0001E240
+  TEST_ASSERT_EQUAL_HEX8(0xE2, b[5]);
+  TEST_ASSERT_EQUAL_HEX8(0x01, b[6]);
+  TEST_ASSERT_EQUAL_HEX8(0x00, b[7]);
+  TEST_ASSERT_EQUAL_HEX8(0xFF, b[8]);  // distanciaCm = -1
+  TEST_ASSERT_EQUAL_HEX8(0xFF, b[9]);
+
+  size_t n = offsetof(TramaTelemetria, crc);
+  uint16_t crc = crc16Ccitt(b, n);
+  TEST_ASSERT_EQUAL_HEX8(crc & 0xFF, b[n]);
+  TEST_ASSERT_EQUAL_HEX8(crc >> 8, b[n + 1]);
+
+  // Un bit cambiado ya no pasa el CRC
+  salida[12] ^= 0x01;
+  TEST_ASSERT_NOT_EQUAL(crc, crc16Ccitt(salida.data(), n));
+}
+
+void test_cola_llena_tira_la_mas_vieja() {
+  for (uint32_t i = 0; i < TELEMETRIA_COLA + 2; i++) {
+    TramaTelemetria t = trama(i);
+    telemetriaPublicar(t);
+  }
+  TEST_ASSERT_EQUAL_UINT16(2, telemetriaDescartadas());
+
+  telemetriaEnviar();
+  TEST_ASSERT_EQUAL(TELEMETRIA_COLA * sizeof(TramaTelemetria), salida.size());
+  // Quedan las últimas, en orden y con huecos en la secuencia
+  for (uint8_t i = 0; i < TELEMETRIA_COLA; i++) {
+    TramaTelemetria t;
+    memcpy(&t, salida.data() + i * sizeof(t), sizeof(t));
+    TEST_ASSERT_EQUAL_UINT8(i + 2, t.secuencia);
+    TEST_ASSERT_EQUAL_UINT32(i + 2, t.tiempoMs);
+    TEST_ASSERT_EQUAL_HEX16(crc16Ccitt((const uint8_t *)&t, offsetof(TramaTelemetria, crc)), t.crc);
+  }
+  // La descartada cuenta en las tramas que se publican después
+  TramaTelemetria t = trama(99);
+  telemetriaPublicar(t);
+  TEST_ASSERT_EQUAL_UINT16(2, t.descartadas);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc_vector_de_referencia);
+  RUN_TEST(test_trama_en_serial);
+  RUN_TEST(test_cola_llena_tira_la_mas_vieja);
+  return UNITY_END();
+}
@@ -0,0 +1,109 @@
+// Máquina de estados del eco (ultrasonido.h) con el mock de host: los
+// flancos los sintetiza el driver a partir de ultrasonidoMockEco o se
+// inyectan a mano con ultrasonidoFlancoEco(), como lo haría el ISR.
+//
+//   pio test -e native -f test_ultrasonido
+
+#include <unity.h>
+#include "configuracion.h"
+#include "ultrasonido.h"
+#include "sim/simulador.h"
+
+static unsigned long anchoMock = 0;
+
+static unsigned long ecoMock(uint8_t) {
+  return anchoMock;
+}
+
+void setUp() {
+  Mapa vacio = {"vacio", 1000, 1000, 500, 500, 0, {}};
+  simIniciar(vacio, 1);
+  ultrasonidoMockEco = ecoMock;
+  anchoMock = 0;
+  ultrasonidoIniciar(TRIGGER_PIN, ECHO_PIN);
+}
+
+void tearDown() {}
+
+// Dispara ya (el primer disparo es inmediato) y devuelve su micros()
+static unsigned long disparar() {
+  unsigned long t = micros();
+  ultrasonidoPaso(t);
+  TEST_ASSERT_TRUE(ultrasonidoOcupado());
+  return t;
+}
+
+void test_eco_normal() {
+  anchoMock = 1000;  // 17 cm
+  unsigned long disparoMs = millis();
+  disparar();
+
+  simAvanzarUs(ULTRASONIDO_MOCK_RETARDO_US + 500);
+  ultrasonidoPaso(micros());
+  TEST_ASSERT_TRUE(ultrasonidoOcupado());  // Eco a medias
+  TEST_ASSERT_EQUAL_UINT16(0, ultrasonidoUltima().secuencia);
+
+  simAvanzarUs(1000);
+  ultrasonidoPaso(micros());
+  LecturaUltrasonido l = ultrasonidoUltima();
+  TEST_ASSERT_FALSE(ultrasonidoOcupado());
+  TEST_ASSERT_EQUAL_UINT16(1, l.secuencia);
+  TEST_ASSERT_EQUAL_UINT32(1000, l.anchoUs);
+  TEST_ASSERT_EQUAL_UINT32(disparoMs, l.disparoMs);
+  TEST_ASSERT_EQUAL(17, ultrasonidoDistanciaCm(l));
+}
+
+void test_timeout_sin_eco() {
+  disparar();
+
+  simAvanzarUs(ULTRASONIDO_TIMEOUT_US - 100);
+  ultrasonidoPaso(micros());
+  TEST_ASSERT_TRUE(ultrasonidoOcupado());  // Aún dentro del plazo
+  TEST_ASSERT_EQUAL_UINT16(0, ultrasonidoUltima().secuencia);
+
+  simAvanzarUs(200);
+  ultrasonidoPaso(micros());
+  LecturaUltrasonido l = ultrasonidoUltima();
+  TEST_ASSERT_FALSE(ultrasonidoOcupado());
+  TEST_ASSERT_EQUAL_UINT16(1, l.secuencia);
+  TEST_ASSERT_EQUAL_UINT32(0, l.anchoUs);
+  TEST_ASSERT_EQUAL(400, ultrasonidoDistanciaCm(l));  // Sin eco = lejos
+}
+
+void test_flanco_tardio_tras_timeout() {
+  unsigned long t0 = disparar();
+
+  // El eco sube pero no baja antes del timeout
+  ultrasonidoFlancoEco(true, t0 + ULTRASONIDO_MOCK_RETARDO_US);
+  simAvanzarUs(ULTRASONIDO_TIMEOUT_US + 100);
+  ultrasonidoPaso(micros());
+  TEST_ASSERT_EQUAL_UINT16(1, ultrasonidoUltima().secuencia);
+  TEST_ASSERT_EQUAL_UINT32(0, ultrasonidoUltima().anchoUs);
+
+  // La bajada tardía y un eco suelto después no publican nada
+  ultrasonidoFlancoEco(false, micros());
+  ultrasonidoFlancoEco(true, micros() + 10);
+  ultrasonidoFlancoEco(false, micros() + 300);
+  TEST_ASSERT_FALSE(ultrasonidoOcupado());
+  TEST_ASSERT_EQUAL_UINT16(1, ultrasonidoUltima().secuencia);
+  TEST_ASSERT_EQUAL_UINT32(0, ultrasonidoUltima().anchoUs);
+
+  // Ni se dispara antes del periodo ni se arrastra nada al siguiente disparo
+  anchoMock = 2000;
+  ultrasonidoPaso(micros());
+  TEST_ASSERT_FALSE(ultrasonidoOcupado());
+  simAvanzarUs(ULTRASONIDO_PERIODO_US - (micros() - t0));
+  disparar();
+  simAvanzarUs(ULTRASONIDO_MOCK_RETARDO_US + 2000);
+  ultrasonidoPaso(micros());
+  TEST_ASSERT_EQUAL_UINT16(2, ultrasonidoUltima().secuencia);
+  TEST_ASSERT_EQUAL_UINT32(2000, ultrasonidoUltima().anchoUs);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_eco_normal);
+  RUN_TEST(test_timeout_sin_eco);
+  RUN_TEST(test_flanco_tardio_tras_timeout);
+  return UNITY_END();
+}